@@ -3,6 +3,12 @@
 #include "input/InputManager.h"
 
 #include <iostream>
+#include <random>
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <cstring>
+#include <string>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -31,6 +37,19 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/euler_angles.hpp>
 #include "core/Time.h"
+#include "core/Profiler.h"
+#include "core/JobSystem.h"
+#include "render/GpuTimer.h"
+#include "render/RenderSnapshot.h"
+#include "render/FrustumCuller.h"
+#include "render/ShadowCache.h"
+#include "render/ShadowAtlas.h"
+#include "render/LightClusters.h"
+#include "render/TextureBuffer.h"
+#include "render/RenderQueue.h"
+#include "render/UniformBuffer.h"
+#include "render/GeometryArena.h"
+#include "render/StreamBuffer.h"
 #include "physics/Physics.h"
 #include <PxPhysicsAPI.h>
 #include "render/ParticleSystem.h"
@@ -43,6 +62,9 @@
 #include "render/IBL.h"
 #include "ecs/ECS.h"
 #include "ecs/ECSSerializer.h"
+#include "ecs/SceneDeltaLog.h"
+#include "ecs/Prefab.h"
+#include "ecs/SystemScheduler.h"
 
 namespace engine
 {
@@ -140,10 +162,11 @@ namespace engine
             // Fallback: if push is requested and no rigid exists, find closest entity under ray by AABB from mesh
             if (!m_useCpuPickFallback) return;
             int best = -1; float bestT = 1e9f;
-            for (int i = 0; i < (int)m_scene->entities().size(); ++i)
-            {
+            // candidates from the scene BVH (fat boxes), then the exact box test
+            syncSceneBvh();
+            m_sceneBvh->raycast(rayOrigin, rayDir, bestT, [&](int proxy, float) {
+                int i = (int)m_sceneBvh->userData(proxy);
                 auto& ent = m_scene->entities()[i];
-                if (!ent.mesh) continue;
                 // approximate with unit cube bounds scaled by transform
                 glm::vec3 minB = ent.transform.position - ent.transform.scale * 0.5f;
                 glm::vec3 maxB = ent.transform.position + ent.transform.scale * 0.5f;
@@ -159,7 +182,8 @@ namespace engine
                 {
                     bestT = tnear; best = i;
                 }
-            }
+                return std::max(bestT, 1e-4f);
+            });
             if (best >= 0)
             {
                 m_scene->setSelectedIndex(best);
@@ -199,9 +223,33 @@ namespace engine
             }
         }
     }
+    void Application::syncSceneBvh()
+    {
+        auto& ents = m_scene->entities();
+        if (m_sceneProxies.size() != ents.size())
+        {
+            // entities were added or removed (indices shift): rebuild
+            m_sceneBvh->clear();
+            m_sceneProxies.assign(ents.size(), DynamicBVH::kNull);
+        }
+        for (size_t i = 0; i < ents.size(); ++i)
+        {
+            int& proxy = m_sceneProxies[i];
+            if (!ents[i].mesh)
+            {
+                if (proxy != DynamicBVH::kNull) { m_sceneBvh->destroyProxy(proxy); proxy = DynamicBVH::kNull; }
+                continue;
+            }
+            const Transform& t = ents[i].transform;
+            Aabb box{ t.position - t.scale * 0.5f, t.position + t.scale * 0.5f };
+            if (proxy == DynamicBVH::kNull) proxy = m_sceneBvh->createProxy(box, (uint32_t)i);
+            else m_sceneBvh->moveProxy(proxy, box);
+        }
+    }
+
     void Application::handlePickingECS()
     {
-        if (!m_enablePicking || !m_input || !m_ecsBridge || !m_physics) return;
+        if (!m_enablePicking || !m_input || !m_ecsBridge) return;
         ImGuiIO& io = ImGui::GetIO(); if (io.WantCaptureMouse) { m_pickClickConsumed = false; return; }
         if (!m_input->isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT)) { m_pickClickConsumed = false; return; }
         if (m_pickClickConsumed) return; m_pickClickConsumed = true;
@@ -212,18 +260,28 @@ namespace engine
         double fy = my * (winH > 0 ? (double)fbh / (double)winH : 1.0);
         glm::vec3 rayDir = screenToRayDir(fx, fy, fbw, fbh, m_camera->projection(), m_camera->view());
         glm::vec3 rayOrigin = m_camera->position();
-        physx::PxVec3 origin(rayOrigin.x, rayOrigin.y, rayOrigin.z);
-        physx::PxVec3 unitDir(rayDir.x, rayDir.y, rayDir.z);
-        float maxDist = 1000.0f; physx::PxRaycastBuffer hit; physx::PxScene* sc = m_physics->scene(); if (!sc) return;
-        bool status = sc->raycast(origin, unitDir, maxDist, hit); if (!status || !hit.hasBlock) return;
-        physx::PxRigidActor* actor = hit.block.actor; if (!actor) return;
+        const float maxDist = 1000.0f;
         auto& reg = m_ecsBridge->reg();
         entt::entity found = entt::null;
-        auto v = reg.view<PhysActorC>();
-        for (auto e : v)
+
+        // Exact hit against colliders; the owning entity comes from the spatial index
+        // (candidates along the ray up to the hit) instead of a scan over all actors
+        physx::PxScene* sc = m_physics ? m_physics->scene() : nullptr;
+        physx::PxRaycastBuffer hit;
+        if (sc && sc->raycast(physx::PxVec3(rayOrigin.x, rayOrigin.y, rayOrigin.z), physx::PxVec3(rayDir.x, rayDir.y, rayDir.z), maxDist, hit)
+            && hit.hasBlock && hit.block.actor)
         {
-            if ((physx::PxRigidActor*)v.get<PhysActorC>(e).actor == actor) { found = e; break; }
+            void* actor = hit.block.actor;
+            spatialTree(reg).raycast(rayOrigin, rayDir, hit.block.distance + 0.01f, [&](int proxy, float) {
+                entt::entity e{ (entt::id_type)spatialTree(reg).userData(proxy) };
+                const auto* pa = reg.try_get<PhysActorC>(e);
+                if (pa && pa->actor == actor) { found = e; return 0.0f; }
+                return hit.block.distance + 0.01f;
+            });
         }
+        // Otherwise the nearest bounding sphere under the cursor
+        if (found == entt::null)
+            found = raycastEntities(reg, rayOrigin, rayDir, maxDist);
         if (found != entt::null)
             m_ecsBridge->data().selected = found;
     }
@@ -279,13 +337,9 @@ namespace engine
         // Clear previous ECS actors
         auto va = reg.view<PhysActorC>();
         for (auto e : va) { va.get<PhysActorC>(e).actor = nullptr; }
-        // Create actors for entities with RigidBodyC + BoxColliderC
-        auto v = reg.view<TransformC, RigidBodyC, BoxColliderC>();
-        for (auto e : v)
+        // Create actors for entities with RigidBodyC + BoxColliderC (own or shared from their prefab)
+        auto addActor = [&](entt::entity e, const TransformC& tr, const RigidBodyC& rb, const BoxColliderC& bc)
         {
-            auto& tr = v.get<TransformC>(e);
-            auto& rb = v.get<RigidBodyC>(e);
-            auto& bc = v.get<BoxColliderC>(e);
             void* actor = nullptr;
             if (rb.isStatic)
             {
@@ -299,6 +353,17 @@ namespace engine
             }
             if (!reg.any_of<PhysActorC>(e)) reg.emplace<PhysActorC>(e);
             reg.get<PhysActorC>(e).actor = actor;
+        };
+        auto v = reg.view<TransformC, RigidBodyC, BoxColliderC>();
+        for (auto e : v)
+            addActor(e, v.get<TransformC>(e), v.get<RigidBodyC>(e), v.get<BoxColliderC>(e));
+        auto vi = reg.view<TransformC, PrefabC>();
+        for (auto e : vi)
+        {
+            if (reg.all_of<RigidBodyC, BoxColliderC>(e)) continue; // done above
+            const auto* rb = resolveComponent<RigidBodyC>(reg, e);
+            const auto* bc = resolveComponent<BoxColliderC>(reg, e);
+            if (rb && bc) addActor(e, vi.get<TransformC>(e), *rb, *bc);
         }
     }
     void Application::syncECSFromPhysics(float dt)
@@ -311,26 +376,900 @@ namespace engine
         {
             void* pa = v.get<PhysActorC>(e).actor; if (!pa) continue;
             physx::PxRigidDynamic* body = reinterpret_cast<physx::PxRigidDynamic*>(pa);
+            // sleeping bodies haven't moved: leave TransformC (and its cached matrix) alone
+            if (body->isSleeping()) continue;
             physx::PxTransform p = body->getGlobalPose();
-            auto& t = v.get<TransformC>(e);
+            TransformC t = v.get<TransformC>(e);
             t.position = { p.p.x, p.p.y, p.p.z };
-            float qw = p.q.w, qx = p.q.x, qy = p.q.y, qz = p.q.z;
-            float sinr_cosp = 2.0f * (qw * qx + qy * qz);
-            float cosr_cosp = 1.0f - 2.0f * (qx * qx + qy * qy);
-            float roll = std::atan2(sinr_cosp, cosr_cosp);
-            float sinp = 2.0f * (qw * qy - qz * qx);
-            float pitch = std::abs(sinp) >= 1 ? std::copysign(3.14159265f / 2.0f, sinp) : std::asin(sinp);
-            float siny_cosp = 2.0f * (qw * qz + qx * qy);
-            float cosy_cosp = 1.0f - 2.0f * (qy * qy + qz * qz);
-            float yaw = std::atan2(siny_cosp, cosy_cosp);
-            t.rotationEuler = { pitch, yaw, roll };
+            t.rotation = glm::quat(p.q.w, p.q.x, p.q.y, p.q.z);
+            reg.replace<TransformC>(e, t);
+        }
+    }
+    // Per-frame simulation as scheduled systems. Declared access includes what the registry
+    // hooks write (a TransformC replace also touches the dirty/matrix/save components).
+    void Application::registerSimulationSystems()
+    {
+        m_systems = std::make_unique<SystemScheduler>(m_ecsBridge->reg());
+        m_systems->add("scene_spin", [this](float dt) {
+            // Spin the cubes about world Y; the step is applied to the quaternion directly
+            // (an Euler round-trip flips the pose once the yaw passes 90 degrees)
+            for (size_t i = 0; i < m_scene->entities().size(); ++i)
+            {
+                Transform& t = m_scene->entities()[i].transform;
+                t.rotation = glm::normalize(glm::angleAxis(dt * (1.0f + 0.2f * (float)i), glm::vec3(0.0f, 1.0f, 0.0f)) * t.rotation);
+            }
+        }).writes("scene");
+        m_systems->add("physics", [this](float dt) { if (m_physics) syncECSFromPhysics(dt); })
+            .reads<PhysActorC>()
+            .writes<TransformC, TransformDirtyC, WorldMatrixC, SaveDirtyC>()
+            .writes("physics");
+        // scripts may touch anything
+        m_systems->add("lua", [this](float dt) { if (m_lua) m_lua->onUpdate(dt); }).exclusive();
+        m_systems->add("animation", [this](float dt) {
+            if (m_skinMesh && m_skinSkeleton && m_skinAnimator && m_skinPlaying)
+                m_skinAnimator->update(*m_skinSkeleton, dt * m_skinSpeed);
+        }).writes("skeleton");
+        m_systems->add("particles_sim", [this](float dt) {
+            if (m_particles)
+                m_particles->simulate(dt, m_particlesEmit, glm::vec3(0.0f, 1.0f, 0.0f), m_particlesRate,
+                    m_particlesLifetime, m_particlesSize, m_particlesGravityY);
+        }).writes("particles");
+        // world matrices + spatial refit; the snapshot then finds nothing left to update
+        m_systems->add("transforms", [this](float) { updateWorldMatrices(m_ecsBridge->reg()); })
+            .reads<TransformC, BoundsC, MeshRendererC, PrefabC>()
+            .writes<WorldMatrixC, TransformDirtyC, HierarchyC, SpatialProxyC>()
+            .writes("spatial");
+        // ECS emitters: one system each, keyed by entity (created in syncEmitterSystems). Registered
+        // after "transforms" so the world origin is this frame's (the emitter may have a parent).
+        m_systems->add("emitters", [this](float dt) {
+            if (!m_renderFromECS) return;
+            auto& reg = m_ecsBridge->reg();
+            auto vpe = reg.view<ParticleEmitterC, TransformC>();
+            for (auto e : vpe)
+            {
+                auto it = m_emitterSystems.find(entt::to_integral(e));
+                if (it == m_emitterSystems.end()) continue;
+                const auto& pe = vpe.get<ParticleEmitterC>(e);
+                const auto* wm = reg.try_get<WorldMatrixC>(e);
+                const glm::vec3 origin = wm ? glm::vec3(wm->model[3]) : vpe.get<TransformC>(e).position;
+                it->second->simulate(dt, pe.emit, origin, pe.rate,
+                    m_particlesLifetime, m_particlesSize, m_particlesGravityY);
+            }
+        }).reads<ParticleEmitterC, TransformC, WorldMatrixC>().writes("emitter_systems");
+    }
+
+    void Application::simulateFrame(float dt)
+    {
+        if (m_systems) m_systems->run(dt, m_jobs.get());
+    }
+
+    // FNV-1a over the matrix and mesh of a static caster: any move, add or removal changes the key
+    static uint64_t hashStaticCaster(uint64_t h, const glm::mat4& model, const Mesh* mesh)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&model[0][0]);
+        for (size_t i = 0; i < sizeof(glm::mat4); ++i) { h ^= bytes[i]; h *= 1099511628211ull; }
+        const uintptr_t m = reinterpret_cast<uintptr_t>(mesh);
+        for (size_t i = 0; i < sizeof(m); ++i) { h ^= (m >> (i * 8)) & 0xff; h *= 1099511628211ull; }
+        return h;
+    }
+
+    void Application::buildRenderSnapshot(RenderSnapshot& out)
+    {
+        PROFILE_SCOPE("snapshot");
+        out.clear();
+        if (m_ecsBridge)
+        {
+            auto& reg = m_ecsBridge->reg();
+            updateWorldMatrices(reg);
+            auto addItem = [&](entt::entity ent, const WorldMatrixC& wm, const MeshRendererC& mr)
+            {
+                if (!mr.mesh) return;
+                const auto* sp = reg.try_get<SpatialProxyC>(ent);
+                if (!sp || sp->proxy < 0) return;
+                // own RigidBodyC or the one shared from the prefab
+                const auto* rb = resolveComponent<RigidBodyC>(reg, ent);
+                const bool isStatic = rb && rb->isStatic && !rb->isKinematic;
+                out.items.push_back({ wm.model, wm.normal, mr.mesh, mr.material, mr.albedoTex, isStatic });
+                if (isStatic) out.staticCasterKey = hashStaticCaster(out.staticCasterKey, wm.model, mr.mesh);
+                glm::vec4 sphere = spatialSphere(reg, sp->proxy);
+                out.bounds.push(glm::vec3(sphere), sphere.w);
+            };
+            auto v = reg.view<TransformC, WorldMatrixC, MeshRendererC>();
+            for (auto ent : v)
+                addItem(ent, v.get<WorldMatrixC>(ent), v.get<MeshRendererC>(ent));
+            // prefab instances without an override draw the shared renderer
+            auto vi = reg.view<WorldMatrixC, PrefabC>(entt::exclude<MeshRendererC>);
+            for (auto ent : vi)
+            {
+                const Prefab* prefab = findPrefab(reg, vi.get<PrefabC>(ent).id);
+                if (prefab && prefab->meshRenderer) addItem(ent, vi.get<WorldMatrixC>(ent), *prefab->meshRenderer);
+            }
+            out.bounds.pad();
+
+            // Lighting: first directional + first point + first spot for the legacy uniforms,
+            // every point and spot light for the shadow atlas
+            LightSnapshot& l = out.lights;
+            auto vdir = reg.view<DirectionalLightC>();
+            for (auto e : vdir)
+            {
+                const auto& dl = vdir.get<DirectionalLightC>(e);
+                glm::vec3 dir = glm::normalize(dl.direction);
+                if (glm::length(dir) < 1e-3f) dir = glm::vec3(-0.5f,-1.0f,-0.3f);
+                l.hasDir = true;
+                l.dirPos = -dir * 10.0f;
+                l.dirColor = dl.color * dl.intensity;
+                break;
+            }
+            auto vpl = reg.view<PointLightC, WorldMatrixC>();
+            for (auto e : vpl)
+            {
+                const auto& pl = vpl.get<PointLightC>(e);
+                LocalLight local;
+                local.position = glm::vec3(vpl.get<WorldMatrixC>(e).model[3]);
+                local.color = pl.color * pl.intensity;
+                local.range = pl.range;
+                out.localLights.push_back(local);
+                if (l.hasPoint) continue;
+                l.hasPoint = true;
+                l.pointPos = local.position;
+                l.pointColor = local.color;
+                l.pointRange = pl.range;
+            }
+            auto vsl = reg.view<SpotLightC, WorldMatrixC>();
+            for (auto e : vsl)
+            {
+                const auto& sl = vsl.get<SpotLightC>(e);
+                LocalLight local;
+                local.isSpot = true;
+                local.position = glm::vec3(vsl.get<WorldMatrixC>(e).model[3]);
+                local.direction = glm::normalize(sl.direction);
+                local.color = sl.color * sl.intensity;
+                local.range = sl.farPlane;
+                local.innerDegrees = sl.innerDegrees; local.outerDegrees = sl.outerDegrees;
+                local.nearPlane = sl.nearPlane;
+                out.localLights.push_back(local);
+                if (l.hasSpot) continue;
+                l.hasSpot = true;
+                l.spotPos = local.position;
+                l.spotDir = local.direction;
+                l.spotColor = local.color;
+                l.spotInner = sl.innerDegrees; l.spotOuter = sl.outerDegrees;
+                l.spotNear = sl.nearPlane; l.spotFar = sl.farPlane;
+            }
+        }
+
+        // Debug collider boxes (legacy Scene bindings)
+        if (m_drawColliders && m_physics)
+        {
+            for (const auto& b : m_physBindings)
+            {
+                physx::PxRigidDynamic* body = reinterpret_cast<physx::PxRigidDynamic*>(b.actor);
+                if (!body) continue;
+                physx::PxU32 numShapes = body->getNbShapes();
+                if (numShapes == 0) continue;
+                std::vector<physx::PxShape*> shapes(numShapes);
+                body->getShapes(shapes.data(), numShapes);
+                for (physx::PxShape* s : shapes)
+                {
+                    physx::PxBoxGeometry boxGeo;
+                    if (s->getBoxGeometry(boxGeo))
+                    {
+                        physx::PxTransform aPose = body->getGlobalPose() * s->getLocalPose();
+                        glm::mat4 T = glm::translate(glm::mat4(1.0f), glm::vec3(aPose.p.x, aPose.p.y, aPose.p.z));
+                        glm::quat rq(aPose.q.w, aPose.q.x, aPose.q.y, aPose.q.z);
+                        glm::mat4 R = glm::toMat4(rq);
+                        glm::mat4 S = glm::scale(glm::mat4(1.0f), glm::vec3(boxGeo.halfExtents.x * 2.0f, boxGeo.halfExtents.y * 2.0f, boxGeo.halfExtents.z * 2.0f));
+                        out.colliders.push_back(T * R * S);
+                    }
+                }
+            }
+        }
+
+        if (m_skinMesh && m_skinSkeleton && m_skinAnimator)
+            out.bonePalette = m_skinSkeleton->posePalette;
+
+        auto addParticles = [&out](ParticleSystem* ps) {
+            if (out.particleCount >= (int)out.particles.size()) out.particles.emplace_back();
+            ParticleBatch& b = out.particles[out.particleCount++];
+            b.system = ps;
+            b.count = ps->packedCount();
+            b.packed.assign(ps->packed().begin(), ps->packed().begin() + (size_t)b.count * 5);
+        };
+        if (m_particles) addParticles(m_particles.get());
+        if (m_renderFromECS)
+            for (auto& kv : m_emitterSystems) addParticles(kv.second.get());
+    }
+
+    void Application::cullSnapshot(const RenderSnapshot& snap, const float* viewProj, std::vector<uint32_t>& out)
+    {
+        if (!m_frustumCulling)
+        {
+            out.resize(snap.items.size());
+            for (size_t i = 0; i < out.size(); ++i) out[i] = (uint32_t)i;
+            return;
+        }
+        FrustumPlanes planes = FrustumPlanes::fromViewProj(glm::make_mat4(viewProj));
+        m_culler->cull(snap.bounds, planes, out, m_jobs.get());
+    }
+
+    // Consecutive draws of one mesh (and material, in the PBR pass) merged into an instanced draw
+    struct InstanceBatch
+    {
+        Mesh* mesh = nullptr;
+        uint32_t firstItem = 0; // snapshot item the batch state is taken from
+        std::vector<uint32_t> items; // snapshot items drawn as instances
+    };
+
+    // Writes n entries kObjectsPerBlock at a time straight into the ObjectData stream through
+    // fill(i, entry) and calls draw(i, slot) for each, slot being what the shader reads through u_ObjectIndex
+    template <typename FillFn, typename DrawFn>
+    static void drawThroughObjectBlock(StreamBuffer& stream, int n, FillFn fill, DrawFn draw)
+    {
+        // the bound range has to cover the whole declared block
+        const size_t blockBytes = sizeof(ObjectEntry) * kObjectsPerBlock;
+        for (int base = 0; base < n; base += kObjectsPerBlock)
+        {
+            const int count = std::min(kObjectsPerBlock, n - base);
+            size_t offset = 0;
+            ObjectEntry* entries = static_cast<ObjectEntry*>(stream.allocate(blockBytes, StreamBuffer::uniformAlignment(), offset));
+            if (!entries) return;
+            for (int slot = 0; slot < count; ++slot) fill(base + slot, entries[slot]);
+            stream.flush();
+            stream.bindUniformRange(BlockObjects, offset, blockBytes);
+            for (int slot = 0; slot < count; ++slot) draw(base + slot, slot);
+        }
+    }
+
+    // Writes the model matrices of batches [0, count) straight into the arena instance stream and
+    // fills one indirect command per batch (the batch's instances addressed through baseInstance)
+    static void buildIndirectCommands(const RenderSnapshot& snap, const std::vector<InstanceBatch>& batches, size_t count,
+                                      size_t totalInstances, std::vector<DrawIndirectCommand>& commands)
+    {
+        GeometryArena& arena = GeometryArena::instance();
+        arena.reserveInstances((int)totalInstances);
+        commands.resize(count);
+        for (size_t b = 0; b < count; ++b)
+        {
+            const InstanceBatch& batch = batches[b];
+            const GeometryRange& range = batch.mesh->range();
+            DrawIndirectCommand& cmd = commands[b];
+            cmd.count = range.indexCount;
+            cmd.instanceCount = (uint32_t)batch.items.size();
+            cmd.firstIndex = range.firstIndex;
+            cmd.baseVertex = range.baseVertex;
+            glm::mat4* dst = arena.mapInstances((int)batch.items.size(), cmd.baseInstance);
+            if (!dst) { cmd.instanceCount = 0; continue; }
+            for (uint32_t idx : batch.items) *dst++ = snap.items[idx].model;
+        }
+        arena.flushInstances();
+    }
+
+    // Depth-only draw of snapshot items from one light view. With instancing, casters are bucketed
+    // by mesh (scenes have few distinct meshes) and the whole pass is one indirect multi-draw.
+    void Application::drawDepthCasters(const RenderSnapshot& snap, const std::vector<uint32_t>& casters,
+                                       Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView)
+    {
+        if (!m_useInstancing)
+        {
+            shader.bind();
+            setView(shader);
+            const UniformHandle uModel = shader.uniform("u_Model");
+            for (uint32_t idx : casters)
+            {
+                shader.setMat4(uModel, &snap.items[idx].model[0][0]);
+                snap.items[idx].mesh->draw();
+            }
+            shader.unbind();
+            return;
+        }
+        size_t used = 0;
+        size_t last = 0;
+        for (uint32_t idx : casters)
+        {
+            const RenderItem& item = snap.items[idx];
+            if (used == 0 || m_instanceBatches[last].mesh != item.mesh)
+            {
+                last = used;
+                for (size_t b = 0; b < used; ++b)
+                    if (m_instanceBatches[b].mesh == item.mesh) { last = b; break; }
+                if (last == used)
+                {
+                    if (used == m_instanceBatches.size()) m_instanceBatches.emplace_back();
+                    m_instanceBatches[used].mesh = item.mesh;
+                    m_instanceBatches[used].firstItem = idx;
+                    m_instanceBatches[used].items.clear();
+                    ++used;
+                }
+            }
+            m_instanceBatches[last].items.push_back(idx);
+        }
+        buildIndirectCommands(snap, m_instanceBatches, used, casters.size(), m_indirectCommands);
+        instancedShader.bind();
+        setView(instancedShader);
+        GeometryArena::instance().drawIndirect(m_indirectCommands.data(), (int)used);
+        instancedShader.unbind();
+    }
+
+    // Opens one shadow view with its static casters served from cacheSlot: they are re-rendered
+    // into the cache only when the view or snap.staticCasterKey changed, and each frame the cache
+    // is copied into the target opened by beginTarget. remaining gets the casters still to draw:
+    // the dynamic ones, or all of them with caching off.
+    void Application::beginShadowView(const RenderSnapshot& snap, const std::vector<uint32_t>& casters, int cacheSlot,
+                                      int size, const float* viewProj, const std::function<void()>& beginTarget,
+                                      Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView,
+                                      std::vector<uint32_t>& remaining)
+    {
+        if (!m_shadowCaching)
+        {
+            beginTarget();
+            remaining = casters;
+            return;
+        }
+        m_staticCasters.clear();
+        remaining.clear();
+        for (uint32_t idx : casters)
+            (snap.items[idx].isStatic ? m_staticCasters : remaining).push_back(idx);
+
+        ShadowCache& cache = *m_shadowCaches[cacheSlot];
+        if (cache.size() != size) cache.create(size);
+        const glm::mat4 vp = glm::make_mat4(viewProj);
+        if (cache.stale(vp, snap.staticCasterKey))
+        {
+            PROFILE_SCOPE("shadow_cache_update");
+            cache.beginUpdate();
+            drawDepthCasters(snap, m_staticCasters, shader, instancedShader, setView);
+            cache.endUpdate(vp, snap.staticCasterKey);
+            ++m_shadowCacheUpdates;
+        }
+        beginTarget();
+        cache.copyToBound();
+    }
+
+    void Application::drawShadowView(const RenderSnapshot& snap, const std::vector<uint32_t>& casters, int cacheSlot,
+                                     int size, const float* viewProj, const std::function<void()>& beginTarget,
+                                     Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView)
+    {
+        beginShadowView(snap, casters, cacheSlot, size, viewProj, beginTarget, shader, instancedShader, setView, m_dynamicCasters);
+        drawDepthCasters(snap, m_dynamicCasters, shader, instancedShader, setView);
+    }
+
+    // Adds the items of from not yet in to (seen is indexed by item)
+    static void appendUnique(const std::vector<uint32_t>& from, std::vector<uint32_t>& to, std::vector<uint8_t>& seen)
+    {
+        for (uint32_t idx : from)
+        {
+            if (seen[idx]) continue;
+            seen[idx] = 1;
+            to.push_back(idx);
+        }
+    }
+
+    void Application::prepareLocalLights(const RenderSnapshot& snap)
+    {
+        PROFILE_SCOPE("local_lights");
+        LocalLightBlock& block = *m_localLights;
+        block.lightCount = 0;
+        block.atlasTexel = 1.0f / (float)std::max(m_shadowAtlasSize, 1);
+        block.clusterX = block.clusterY = block.clusterZ = 0;
+        m_localLightEntries.clear();
+        m_atlasRequests.clear();
+        m_atlasTiles.clear();
+        m_atlasTileLight.clear();
+        m_atlasTileCount = 0;
+        if (!(m_renderFromECS && m_ecsBridge)) return;
+
+        // lights whose range touches the view, by projected size: range over distance, scaled by
+        // the projection (1 when the camera is inside the range)
+        const glm::mat4 camVP = m_camera->projection() * m_camera->view();
+        const FrustumPlanes frustum = FrustumPlanes::fromViewProj(camVP);
+        const float focal = m_camera->projection()[1][1];
+        struct Candidate { int light; float coverage; };
+        std::vector<Candidate> candidates;
+        for (int i = 0; i < (int)snap.localLights.size(); ++i)
+        {
+            const LocalLight& l = snap.localLights[i];
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+                inside = frustum.p[p][0]*l.position.x + frustum.p[p][1]*l.position.y + frustum.p[p][2]*l.position.z + frustum.p[p][3] >= -l.range;
+            if (!inside) continue;
+            const float dist = glm::length(l.position - m_camera->position());
+            const float coverage = dist <= l.range ? 1.0f : std::min(1.0f, l.range * focal / dist);
+            candidates.push_back({ i, coverage });
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.coverage > b.coverage; });
+        if ((int)candidates.size() > kMaxLocalLights) candidates.resize(kMaxLocalLights);
+
+        // one tile per spot light, six per point light, sized by coverage
+        const bool shadows = m_shadowAtlasEnabled && m_shadowAtlas && !m_wireframe;
+        std::vector<int> firstRequest(candidates.size(), -1);
+        for (size_t c = 0; c < candidates.size() && shadows; ++c)
+        {
+            const int faces = snap.localLights[candidates[c].light].isSpot ? 1 : 6;
+            if ((int)m_atlasRequests.size() + faces > kMaxShadowTiles) break;
+            firstRequest[c] = (int)m_atlasRequests.size();
+            const int size = std::max(m_shadowAtlas->minTile(), (int)(m_shadowAtlasMaxTile * candidates[c].coverage));
+            m_atlasRequests.insert(m_atlasRequests.end(), faces, size);
+        }
+        if (shadows) m_shadowAtlas->pack(m_atlasRequests, m_atlasPacked);
+
+        static const glm::vec3 faceDirs[6] = { {1,0,0},{-1,0,0},{0,1,0},{0,-1,0},{0,0,1},{0,0,-1} };
+        static const glm::vec3 faceUps[6]  = { {0,-1,0},{0,-1,0},{0,0,1},{0,0,-1},{0,-1,0},{0,-1,0} };
+        const float atlasScale = 1.0f / (float)std::max(m_shadowAtlasSize, 1);
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            const LocalLight& l = snap.localLights[candidates[c].light];
+            const int index = block.lightCount++;
+            m_localLightEntries.emplace_back();
+            LocalLightEntry& e = m_localLightEntries.back();
+            e.position = l.position;
+            e.range = std::max(l.range, 0.01f);
+            e.color = l.color;
+            e.isSpot = l.isSpot ? 1 : 0;
+            e.direction = l.direction;
+            e.cosInner = std::cos(glm::radians(l.innerDegrees));
+            e.cosOuter = std::cos(glm::radians(l.outerDegrees));
+            e.shadowBias = m_shadowAtlasBias;
+            e.firstTile = -1;
+
+            // shadowed only when every face found room
+            const int faces = l.isSpot ? 1 : 6;
+            const int first = firstRequest[c];
+            if (first < 0) continue;
+            bool placed = true;
+            for (int f = 0; f < faces; ++f) placed = placed && m_atlasPacked[first + f].size > 0;
+            if (!placed) continue;
+
+            e.firstTile = m_atlasTileCount;
+            for (int f = 0; f < faces; ++f)
+            {
+                glm::mat4 viewProj;
+                if (l.isSpot)
+                {
+                    const glm::vec3 up = std::abs(l.direction.y) > 0.99f ? glm::vec3(0,0,1) : glm::vec3(0,1,0);
+                    viewProj = glm::perspective(glm::radians(l.outerDegrees * 2.0f), 1.0f, l.nearPlane, e.range)
+                             * glm::lookAt(l.position, l.position + l.direction, up);
+                }
+                else
+                {
+                    viewProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, e.range)
+                             * glm::lookAt(l.position, l.position + faceDirs[f], faceUps[f]);
+                }
+                const AtlasTile& tile = m_atlasPacked[first + f];
+                ShadowTileEntry& t = block.tiles[m_atlasTileCount++];
+                t.viewProj = viewProj;
+                t.rect = glm::vec4(tile.x * atlasScale, tile.y * atlasScale, tile.size * atlasScale, tile.size * atlasScale);
+                m_atlasTiles.push_back(tile);
+                m_atlasTileLight.push_back(index);
+            }
+        }
+        if (!m_clusteredLights || m_localLightEntries.empty()) return;
+
+        // bounding spheres: the range of a point light, the smallest sphere around a spot cone
+        std::vector<glm::vec4> spheres;
+        spheres.reserve(m_localLightEntries.size());
+        for (const LocalLightEntry& e : m_localLightEntries)
+        {
+            if (!e.isSpot) { spheres.emplace_back(e.position, e.range); continue; }
+            const float cosOuter = std::max(e.cosOuter, 0.0f);
+            const float sinOuter = std::sqrt(1.0f - cosOuter * cosOuter);
+            if (cosOuter < 0.70710678f)
+                spheres.emplace_back(e.position + e.direction * (e.range * cosOuter), e.range * sinOuter);
+            else
+            {
+                const float radius = e.range / (2.0f * cosOuter);
+                spheres.emplace_back(e.position + e.direction * radius, radius);
+            }
+        }
+        m_lightClusters->build(m_camera->view(), m_camera->projection(), spheres.data(), (int)spheres.size(), m_jobs.get());
+        block.clusterX = m_lightClusters->gridX();
+        block.clusterY = m_lightClusters->gridY();
+        block.clusterZ = m_lightClusters->gridZ();
+        block.clusterZScale = m_lightClusters->zScale();
+        block.clusterZBias = m_lightClusters->zBias();
+    }
+
+    void Application::uploadUniformBlocks(float dt, const float* lightVP, const float* spotVP)
+    {
+        m_elapsedTime += dt;
+        FrameBlock frame;
+        frame.view = m_camera->view();
+        frame.proj = m_camera->projection();
+        frame.viewProj = frame.proj * frame.view;
+        frame.cameraPos = m_camera->position();
+        frame.time = (float)m_elapsedTime;
+        frame.deltaTime = dt;
+        m_frameUbo->update(&frame, sizeof(frame));
+
+        LightBlock light;
+        light.dirPos = glm::vec3(m_lightPos[0], m_lightPos[1], m_lightPos[2]);
+        light.dirColor = glm::vec3(m_lightColor[0], m_lightColor[1], m_lightColor[2]);
+        light.pointPos = glm::vec3(m_pointLightPos[0], m_pointLightPos[1], m_pointLightPos[2]);
+        light.pointColor = glm::vec3(m_pointLightColor[0], m_pointLightColor[1], m_pointLightColor[2]);
+        light.pointShadowFar = m_pointShadowFar;
+        light.pointShadowBias = m_pointShadowBias;
+        light.spotPos = glm::vec3(m_spotPos[0], m_spotPos[1], m_spotPos[2]);
+        light.spotDir = glm::normalize(glm::vec3(m_spotDir[0], m_spotDir[1], m_spotDir[2]));
+        light.spotColor = glm::vec3(m_spotColor[0], m_spotColor[1], m_spotColor[2]);
+        light.spotCosInner = std::cos(glm::radians(m_spotInner));
+        light.spotCosOuter = std::cos(glm::radians(m_spotOuter));
+        light.lightVP = glm::make_mat4(lightVP);
+        light.spotVP = glm::make_mat4(spotVP);
+        for (int c = 0; c < m_cascadeCount && c < 4; ++c)
+            light.cascadeVP[c] = glm::make_mat4(m_cascadeMatrices[c]);
+        light.shadowBias = m_shadowBias;
+        light.shadowMapSize = (float)(m_csmEnabled ? m_csmSize : m_shadowMapSize);
+        light.lightRadius = m_lightRadius;
+        light.shadowsEnabled = (m_shadowsEnabled && !m_wireframe) ? 1 : 0;
+        light.useCSM = m_csmEnabled ? 1 : 0;
+        light.cascadeCount = m_cascadeCount;
+        light.pcfKernel = m_usePCF ? m_pcfKernel : 0;
+        light.usePCSS = m_usePCSS ? 1 : 0;
+        light.pointShadowsEnabled = (m_pointShadowEnabled && !m_wireframe) ? 1 : 0;
+        light.spotEnabled = m_spotEnabled ? 1 : 0;
+        m_lightUbo->update(&light, sizeof(light));
+
+        // tiles past the last one are never read
+        const LocalLightBlock& local = *m_localLights;
+        m_localLightUbo->update(&local, offsetof(LocalLightBlock, tiles) + sizeof(ShadowTileEntry) * m_atlasTileCount);
+        m_localLightTbo->update(m_localLightEntries.data(), sizeof(LocalLightEntry) * m_localLightEntries.size());
+        if (local.clusterX > 0)
+        {
+            m_clusterCellTbo->update(m_lightClusters->cells().data(), sizeof(uint32_t) * m_lightClusters->cells().size());
+            m_clusterIndexTbo->update(m_lightClusters->lightIndices().data(), sizeof(uint32_t) * m_lightClusters->lightIndices().size());
+        }
+    }
+
+    // ECS PBR pass through the render queue: per-frame data in uniform blocks, material uniforms
+    // and textures when the material changes, only the object index per draw
+    void Application::submitPbrQueue(const RenderSnapshot& snap)
+    {
+        const RenderStats before = renderStats();
+        const glm::mat4 view = m_camera->view();
+        RenderQueue& queue = *m_renderQueue;
+        {
+            PROFILE_SCOPE("render_queue");
+            queue.clear();
+            const float invFar = 1.0f / std::max(1e-3f, m_camFar);
+            for (uint32_t idx : m_visibleItems)
+            {
+                const RenderItem& item = snap.items[idx];
+                // material state: the asset, or the bare albedo texture without one
+                uint32_t material = item.material ? queue.materialId(item.material) : queue.materialId(item.albedoTex);
+                float depth = -(view * item.model[3]).z * invFar;
+                queue.push(RenderQueue::makeKey(RenderQueue::PassOpaque, 0, material, queue.meshId(item.mesh), depth), idx);
+            }
+            queue.sort();
+        }
+
+        // instanced variant when batching: one draw per run of equal mesh + material in queue order
+        const bool instanced = m_useInstancing && m_pbrInstancedShader;
+        Shader& sh = instanced ? *m_pbrInstancedShader : *m_pbrShader;
+        sh.bind();
+        if (m_useIBL && m_ibl && m_ibl->valid())
+        {
+            sh.setInt("u_UseIBL", 1);
+            sh.setInt("u_IrradianceMap", 5); glActiveTexture(GL_TEXTURE0+5); glBindTexture(GL_TEXTURE_CUBE_MAP, m_ibl->irradianceMap());
+            sh.setInt("u_PrefilterMap", 6); glActiveTexture(GL_TEXTURE0+6); glBindTexture(GL_TEXTURE_CUBE_MAP, m_ibl->prefilterMap());
+            sh.setInt("u_BRDFLUT", 7); glActiveTexture(GL_TEXTURE0+7); glBindTexture(GL_TEXTURE_2D, m_ibl->brdfLUT());
+            renderStats().textureBinds += 3;
+        }
+        else sh.setInt("u_UseIBL", 0);
+        // shadow parameters are in LightData; only the maps are bound here
+        // separate units: samplers of different types may not share one
+        sh.setInt("u_ShadowMap", 8);
+        sh.setInt("u_CascadeMaps", 9);
+        if (!m_csmEnabled)
+        {
+            m_shadowMap->bindDepthTexture(8);
+            ++renderStats().textureBinds;
+        }
+        else
+        {
+            m_csm->bindArray(9);
+            ++renderStats().textureBinds;
+        }
+        if (m_shadowAtlas)
+        {
+            m_shadowAtlas->bindDepthTexture(12);
+            ++renderStats().textureBinds;
+            sh.setInt("u_ShadowAtlas", 12);
+        }
+        // buffer samplers always get their own units, even with no lights
+        m_localLightTbo->bind(13);
+        m_clusterCellTbo->bind(14);
+        m_clusterIndexTbo->bind(15);
+        renderStats().textureBinds += 3;
+        sh.setInt("u_LocalLightBuffer", 13);
+        sh.setInt("u_ClusterCells", 14);
+        sh.setInt("u_ClusterLights", 15);
+        // sampler units are fixed for the program
+        sh.setInt("u_AlbedoTex", 0);
+        sh.setInt("u_MetalTex", 1);
+        sh.setInt("u_RoughTex", 2);
+        sh.setInt("u_AOTex", 3);
+        sh.setInt("u_NormalTex", 4);
+
+        // per-draw and per-material uniforms, resolved once instead of by name per packet
+        const UniformHandle uObject = sh.uniform("u_ObjectIndex");
+        const UniformHandle uAlbedo = sh.uniform("u_Albedo"), uMetallic = sh.uniform("u_Metallic");
+        const UniformHandle uRoughness = sh.uniform("u_Roughness"), uAO = sh.uniform("u_AO");
+        const UniformHandle uUseTex[5] = { sh.uniform("u_UseAlbedoTex"), sh.uniform("u_UseMetalTex"),
+            sh.uniform("u_UseRoughTex"), sh.uniform("u_UseAOTex"), sh.uniform("u_UseNormalMap") };
+
+        // texture currently bound on units 0-4 by this pass
+        const Texture2D* bound[5] = {};
+        auto bindMaterialTex = [&](Texture2D* tex, int unit)
+        {
+            sh.setInt(uUseTex[unit], tex ? 1 : 0);
+            if (tex && bound[unit] != tex) { tex->bind(unit); bound[unit] = tex; }
+        };
+        // packets arrive grouped by material; compare the state itself (key ids saturate at 16 bits)
+        auto materialOf = [](const RenderItem& item) { return item.material ? (const void*)item.material : (const void*)item.albedoTex; };
+        const void* currentMaterial = nullptr;
+        bool first = true;
+        auto applyMaterial = [&](const RenderItem& item)
+        {
+            const void* material = materialOf(item);
+            if (!first && material == currentMaterial) return;
+            first = false;
+            currentMaterial = material;
+            if (item.material)
+            {
+                sh.setVec3(uAlbedo, item.material->albedo[0], item.material->albedo[1], item.material->albedo[2]);
+                sh.setFloat(uMetallic, item.material->metallic);
+                sh.setFloat(uRoughness, item.material->roughness);
+                sh.setFloat(uAO, item.material->ao);
+                bindMaterialTex(item.material->albedoTex, 0);
+                bindMaterialTex(item.material->metallicTex, 1);
+                bindMaterialTex(item.material->roughnessTex, 2);
+                bindMaterialTex(item.material->aoTex, 3);
+                bindMaterialTex(item.material->normalTex, 4);
+            }
+            else
+            {
+                sh.setVec3(uAlbedo, 1.0f, 1.0f, 1.0f);
+                sh.setFloat(uMetallic, 0.0f);
+                sh.setFloat(uRoughness, 0.8f);
+                sh.setFloat(uAO, 1.0f);
+                bindMaterialTex(item.albedoTex, 0);
+                for (int unit = 1; unit < 5; ++unit) sh.setInt(uUseTex[unit], 0);
+            }
+        };
+
+        if (instanced)
+        {
+            size_t used = 0;
+            const RenderItem* prev = nullptr;
+            for (const DrawPacket& packet : queue.packets())
+            {
+                const RenderItem& item = snap.items[packet.item];
+                if (!prev || item.mesh != prev->mesh || materialOf(item) != materialOf(*prev))
+                {
+                    if (used == m_instanceBatches.size()) m_instanceBatches.emplace_back();
+                    m_instanceBatches[used].mesh = item.mesh;
+                    m_instanceBatches[used].firstItem = packet.item;
+                    m_instanceBatches[used].items.clear();
+                    ++used;
+                }
+                m_instanceBatches[used - 1].items.push_back(packet.item);
+                prev = &item;
+            }
+            buildIndirectCommands(snap, m_instanceBatches, used, queue.size(), m_indirectCommands);
+            // batches of one material are adjacent: one multi-draw per material
+            for (size_t b = 0; b < used;)
+            {
+                const RenderItem& item = snap.items[m_instanceBatches[b].firstItem];
+                size_t end = b + 1;
+                while (end < used && materialOf(snap.items[m_instanceBatches[end].firstItem]) == materialOf(item)) ++end;
+                applyMaterial(item);
+                GeometryArena::instance().drawIndirect(&m_indirectCommands[b], (int)(end - b));
+                b = end;
+            }
+        }
+        else
+        {
+            // matrices of every packet, in draw order, streamed through ObjectData
+            drawThroughObjectBlock(*m_objectStream, (int)queue.size(), [&](int i, ObjectEntry& entry)
+            {
+                const RenderItem& item = snap.items[queue.packets()[i].item];
+                entry.model = item.model;
+                entry.normal = glm::mat4(item.normal);
+            },
+            [&](int i, int slot)
+            {
+                const RenderItem& item = snap.items[queue.packets()[i].item];
+                applyMaterial(item);
+                sh.setInt(uObject, slot);
+                item.mesh->draw();
+            });
+        }
+        sh.unbind();
+        m_pbrStats = renderStats() - before;
+        m_pbrPackets = (int)queue.size();
+    }
+
+    void Application::applySnapshotLights(const RenderSnapshot& snap)
+    {
+        const LightSnapshot& l = snap.lights;
+        if (l.hasDir)
+        {
+            m_lightPos[0]=l.dirPos.x; m_lightPos[1]=l.dirPos.y; m_lightPos[2]=l.dirPos.z;
+            m_lightColor[0]=l.dirColor.x; m_lightColor[1]=l.dirColor.y; m_lightColor[2]=l.dirColor.z;
+        }
+        if (l.hasPoint)
+        {
+            m_pointShadowEnabled = true;
+            m_pointLightPos[0]=l.pointPos.x; m_pointLightPos[1]=l.pointPos.y; m_pointLightPos[2]=l.pointPos.z;
+            m_pointLightColor[0]=l.pointColor.x; m_pointLightColor[1]=l.pointColor.y; m_pointLightColor[2]=l.pointColor.z;
+            m_pointShadowFar = std::max(1.0f, l.pointRange);
+        }
+        if (l.hasSpot)
+        {
+            m_spotEnabled = true;
+            m_spotPos[0]=l.spotPos.x; m_spotPos[1]=l.spotPos.y; m_spotPos[2]=l.spotPos.z;
+            m_spotDir[0]=l.spotDir.x; m_spotDir[1]=l.spotDir.y; m_spotDir[2]=l.spotDir.z;
+            m_spotColor[0]=l.spotColor.x; m_spotColor[1]=l.spotColor.y; m_spotColor[2]=l.spotColor.z;
+            m_spotInner = l.spotInner; m_spotOuter = l.spotOuter; m_spotNear = l.spotNear; m_spotFar = l.spotFar;
+        }
+    }
+
+    void Application::syncEmitterSystems()
+    {
+        // GL objects are created here, on the main thread, never in the simulation job
+        const bool active = m_renderFromECS && m_ecsBridge;
+        if (active)
+        {
+            auto vpe = m_ecsBridge->reg().view<ParticleEmitterC, TransformC>();
+            for (auto e : vpe)
+            {
+                auto& ps = m_emitterSystems[entt::to_integral(e)];
+                if (ps) continue;
+                ps = std::make_unique<ParticleSystem>();
+                ps->initialize(2000);
+            }
+        }
+        // drop systems whose entity is gone or no longer emits
+        for (auto it = m_emitterSystems.begin(); it != m_emitterSystems.end(); )
+        {
+            const entt::entity e = static_cast<entt::entity>(it->first);
+            if (active && m_ecsBridge->reg().valid(e) && m_ecsBridge->reg().all_of<ParticleEmitterC, TransformC>(e)) { ++it; continue; }
+            // a snapshot may still reference the system being dropped
+            for (auto& snap : m_snapshots)
+            {
+                if (!snap) continue;
+                for (int i = 0; i < snap->particleCount; ++i)
+                    if (snap->particles[i].system == it->second.get()) snap->particles[i].system = nullptr;
+            }
+            it = m_emitterSystems.erase(it);
         }
     }
+
+    void Application::waitForSimulation()
+    {
+        if (!m_jobs || !m_simCounter || m_simCounter->done()) return;
+        PROFILE_SCOPE("sim_wait");
+        m_jobs->wait(*m_simCounter);
+    }
+
     static void glfw_error_callback(int error, const char* description)
     {
         std::cerr << "GLFW Error " << error << ": " << description << std::endl;
     }
 
+    static ImU32 profileZoneColor(const char* name)
+    {
+        // stable colour per zone name (FNV-1a -> hue)
+        uint32_t h = 2166136261u;
+        for (const char* c = name; *c; ++c) { h ^= (uint8_t)*c; h *= 16777619u; }
+        float r, g, b;
+        ImGui::ColorConvertHSVtoRGB((float)(h % 360) / 360.0f, 0.45f, 0.85f, r, g, b);
+        return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+    }
+
+    // Flame view of the last captured frame (main thread) + top-level zone table
+    static void drawProfilerFlame(const Profiler& prof)
+    {
+        const auto& zones = prof.lastFrame();
+        uint64_t t0 = prof.lastFrameStartNs();
+        uint64_t t1 = prof.lastFrameEndNs();
+        if (zones.empty() || t1 <= t0) { ImGui::TextDisabled("No frame captured"); return; }
+        double spanNs = (double)(t1 - t0);
+        ImGui::Text("Frame: %.3f ms, %d zones", spanNs / 1.0e6, (int)zones.size());
+
+        uint32_t maxDepth = 0;
+        for (const auto& z : zones) maxDepth = std::max(maxDepth, z.depth);
+        const float rowH = ImGui::GetTextLineHeight() + 4.0f;
+        const float width = std::max(100.0f, ImGui::GetContentRegionAvail().x);
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("##flame", ImVec2(width, rowH * (float)(maxDepth + 1)));
+        bool hovered = ImGui::IsItemHovered();
+        ImVec2 mouse = ImGui::GetIO().MousePos;
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        for (const auto& z : zones)
+        {
+            float x0 = origin.x + (float)((double)(z.startNs - t0) / spanNs) * width;
+            float x1 = origin.x + (float)((double)(z.endNs - t0) / spanNs) * width;
+            if (x1 - x0 < 1.0f) x1 = x0 + 1.0f;
+            float y0 = origin.y + (float)z.depth * rowH;
+            float y1 = y0 + rowH - 1.0f;
+            dl->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), profileZoneColor(z.name));
+            if (x1 - x0 > 30.0f)
+            {
+                dl->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+                dl->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), z.name);
+                dl->PopClipRect();
+            }
+            if (hovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+                ImGui::SetTooltip("%s\n%.3f ms", z.name, (double)(z.endNs - z.startNs) / 1.0e6);
+        }
+
+        // top-level zones, most expensive first
+        std::vector<const ProfileZone*> top;
+        for (const auto& z : zones) if (z.depth == 0) top.push_back(&z);
+        std::sort(top.begin(), top.end(), [](const ProfileZone* a, const ProfileZone* b) { return (a->endNs - a->startNs) > (b->endNs - b->startNs); });
+        for (const ProfileZone* z : top)
+            ImGui::Text("%-16s %8.3f ms", z->name, (double)(z->endNs - z->startNs) / 1.0e6);
+    }
+
+    // GPU pass times (delayed) next to the CPU time of the zone with the same name
+    static void drawGpuPassTable(const Profiler& prof, const GpuTimer& gpu)
+    {
+        ImGui::Text("GPU frame: %.3f ms (%d frames late, %d dropped)", gpu.frameMs(), GpuTimer::kFrameLatency, gpu.droppedFrames());
+        if (!ImGui::BeginTable("##gpupasses", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) return;
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableHeadersRow();
+        for (const auto& g : gpu.results())
+        {
+            double cpuMs = 0.0;
+            for (const auto& z : prof.lastFrame())
+                if (std::strcmp(z.name, g.name) == 0) cpuMs += (double)(z.endNs - z.startNs) / 1.0e6;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%*s%s", (int)g.depth * 2, "", g.name);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", cpuMs);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", g.ms);
+        }
+        ImGui::EndTable();
+    }
+
+    // Last run of the simulation systems: dependency level, thread, start offset and time
+    static void drawSystemSchedule(const SystemScheduler& systems)
+    {
+        ImGui::Text("Systems: %.3f ms", systems.lastRunMs());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Print schedule")) std::cout << "[Systems]\n" << systems.describe() << std::flush;
+        if (!ImGui::BeginTable("##systems", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) return;
+        ImGui::TableSetupColumn("System");
+        ImGui::TableSetupColumn("Level");
+        ImGui::TableSetupColumn("Thread");
+        ImGui::TableSetupColumn("Start ms");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableHeadersRow();
+        for (const auto& s : systems.systems())
+        {
+            if (!s.enabled) continue;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%s", s.name);
+            if (ImGui::IsItemHovered() && !s.deps.empty())
+            {
+                std::string after = "after:";
+                for (int d : s.deps) after += std::string(" ") + systems.systems()[d].name;
+                ImGui::SetTooltip("%s", after.c_str());
+            }
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%d", s.level);
+            ImGui::TableSetColumnIndex(2); if (s.worker >= 0) ImGui::Text("worker %d", s.worker); else ImGui::TextUnformatted("caller");
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", s.startMs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.3f", s.ms);
+        }
+        ImGui::EndTable();
+    }
+
+    static void benchGpuFence()
+    {
+        glFinish();
+    }
+
     Application::Application() = default;
     Application::~Application()
     {
@@ -340,6 +1279,22 @@ namespace engine
     bool Application::initialize()
     {
         std::cout << "[App] initialize start" << std::endl;
+        Profiler::instance().setThreadName("Main");
+        m_jobs = std::make_unique<JobSystem>(m_bench.jobWorkers);
+        std::cout << "[App] Job system: " << m_jobs->workerCount() << " workers" << std::endl;
+        m_simCounter = std::make_unique<JobCounter>();
+        m_snapshots[0] = std::make_unique<RenderSnapshot>();
+        m_snapshots[1] = std::make_unique<RenderSnapshot>();
+        m_culler = std::make_unique<FrustumCuller>();
+        for (int i = 0; i < kShadowCacheCount; ++i) m_shadowCaches.push_back(std::make_unique<ShadowCache>());
+        m_renderQueue = std::make_unique<RenderQueue>();
+        m_sceneBvh = std::make_unique<DynamicBVH>();
+        m_pipelined = m_bench.pipelined;
+        if (m_bench.enabled) m_useInstancing = m_bench.instancing;
+        if (m_bench.enabled) m_shadowCaching = m_bench.shadowCache;
+        if (m_bench.enabled) m_shadowAtlasEnabled = m_bench.shadowAtlas;
+        if (m_bench.enabled) m_layeredShadows = m_bench.layeredShadows;
+        if (m_bench.enabled) m_clusteredLights = m_bench.clusteredLights;
         if (!initializeGLFW())
         {
             std::cerr << "[App] initializeGLFW failed" << std::endl;
@@ -347,7 +1302,16 @@ namespace engine
         }
 
         m_window = std::make_unique<Window>();
-        if (!m_window->create({}))
+        WindowProps props;
+        if (m_bench.enabled)
+        {
+            props.title = "Benchmark";
+            props.width = m_bench.width;
+            props.height = m_bench.height;
+            props.vsync = false;
+            props.visible = !m_bench.headless;
+        }
+        if (!m_window->create(props))
         {
             std::cerr << "[App] Window create failed" << std::endl;
             glfwTerminate();
@@ -366,6 +1330,18 @@ namespace engine
             return false;
         }
         std::cout << "[App] GLAD initialized" << std::endl;
+        m_gpuTimer = std::make_unique<GpuTimer>();
+        GpuTimer::setActive(m_gpuTimer.get());
+        if (m_bench.enabled)
+        {
+            m_benchRecorder = std::make_unique<BenchmarkRecorder>(m_bench);
+            if (m_bench.syncGpu) Profiler::instance().setZoneFence(benchGpuFence);
+            const char* vendor = (const char*)glGetString(GL_VENDOR);
+            const char* renderer = (const char*)glGetString(GL_RENDERER);
+            const char* version = (const char*)glGetString(GL_VERSION);
+            m_benchRecorder->setContextInfo(vendor ? vendor : "", renderer ? renderer : "", version ? version : "");
+            std::cout << "[Bench] GL: " << (renderer ? renderer : "?") << " / " << (version ? version : "?") << std::endl;
+        }
 
         m_ui = std::make_unique<UIManager>();
         if (!m_ui->initialize(m_window->getNativeHandle()))
@@ -401,25 +1377,42 @@ namespace engine
         m_inputMap->bindAxis("MoveRight",   { GLFW_KEY_D, GLFW_KEY_A, 1.0f });
         m_inputMap->bindAxis("MoveUp",      { GLFW_KEY_E, GLFW_KEY_Q, 1.0f });
 
+        // Engine uniform blocks (FrameData, LightData, ObjectData) at their fixed binding points
+        m_frameUbo = std::make_unique<UniformBuffer>();
+        m_lightUbo = std::make_unique<UniformBuffer>();
+        m_objectStream = std::make_unique<StreamBuffer>();
+        m_localLightUbo = std::make_unique<UniformBuffer>();
+        m_localLights = std::make_unique<LocalLightBlock>();
+        m_localLightTbo = std::make_unique<TextureBuffer>();
+        m_clusterCellTbo = std::make_unique<TextureBuffer>();
+        m_clusterIndexTbo = std::make_unique<TextureBuffer>();
+        m_lightClusters = std::make_unique<LightClusters>();
+        // ObjectData is rewritten per draw batch: 16 blocks per frame before the stream grows
+        if (!m_frameUbo->create(sizeof(FrameBlock), BlockFrame) || !m_lightUbo->create(sizeof(LightBlock), BlockLights)
+            || !m_objectStream->create(16 * sizeof(ObjectEntry) * kObjectsPerBlock)
+            || !m_localLightUbo->create(sizeof(LocalLightBlock), BlockLocalLights)
+            || !m_localLightTbo->create(GL_RGBA32F) || !m_clusterCellTbo->create(GL_RG32UI) || !m_clusterIndexTbo->create(GL_R32UI))
+        {
+            std::cerr << "[App] uniform buffer create failed" << std::endl;
+            return false;
+        }
+
         // Create shader (Phong + texture toggle)
         const char* vs = R"GLSL(
             #version 330 core
             layout (location = 0) in vec3 aPos;
             layout (location = 1) in vec3 aNormal;
             layout (location = 2) in vec2 aUV;
-            uniform mat4 u_Model;
-            uniform mat4 u_MVP;
-            uniform mat3 u_NormalMatrix;
             out vec3 vNormal;
             out vec3 vWorldPos;
             out vec2 vUV;
             void main()
             {
-                vec4 worldPos = u_Model * vec4(aPos, 1.0);
+                vec4 worldPos = u_Objects[u_ObjectIndex].model * vec4(aPos, 1.0);
                 vWorldPos = worldPos.xyz;
-                vNormal = normalize(u_NormalMatrix * aNormal);
+                vNormal = normalize(mat3(u_Objects[u_ObjectIndex].normalMatrix) * aNormal);
                 vUV = aUV;
-                gl_Position = u_MVP * vec4(aPos, 1.0);
+                gl_Position = u_ViewProj * worldPos;
             }
         )GLSL";
         const char* fs = R"GLSL(
@@ -428,34 +1421,15 @@ namespace engine
             in vec3 vNormal;
             in vec3 vWorldPos;
             in vec2 vUV;
-            uniform vec3 u_CameraPos;
-            uniform vec3 u_LightPos;
-            uniform vec3 u_LightColor;
-            // point light
-            uniform vec3 u_PointLightPos;
-            uniform vec3 u_PointLightColor;
-            uniform float u_PointShadowFar;
-            uniform float u_PointShadowBias;
-            uniform bool u_PointShadowsEnabled;
+            // camera, lights and shadow parameters come from FrameData / LightData
             uniform samplerCube u_PointShadowMap;
             uniform vec3 u_Albedo;
             uniform float u_Shininess;
             uniform bool u_UseTexture;
             uniform sampler2D u_AlbedoTex;
-            // shadows
-            uniform bool u_ShadowsEnabled;
-            uniform mat4 u_LightVP;
+            uniform bool u_ReceiveShadows;
             uniform sampler2D u_ShadowMap;
-            uniform float u_ShadowBias;
-            // CSM + PCF/PCSS
-            uniform int u_UseCSM;
-            uniform int u_CascadeCount;
-            uniform mat4 u_CascadeVP[4];
-            uniform sampler2D u_CascadeMap[4];
-            uniform int u_PCFKernel; // texel radius
-            uniform float u_ShadowMapSize;
-            uniform int u_UsePCSS;
-            uniform float u_LightRadius;
+            uniform sampler2DArray u_CascadeMaps;
 
             bool inside01(vec3 p){ return p.x>=0.0 && p.x<=1.0 && p.y>=0.0 && p.y<=1.0 && p.z<=1.0; }
             float sampleShadowMap(sampler2D map, vec3 projCoords)
@@ -480,6 +1454,22 @@ namespace engine
                 }
                 return count>0 ? (occl/float(count)) : 0.0;
             }
+            float sampleCascade(int cascade, vec3 projCoords)
+            {
+                float texel = 1.0 / max(u_ShadowMapSize, 1.0);
+                int r = max(u_PCFKernel, 0);
+                if (u_UsePCSS==1) r = int(float(r) * (1.0 + projCoords.z * u_LightRadius));
+                float occl = 0.0;
+                int count = 0;
+                for (int x=-r; x<=r; ++x)
+                for (int y=-r; y<=r; ++y)
+                {
+                    float closest = texture(u_CascadeMaps, vec3(projCoords.xy + vec2(x,y) * texel, float(cascade))).r;
+                    occl += (projCoords.z - u_ShadowBias > closest) ? 1.0 : 0.0;
+                    count++;
+                }
+                return count>0 ? (occl/float(count)) : 0.0;
+            }
             float computeShadow(vec3 worldPos)
             {
                 if (u_UseCSM==0)
@@ -494,7 +1484,7 @@ namespace engine
                     vec4 clip = u_CascadeVP[i] * vec4(worldPos,1.0);
                     vec3 proj = clip.xyz / max(clip.w, 1e-6); proj = proj*0.5+0.5;
                     if (inside01(proj))
-                        return sampleShadowMap(u_CascadeMap[i], proj);
+                        return sampleCascade(i, proj);
                 }
                 return 0.0;
             }
@@ -502,7 +1492,7 @@ namespace engine
             {
                 vec3 L = worldPos - u_PointLightPos;
                 float current = length(L);
-                float closest = texture(u_PointShadowMap, normalize(L)).r;
+                float closest = texture(u_PointShadowMap, normalize(L)).r * u_PointShadowFar;
                 return (current - u_PointShadowBias > closest) ? 1.0 : 0.0;
             }
             void main()
@@ -514,7 +1504,7 @@ namespace engine
                 float diff = max(dot(N, L), 0.0);
                 float spec = pow(max(dot(N, H), 0.0), u_Shininess);
                 vec3 baseColor = u_UseTexture ? texture(u_AlbedoTex, vUV).rgb : u_Albedo;
-                float shadow = (u_ShadowsEnabled) ? computeShadow(vWorldPos) : 0.0;
+                float shadow = (u_ShadowsEnabled != 0 && u_ReceiveShadows) ? computeShadow(vWorldPos) : 0.0;
                 vec3 color = baseColor * (0.1 + (1.0 - shadow) * diff) + u_LightColor * (1.0 - shadow) * spec;
                 // point light
                 vec3 Lp = normalize(u_PointLightPos - vWorldPos);
@@ -522,13 +1512,13 @@ namespace engine
                 float diffP = max(dot(N, Lp), 0.0);
                 float specP = pow(max(dot(N, Hp), 0.0), u_Shininess);
                 float shadowP = 0.0;
-                if (u_PointShadowsEnabled)
+                if (u_PointShadowsEnabled != 0 && u_ReceiveShadows)
                     shadowP = samplePointShadow(vWorldPos);
                 color += baseColor * (1.0 - shadowP) * diffP + u_PointLightColor * (1.0 - shadowP) * specP;
                 FragColor = vec4(color, 1.0);
             }
         )GLSL";
-        m_shader = std::unique_ptr<Shader>(m_resources->getShaderFromSource("phong_textured", vs, fs));
+        m_shader = std::unique_ptr<Shader>(m_resources->getShaderFromSource("phong_textured", withUniformBlocks(vs), withUniformBlocks(fs)));
         if (!m_shader)
             return false;
 
@@ -553,6 +1543,23 @@ namespace engine
             std::cerr << "[DepthShader] compile failed" << std::endl;
             return false;
         }
+        // Instanced variant: model matrix per instance at attributes 3-6 (Mesh::setInstanceTransforms)
+        const char* dvsInst = R"GLSL(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 3) in mat4 aInstanceModel;
+            uniform mat4 u_LightVP;
+            void main()
+            {
+                gl_Position = u_LightVP * aInstanceModel * vec4(aPos, 1.0);
+            }
+        )GLSL";
+        m_depthInstancedShader = std::make_unique<Shader>();
+        if (!m_depthInstancedShader->compileFromSource(dvsInst, dfs))
+        {
+            std::cerr << "[DepthShader] instanced compile failed" << std::endl;
+            return false;
+        }
         // Skinning shader (Phong + texture)
         const char* skVS = R"GLSL(
             #version 330 core
@@ -561,9 +1568,6 @@ namespace engine
             layout (location = 2) in vec2 aUV;
             layout (location = 3) in uvec4 aBoneIds;
             layout (location = 4) in vec4 aWeights;
-            uniform mat4 u_Model;
-            uniform mat4 u_VP;
-            uniform mat3 u_NormalMatrix;
             const int MAX_BONES = 128;
             uniform mat4 u_Bones[MAX_BONES];
             out vec3 vNormal;
@@ -571,20 +1575,18 @@ namespace engine
             out vec2 vUV;
             void main(){
                 mat4 skin = aWeights.x * u_Bones[aBoneIds.x] + aWeights.y * u_Bones[aBoneIds.y] + aWeights.z * u_Bones[aBoneIds.z] + aWeights.w * u_Bones[aBoneIds.w];
-                vec4 wp = u_Model * skin * vec4(aPos,1.0);
+                mat4 model = u_Objects[u_ObjectIndex].model;
+                vec4 wp = model * skin * vec4(aPos,1.0);
                 vWorldPos = wp.xyz;
-                vNormal = normalize(u_NormalMatrix * mat3(u_Model * skin) * aNormal);
+                vNormal = normalize(mat3(u_Objects[u_ObjectIndex].normalMatrix) * mat3(model * skin) * aNormal);
                 vUV = aUV;
-                gl_Position = u_VP * wp;
+                gl_Position = u_ViewProj * wp;
             }
         )GLSL";
         const char* skFS = R"GLSL(
             #version 330 core
             out vec4 FragColor;
             in vec3 vNormal; in vec3 vWorldPos; in vec2 vUV;
-            uniform vec3 u_CameraPos;
-            uniform vec3 u_LightPos;
-            uniform vec3 u_LightColor;
             uniform vec3 u_Albedo; uniform float u_Shininess; uniform bool u_UseTexture; uniform sampler2D u_AlbedoTex;
             void main(){
                 vec3 N = normalize(vNormal);
@@ -599,12 +1601,12 @@ namespace engine
             }
         )GLSL";
         m_skinShader = std::make_unique<Shader>();
-        if (!m_skinShader->compileFromSource(skVS, skFS))
+        if (!m_skinShader->compileFromSource(withUniformBlocks(skVS), withUniformBlocks(skFS)))
         {
             std::cerr << "[SkinShader] compile failed" << std::endl;
             return false;
         }
-        // Point light depth shader (distance to light in color)
+        // Point light depth shader (linear distance to light as depth)
         const char* pvs = R"GLSL(
             #version 330 core
             layout (location = 0) in vec3 aPos;
@@ -622,11 +1624,11 @@ namespace engine
         const char* pfs = R"GLSL(
             #version 330 core
             in vec3 vWorldPos;
-            out float FragDist;
             uniform vec3 u_LightPos;
+            uniform float u_FarPlane;
             void main()
             {
-                FragDist = length(vWorldPos - u_LightPos);
+                gl_FragDepth = length(vWorldPos - u_LightPos) / u_FarPlane;
             }
         )GLSL";
         m_pointDepthShader = std::make_unique<Shader>();
@@ -635,6 +1637,91 @@ namespace engine
             std::cerr << "[PointDepthShader] compile failed" << std::endl;
             return false;
         }
+        const char* pvsInst = R"GLSL(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 3) in mat4 aInstanceModel;
+            uniform mat4 u_View;
+            uniform mat4 u_Proj;
+            out vec3 vWorldPos;
+            void main()
+            {
+                vec4 wp = aInstanceModel * vec4(aPos, 1.0);
+                vWorldPos = wp.xyz;
+                gl_Position = u_Proj * u_View * wp;
+            }
+        )GLSL";
+        m_pointDepthInstancedShader = std::make_unique<Shader>();
+        if (!m_pointDepthInstancedShader->compileFromSource(pvsInst, pfs))
+        {
+            std::cerr << "[PointDepthShader] instanced compile failed" << std::endl;
+            return false;
+        }
+
+        // Layered depth: the vertex stage passes world positions, the geometry stage emits each
+        // triangle once per layer in u_LayerMask that it overlaps (gl_Layer = cube face / cascade)
+        const char* lvs = R"GLSL(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            uniform mat4 u_Model;
+            void main() { gl_Position = u_Model * vec4(aPos, 1.0); }
+        )GLSL";
+        const char* lvsInst = R"GLSL(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 3) in mat4 aInstanceModel;
+            void main() { gl_Position = aInstanceModel * vec4(aPos, 1.0); }
+        )GLSL";
+        const char* lgs = R"GLSL(
+            #version 330 core
+            layout (triangles) in;
+            layout (triangle_strip, max_vertices = 18) out;
+            uniform mat4 u_LayerVP[6];
+            uniform int u_LayerMask;
+            out vec3 gWorldPos;
+            void main()
+            {
+                for (int layer = 0; layer < 6; ++layer)
+                {
+                    if ((u_LayerMask & (1 << layer)) == 0) continue;
+                    vec4 c0 = u_LayerVP[layer] * gl_in[0].gl_Position;
+                    vec4 c1 = u_LayerVP[layer] * gl_in[1].gl_Position;
+                    vec4 c2 = u_LayerVP[layer] * gl_in[2].gl_Position;
+                    // outside one side or beyond the far plane: not in this layer (the near
+                    // plane is left alone, cascades clamp casters in front of it)
+                    if (c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w) continue;
+                    if (c0.x >  c0.w && c1.x >  c1.w && c2.x >  c2.w) continue;
+                    if (c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w) continue;
+                    if (c0.y >  c0.w && c1.y >  c1.w && c2.y >  c2.w) continue;
+                    if (c0.z >  c0.w && c1.z >  c1.w && c2.z >  c2.w) continue;
+                    gl_Layer = layer; gl_Position = c0; gWorldPos = gl_in[0].gl_Position.xyz; EmitVertex();
+                    gl_Layer = layer; gl_Position = c1; gWorldPos = gl_in[1].gl_Position.xyz; EmitVertex();
+                    gl_Layer = layer; gl_Position = c2; gWorldPos = gl_in[2].gl_Position.xyz; EmitVertex();
+                    EndPrimitive();
+                }
+            }
+        )GLSL";
+        const char* lfsPoint = R"GLSL(
+            #version 330 core
+            in vec3 gWorldPos;
+            uniform vec3 u_LightPos;
+            uniform float u_FarPlane;
+            void main() { gl_FragDepth = length(gWorldPos - u_LightPos) / u_FarPlane; }
+        )GLSL";
+        // without them the cube faces and cascades fall back to one pass each
+        m_layeredDepthShader = std::make_unique<Shader>();
+        m_layeredDepthInstancedShader = std::make_unique<Shader>();
+        m_layeredPointShader = std::make_unique<Shader>();
+        m_layeredPointInstancedShader = std::make_unique<Shader>();
+        if (!m_layeredDepthShader->compileFromSource(lvs, lgs, dfs) || !m_layeredDepthInstancedShader->compileFromSource(lvsInst, lgs, dfs)
+            || !m_layeredPointShader->compileFromSource(lvs, lgs, lfsPoint) || !m_layeredPointInstancedShader->compileFromSource(lvsInst, lgs, lfsPoint))
+        {
+            std::cerr << "[LayeredDepthShader] compile failed, shadow layers drawn one by one" << std::endl;
+            m_layeredDepthShader.reset();
+            m_layeredDepthInstancedShader.reset();
+            m_layeredPointShader.reset();
+            m_layeredPointInstancedShader.reset();
+        }
 
         // Cube mesh
         m_cube = std::unique_ptr<Mesh>(m_resources->getCube("unit_cube"));
@@ -661,6 +1748,13 @@ namespace engine
         }
         // Point shadow map (deferred create on first enable)
         m_pointShadowMap = std::make_unique<PointShadowMap>();
+        // Shadow atlas of the ECS point/spot lights; lights stay unshadowed without it
+        m_shadowAtlas = std::make_unique<ShadowAtlas>();
+        if (!m_shadowAtlas->create(m_shadowAtlasSize, 64))
+        {
+            std::cerr << "[ShadowAtlas] create failed, local lights unshadowed" << std::endl;
+            m_shadowAtlas.reset();
+        }
 
         // Skybox
         m_skybox = std::make_unique<Skybox>();
@@ -679,6 +1773,9 @@ namespace engine
         m_scene = std::make_unique<Scene>();
         // ECS setup (coexists for now)
         m_ecsBridge = std::make_unique<ECSBridge>();
+        registerSimulationSystems();
+        if (!m_bench.enabled) m_autosave = std::make_unique<SceneAutosave>();
+        if (m_lua) m_lua->bindRegistry(&m_ecsBridge->reg());
         {
             auto& reg = m_ecsBridge->reg();
             // Create three cubes in ECS for hierarchy/inspector demo
@@ -702,6 +1799,7 @@ namespace engine
 
         // Physics setup
         m_physics = std::make_unique<Physics>();
+        m_physics->setJobSystem(m_jobs.get());
         if (m_physics->initialize())
         {
             if (m_physics->createDefaultScene(-9.81f))
@@ -717,18 +1815,13 @@ namespace engine
             layout (location = 0) in vec3 aPos;
             layout (location = 1) in vec3 aNormal;
             layout (location = 2) in vec2 aUV;
-            uniform mat4 u_Model;
-            uniform mat4 u_MVP;
-            uniform mat3 u_NormalMatrix;
             out vec3 vN; out vec3 vW; out vec2 vUV;
-            void main(){ vec4 w = u_Model * vec4(aPos,1.0); vW=w.xyz; vN=normalize(u_NormalMatrix*aNormal); vUV=aUV; gl_Position=u_MVP*vec4(aPos,1.0);} 
+            void main(){ ObjectEntry o = u_Objects[u_ObjectIndex]; vec4 w = o.model * vec4(aPos,1.0); vW=w.xyz; vN=normalize(mat3(o.normalMatrix)*aNormal); vUV=aUV; gl_Position=u_ViewProj*w;} 
         )GLSL";
         const char* pbrFS = R"GLSL(
             #version 330 core
             out vec4 FragColor;
             in vec3 vN; in vec3 vW; in vec2 vUV;
-            uniform vec3 u_Cam;
-            uniform vec3 u_LightPos;
             uniform vec3 u_Albedo;
             uniform float u_Metallic; uniform float u_Roughness; uniform float u_AO;
             uniform bool u_UseAlbedoTex; uniform sampler2D u_AlbedoTex;
@@ -737,22 +1830,63 @@ namespace engine
             uniform bool u_UseAOTex; uniform sampler2D u_AOTex;
             uniform bool u_UseNormalMap; uniform sampler2D u_NormalTex;
             uniform bool u_UseIBL; uniform samplerCube u_IrradianceMap; uniform samplerCube u_PrefilterMap; uniform sampler2D u_BRDFLUT;
-            // Shadows (CSM + PCF/PCSS)
-            uniform bool u_ShadowsEnabled;
-            uniform int u_UseCSM; uniform int u_CascadeCount; uniform mat4 u_CascadeVP[4]; uniform sampler2D u_CascadeMap[4];
-            uniform mat4 u_LightVP; uniform sampler2D u_ShadowMap;
-            uniform float u_ShadowBias; uniform int u_PCFKernel; uniform float u_ShadowMapSize; uniform int u_UsePCSS; uniform float u_LightRadius;
+            // Shadow maps (parameters in LightData)
+            uniform sampler2DArray u_CascadeMaps; uniform sampler2D u_ShadowMap;
             bool inside01(vec3 p){ return p.x>=0.0 && p.x<=1.0 && p.y>=0.0 && p.y<=1.0 && p.z<=1.0; }
             float sampleShadowMap(sampler2D map, vec3 projCoords){
               float current = projCoords.z; float texel = 1.0/max(u_ShadowMapSize,1.0); int r=max(u_PCFKernel,0);
               if (u_UsePCSS==1){ float scale = 1.0 + current * u_LightRadius; r = int(float(r)*scale);} float occl=0.0; int cnt=0;
               for(int x=-r;x<=r;++x) for(int y=-r;y<=r;++y){ vec2 uv = projCoords.xy + vec2(x,y)*texel; float closest = texture(map, uv).r; occl += (current - u_ShadowBias > closest) ? 1.0 : 0.0; cnt++; }
               return cnt>0? occl/float(cnt) : 0.0; }
-            float computeShadow(vec3 worldPos){ if (!u_ShadowsEnabled) return 0.0; if (u_UseCSM==0){ vec4 clip=u_LightVP*vec4(worldPos,1.0); vec3 proj=clip.xyz/clip.w; proj=proj*0.5+0.5; if(!inside01(proj)) return 0.0; return sampleShadowMap(u_ShadowMap, proj);} for(int i=0;i<u_CascadeCount;i++){ vec4 clip=u_CascadeVP[i]*vec4(worldPos,1.0); vec3 proj=clip.xyz/max(clip.w,1e-6); proj=proj*0.5+0.5; if(inside01(proj)) return sampleShadowMap(u_CascadeMap[i], proj);} return 0.0; }
+            float sampleCascade(int cascade, vec3 projCoords){
+              float current = projCoords.z; float texel = 1.0/max(u_ShadowMapSize,1.0); int r=max(u_PCFKernel,0);
+              if (u_UsePCSS==1){ float scale = 1.0 + current * u_LightRadius; r = int(float(r)*scale);} float occl=0.0; int cnt=0;
+              for(int x=-r;x<=r;++x) for(int y=-r;y<=r;++y){ vec2 uv = projCoords.xy + vec2(x,y)*texel; float closest = texture(u_CascadeMaps, vec3(uv, float(cascade))).r; occl += (current - u_ShadowBias > closest) ? 1.0 : 0.0; cnt++; }
+              return cnt>0? occl/float(cnt) : 0.0; }
+            float computeShadow(vec3 worldPos){ if (u_ShadowsEnabled == 0) return 0.0; if (u_UseCSM==0){ vec4 clip=u_LightVP*vec4(worldPos,1.0); vec3 proj=clip.xyz/clip.w; proj=proj*0.5+0.5; if(!inside01(proj)) return 0.0; return sampleShadowMap(u_ShadowMap, proj);} for(int i=0;i<u_CascadeCount;i++){ vec4 clip=u_CascadeVP[i]*vec4(worldPos,1.0); vec3 proj=clip.xyz/max(clip.w,1e-6); proj=proj*0.5+0.5; if(inside01(proj)) return sampleCascade(i, proj);} return 0.0; }
             float DistributionGGX(vec3 N, vec3 H, float a){ float a2=a*a; float NdotH=max(dot(N,H),0.0); float NdotH2=NdotH*NdotH; float denom=(NdotH2*(a2-1.0)+1.0); return a2/(3.14159265*denom*denom); }
             float GeometrySchlickGGX(float NdotV, float k){ return NdotV/(NdotV*(1.0-k)+k); }
             float GeometrySmith(vec3 N, vec3 V, vec3 L, float k){ float NdotV=max(dot(N,V),0.0); float NdotL=max(dot(N,L),0.0); float g1=GeometrySchlickGGX(NdotV,k); float g2=GeometrySchlickGGX(NdotL,k); return g1*g2; }
             vec3 fresnelSchlick(float cosTheta, vec3 F0){ return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0); }
+            // Local lights (LocalLightData) with their shadow tiles in the atlas
+            uniform sampler2D u_ShadowAtlas;
+            float atlasShadow(int tile, vec3 worldPos, float bias){
+              vec4 clip=u_ShadowTiles[tile].viewProj*vec4(worldPos,1.0); vec3 p=clip.xyz/max(clip.w,1e-6)*0.5+0.5; if(!inside01(p)) return 0.0;
+              // 3x3 PCF kept inside the tile
+              vec4 r=u_ShadowTiles[tile].rect; vec2 lo=r.xy+vec2(0.5*u_AtlasTexel); vec2 hi=r.xy+r.zw-vec2(0.5*u_AtlasTexel); float occl=0.0;
+              for(int x=-1;x<=1;++x) for(int y=-1;y<=1;++y){ vec2 uv=clamp(r.xy+p.xy*r.zw+vec2(x,y)*u_AtlasTexel, lo, hi); occl += (p.z-bias > textureLod(u_ShadowAtlas, uv, 0.0).r) ? 1.0 : 0.0; }
+              return occl/9.0; }
+            // cube face of a direction from the light, in the order of the point light tiles
+            int cubeFace(vec3 d){ vec3 a=abs(d); if(a.x>=a.y && a.x>=a.z) return d.x>0.0?0:1; if(a.y>=a.z) return d.y>0.0?2:3; return d.z>0.0?4:5; }
+            // Light i: 4 texels of u_LocalLightBuffer laid out as LocalLightEntry
+            uniform samplerBuffer u_LocalLightBuffer;
+            vec3 localLight(int i, vec3 N, vec3 V, vec3 base, vec3 F0, float metallic, float roughness){
+              vec4 t0=texelFetch(u_LocalLightBuffer,i*4); vec4 t1=texelFetch(u_LocalLightBuffer,i*4+1);
+              vec4 t2=texelFetch(u_LocalLightBuffer,i*4+2); vec4 t3=texelFetch(u_LocalLightBuffer,i*4+3);
+              float range=t0.w; vec3 toLight=t0.xyz-vW; float dist=length(toLight); if(dist>=range) return vec3(0.0);
+              vec3 L=toLight/max(dist,1e-4); bool isSpot=floatBitsToInt(t1.w)!=0; int firstTile=floatBitsToInt(t3.x);
+              float falloff=clamp(1.0-pow(dist/range,4.0),0.0,1.0); float atten=falloff*falloff/(dist*dist+1.0);
+              if(isSpot) atten*=smoothstep(t2.w, t3.y, dot(-L, t2.xyz));
+              if(atten<=0.0) return vec3(0.0);
+              float shadow = firstTile<0 ? 0.0 : atlasShadow(isSpot ? firstTile : firstTile+cubeFace(-toLight), vW, t3.z);
+              vec3 H=normalize(V+L); float NdotL=max(dot(N,L),0.0);
+              float NDF=DistributionGGX(N,H,roughness*roughness); float G=GeometrySmith(N,V,L,(roughness+1.0)*(roughness+1.0)/8.0); vec3 F=fresnelSchlick(max(dot(H,V),0.0),F0);
+              vec3 kD=(vec3(1.0)-F)*(1.0-metallic); vec3 spec=(NDF*G*F)/max(4.0*max(dot(N,V),0.0)*NdotL,0.001);
+              return (kD*base/3.14159265+spec)*t1.xyz*atten*NdotL*(1.0-shadow); }
+            // Froxel of the fragment (as LightClusters bins it): offset and count of its lights in u_ClusterLights
+            uniform usamplerBuffer u_ClusterCells; uniform usamplerBuffer u_ClusterLights;
+            vec3 localLighting(vec3 N, vec3 V, vec3 base, vec3 F0, float metallic, float roughness){
+              vec3 sum=vec3(0.0);
+              if(u_ClusterGrid.x==0){
+                for(int i=0;i<u_LocalLightCount;++i) sum+=localLight(i, N, V, base, F0, metallic, roughness);
+                return sum; }
+              vec4 clip=u_ViewProj*vec4(vW,1.0); vec2 ndc=clip.xy/max(clip.w,1e-6);
+              float depth=-(u_View*vec4(vW,1.0)).z;
+              ivec2 tile=clamp(ivec2((ndc*0.5+0.5)*vec2(u_ClusterGrid.xy)), ivec2(0), u_ClusterGrid.xy-1);
+              int slice=clamp(int(floor(log(max(depth,1e-4))*u_ClusterZScale+u_ClusterZBias)), 0, u_ClusterGrid.z-1);
+              uvec2 cell=texelFetch(u_ClusterCells, (slice*u_ClusterGrid.y+tile.y)*u_ClusterGrid.x+tile.x).xy;
+              for(uint j=0u;j<cell.y;++j) sum+=localLight(int(texelFetch(u_ClusterLights, int(cell.x+j)).r), N, V, base, F0, metallic, roughness);
+              return sum; }
             void main(){
               vec3 N=normalize(vN);
               if (u_UseNormalMap){
@@ -766,7 +1900,7 @@ namespace engine
                 vec3 nTex = texture(u_NormalTex, vUV).xyz * 2.0 - 1.0;
                 N = normalize(TBN * nTex);
               }
-              vec3 V=normalize(u_Cam - vW);
+              vec3 V=normalize(u_CameraPos - vW);
               vec3 L=normalize(u_LightPos - vW);
               vec3 H=normalize(V+L);
               vec3 base = u_UseAlbedoTex? texture(u_AlbedoTex, vUV).rgb : u_Albedo;
@@ -782,6 +1916,7 @@ namespace engine
               vec3 spec = (NDF*G*F) / max(4.0*max(dot(N,V),0.0)*NdotL, 0.001);
               float shadow = computeShadow(vW);
               vec3 Lo = (kD*base/3.14159265 + spec) * NdotL * (1.0 - shadow);
+              Lo += localLighting(N, V, base, F0, metallic, roughness);
               vec3 ambient;
               if (u_UseIBL){
                 vec3 irradiance = texture(u_IrradianceMap, N).rgb;
@@ -799,10 +1934,26 @@ namespace engine
             }
         )GLSL";
         m_pbrShader = std::make_unique<Shader>();
-        if (!m_pbrShader->compileFromSource(pbrVS, pbrFS))
+        if (!m_pbrShader->compileFromSource(withUniformBlocks(pbrVS), withUniformBlocks(pbrFS)))
         {
             std::cerr << "[PBR] compile failed" << std::endl;
         }
+        // Instanced PBR: same fragment stage, model matrix per instance, normal matrix derived in the shader
+        const char* pbrInstVS = R"GLSL(
+            #version 330 core
+            layout (location = 0) in vec3 aPos;
+            layout (location = 1) in vec3 aNormal;
+            layout (location = 2) in vec2 aUV;
+            layout (location = 3) in mat4 aInstanceModel;
+            out vec3 vN; out vec3 vW; out vec2 vUV;
+            void main(){ vec4 w = aInstanceModel * vec4(aPos,1.0); vW=w.xyz; vN=normalize(transpose(inverse(mat3(aInstanceModel)))*aNormal); vUV=aUV; gl_Position=u_ViewProj*w;} 
+        )GLSL";
+        m_pbrInstancedShader = std::make_unique<Shader>();
+        if (!m_pbrInstancedShader->compileFromSource(withUniformBlocks(pbrInstVS), withUniformBlocks(pbrFS)))
+        {
+            std::cerr << "[PBR] instanced compile failed" << std::endl;
+            m_pbrInstancedShader.reset();
+        }
 
         // Additional UI Panels
         if (m_ui)
@@ -837,6 +1988,18 @@ namespace engine
                     ImGui::SliderInt("Cascade Count", &m_cascadeCount, 1, 4);
                     ImGui::SliderInt("CSM Size", &m_csmSize, 256, 4096);
                     ImGui::DragFloat4("Cascade Ends", m_cascadeEnds, 0.5f, 0.1f, 500.0f);
+                    ImGui::SliderInt("Far Cascade Interval", &m_cascadeUpdateInterval, 1, 8);
+                    ImGui::Checkbox("Static Shadow Cache", &m_shadowCaching);
+                    ImGui::SameLine(); ImGui::Text("(%d re-rendered)", m_shadowCacheUpdates);
+                    ImGui::Checkbox("Shadow Atlas (ECS point/spot)", &m_shadowAtlasEnabled);
+                    if (m_layeredDepthShader) ImGui::Checkbox("Layered point/CSM shadows", &m_layeredShadows);
+                    ImGui::SliderInt("Atlas Max Tile", &m_shadowAtlasMaxTile, 64, m_shadowAtlasSize / 2);
+                    ImGui::SliderFloat("Atlas Bias", &m_shadowAtlasBias, 0.0f, 0.005f, "%.5f");
+                    ImGui::Text("Atlas %d: %d lights, %d tiles", m_shadowAtlasSize, m_localLights ? m_localLights->lightCount : 0, m_atlasTileCount);
+                    ImGui::Checkbox("Clustered local lights", &m_clusteredLights);
+                    if (m_clusteredLights && m_lightClusters)
+                        ImGui::Text("Clusters %dx%dx%d: %d light refs", m_lightClusters->gridX(), m_lightClusters->gridY(), m_lightClusters->gridZ(),
+                                    (int)m_lightClusters->lightIndices().size());
                     ImGui::Checkbox("PCF", &m_usePCF); ImGui::SameLine(); ImGui::Checkbox("PCSS", &m_usePCSS);
                     ImGui::SliderInt("PCF Kernel", &m_pcfKernel, 1, 4);
                     ImGui::SliderFloat("Light Radius", &m_lightRadius, 0.0f, 2.0f);
@@ -889,8 +2052,46 @@ namespace engine
                     ImGui::Separator();
                     ImGui::Text("Performance");
                     ImGui::Checkbox("Frustum Culling", &m_frustumCulling);
-                    ImGui::Checkbox("Instancing (same Mesh)", &m_useInstancing);
+                    if (m_renderFromECS && m_snapshots[m_frontSnapshot])
+                        ImGui::Text("ECS visible: %d / %d (%s)", (int)m_visibleItems.size(),
+                                    (int)m_snapshots[m_frontSnapshot]->items.size(), FrustumCuller::simdPath());
+                    ImGui::Text("ECS pass: %d items in %u draws, %u program binds, %u texture binds, %u uniforms, %u blocks", m_pbrPackets,
+                                m_pbrStats.drawCalls, m_pbrStats.programBinds, m_pbrStats.textureBinds, m_pbrStats.uniformUploads, m_pbrStats.bufferUploads);
+                    ImGui::Text("Frame: %u draws, %u program binds, %u texture binds, %u uniforms, %u blocks", m_frameStats.drawCalls,
+                                m_frameStats.programBinds, m_frameStats.textureBinds, m_frameStats.uniformUploads, m_frameStats.bufferUploads);
+                    ImGui::Checkbox("Instancing (same Mesh + Material)", &m_useInstancing);
+                    {
+                        const GeometryArena& arena = GeometryArena::instance();
+                        ImGui::Text("Geometry arena: %d meshes, %.1f / %.1f MB vertices, %.1f MB indices, MDI %s",
+                                    arena.allocationCount(), arena.vertexBytesUsed() / 1048576.0, arena.vertexBytesCapacity() / 1048576.0,
+                                    arena.indexBytesUsed() / 1048576.0, arena.multiDrawIndirect() ? "on" : "off");
+                    }
                     ImGui::Checkbox("Draw Colliders", &m_drawColliders);
+                    ImGui::Checkbox("Pipelined Frame", &m_pipelined);
+                    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Simulate the next frame on workers while this one renders (one frame of latency)");
+                    ImGui::Separator();
+                    ImGui::Text("CPU Profiler");
+                    Profiler& prof = Profiler::instance();
+                    bool profEnabled = prof.enabled();
+                    if (ImGui::Checkbox("Enabled##prof", &profEnabled)) prof.setEnabled(profEnabled);
+                    ImGui::SameLine();
+                    bool frozen = prof.frozen();
+                    if (ImGui::Checkbox("Freeze", &frozen)) prof.setFrozen(frozen);
+                    ImGui::Checkbox("Freeze on spike", &m_profFreezeOnSpike);
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(120.0f);
+                    ImGui::DragFloat("ms##spike", &m_profSpikeMs, 0.5f, 1.0f, 500.0f, "%.1f");
+                    ImGui::PlotLines("Frame ms", m_frameHistory, kFrameHistory, m_frameHistoryPos, nullptr, 0.0f, m_profSpikeMs * 1.5f, ImVec2(0, 50));
+                    ImGui::InputText("Trace Path", m_tracePath, sizeof(m_tracePath));
+                    if (ImGui::Button("Dump Chrome Trace")) prof.dumpChromeTrace(m_tracePath);
+                    drawProfilerFlame(prof);
+                    if (m_systems && ImGui::CollapsingHeader("Systems")) drawSystemSchedule(*m_systems);
+                    if (m_gpuTimer)
+                    {
+                        bool gpuEnabled = m_gpuTimer->enabled();
+                        if (ImGui::Checkbox("GPU Timers", &gpuEnabled)) m_gpuTimer->setEnabled(gpuEnabled);
+                        drawGpuPassTable(prof, *m_gpuTimer);
+                    }
                 }
                 ImGui::End();
             }, &m_panelPost);
@@ -1058,10 +2259,42 @@ namespace engine
                 {
                     ImGui::Text("Model Import (OBJ/FBX/GLTF)");
                     ImGui::InputText("Model Path", m_modelPath, sizeof(m_modelPath));
+                    ImGui::Checkbox("As ECS node tree", &m_importAsHierarchy);
                     if (ImGui::Button("Import Model") && m_modelPath[0] != '\0')
                     {
                         std::vector<ImportedMesh> ims;
-                        if (AssimpLoader::loadModel(m_resources.get(), m_modelPath, ims, true))
+                        std::vector<ImportedNode> nodes;
+                        if (m_importAsHierarchy && AssimpLoader::loadModel(m_resources.get(), m_modelPath, ims, true, &nodes))
+                        {
+                            // one ECS entity per file node, parented as in the file; a node's second and
+                            // later meshes hang off it as extra children
+                            auto& reg = m_ecsBridge->reg();
+                            std::vector<entt::entity> nodeEntity(nodes.size(), entt::null);
+                            for (size_t i = 0; i < nodes.size(); ++i)
+                            {
+                                const ImportedNode& node = nodes[i];
+                                auto e = m_ecsBridge->data().createEntity(node.name.empty() ? "Node" : node.name);
+                                auto& tr = reg.get<TransformC>(e);
+                                tr.position = node.position;
+                                tr.rotation = node.rotation;
+                                tr.scale = node.scale;
+                                if (node.parent >= 0) setParent(reg, e, nodeEntity[node.parent]);
+                                nodeEntity[i] = e;
+                                for (size_t m = 0; m < node.meshes.size(); ++m)
+                                {
+                                    const ImportedMesh& im = ims[node.meshes[m]];
+                                    entt::entity target = e;
+                                    if (m > 0)
+                                    {
+                                        target = m_ecsBridge->data().createEntity(im.name.empty() ? "Mesh" : im.name);
+                                        setParent(reg, target, e);
+                                    }
+                                    reg.emplace<MeshRendererC>(target, MeshRendererC{ im.mesh, nullptr, im.diffuse ? im.diffuse : m_texture.get(), false });
+                                }
+                            }
+                            for (auto& im : ims) m_importedMeshes.emplace_back(im.mesh);
+                        }
+                        else if (!m_importAsHierarchy && AssimpLoader::loadModel(m_resources.get(), m_modelPath, ims, true))
                         {
                             for (auto& im : ims)
                             {
@@ -1085,23 +2318,7 @@ namespace engine
                     ImGui::Text("Skinned Import (GLTF/FBX)");
                     ImGui::InputText("Skinned Path", m_skinPath, sizeof(m_skinPath));
                     if (ImGui::Button("Import Skinned") && m_skinPath[0] != '\0')
-                    {
-                        ImportedSkinned isk;
-                        if (AssimpLoader::loadSkinned(m_resources.get(), m_skinPath, isk, true))
-                        {
-                            m_skinMesh.reset(isk.mesh);
-                            m_skinSkeleton.reset(isk.skeleton);
-                            m_skinDiffuse = isk.diffuse;
-                            m_skinAnimations = isk.animations ? *isk.animations : std::vector<Animation>();
-                            delete isk.animations;
-                            if (!m_skinAnimator) m_skinAnimator = std::make_unique<Animator>();
-                            if (!m_skinAnimations.empty())
-                            {
-                                m_skinAnimIndex = 0; m_skinPlaying = true; m_skinLoop = true;
-                                m_skinAnimator->play(&m_skinAnimations[0], m_skinLoop);
-                            }
-                        }
-                    }
+                        loadSkinnedModel(m_skinPath);
                     if (!m_skinAnimations.empty())
                     {
                         ImGui::Text("Animation");
@@ -1134,7 +2351,7 @@ namespace engine
                         std::string fs = loadFile(m_fsPath);
                         if (!vs.empty() && !fs.empty())
                         {
-                            if (!m_shader->compileFromSource(vs, fs))
+                            if (!m_shader->compileFromSource(withUniformBlocks(vs), withUniformBlocks(fs)))
                             {
                                 std::cerr << "[Shader] reload failed" << std::endl;
                             }
@@ -1151,35 +2368,216 @@ namespace engine
                     ImGui::Text("VSync: %s", m_vsync ? "ON" : "OFF");
                     ImGui::Separator();
                     ImGui::Text("ECS Scene");
-                    static char ecsPath[260] = "ecs_scene.json";
-                    ImGui::InputText("ECS Path", ecsPath, sizeof(ecsPath));
-                    if (ImGui::Button("Save ECS")) { if (m_ecsBridge) ECSSerializer::save(m_ecsBridge->data(), ecsPath); }
+                    ImGui::InputText("ECS Path", m_ecsPath, sizeof(m_ecsPath));
+                    if (ImGui::Button("Save ECS") && m_ecsBridge && m_autosave)
+                    {
+                        // changes since the last save go to the log, then the log is folded into the base file
+                        m_autosave->attach(m_ecsBridge->data(), m_ecsPath);
+                        m_autosave->checkpoint();
+                        m_autosave->compact();
+                    }
                     ImGui::SameLine();
-                    if (ImGui::Button("Load ECS")) { if (m_ecsBridge) ECSSerializer::load(m_ecsBridge->data(), ecsPath, m_resources.get()); }
+                    if (ImGui::Button("Load ECS") && m_ecsBridge && m_autosave)
+                    {
+                        if (!m_autosave->load(m_ecsBridge->data(), m_ecsPath, m_resources.get()))
+                            std::cerr << "[App] cannot load ECS scene " << m_ecsPath << std::endl;
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Export JSON")) { if (m_ecsBridge) ECSSerializer::saveJson(m_ecsBridge->data(), std::string(m_ecsPath) + ".json"); }
+                    if (m_autosave)
+                    {
+                        ImGui::Checkbox("Autosave", &m_autosaveEnabled);
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(100.0f);
+                        ImGui::DragFloat("Interval (s)", &m_autosaveInterval, 1.0f, 1.0f, 600.0f);
+                        if (m_autosave->basePath().empty())
+                            ImGui::TextDisabled("Autosave starts after the first Save/Load");
+                        else
+                            ImGui::Text("Log: %.1f KB, last %d records, %d compactions%s", m_autosave->logBytes() / 1024.0,
+                                m_autosave->lastRecords(), m_autosave->compactions(), m_autosave->busy() ? " (writing)" : "");
+                    }
                 }
                 ImGui::End();
             }, &m_panelTools);
         }
 
+        if (m_bench.enabled)
+            buildBenchmarkScene();
+
+        return true;
+    }
+
+    bool Application::loadSkinnedModel(const char* path)
+    {
+        ImportedSkinned isk;
+        if (!AssimpLoader::loadSkinned(m_resources.get(), path, isk, true))
+            return false;
+        m_skinMesh.reset(isk.mesh);
+        m_skinSkeleton.reset(isk.skeleton);
+        m_skinDiffuse = isk.diffuse;
+        m_skinAnimations = isk.animations ? *isk.animations : std::vector<Animation>();
+        delete isk.animations;
+        if (!m_skinAnimator) m_skinAnimator = std::make_unique<Animator>();
+        if (!m_skinAnimations.empty())
+        {
+            m_skinAnimIndex = 0; m_skinPlaying = true; m_skinLoop = true;
+            m_skinAnimator->play(&m_skinAnimations[0], m_skinLoop);
+        }
         return true;
     }
 
+    void Application::buildBenchmarkScene()
+    {
+        // Everything random below comes from the seed so runs are comparable
+        std::mt19937 rng(m_bench.seed);
+        srand(m_bench.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        auto& reg = m_ecsBridge->reg();
+        reg.clear();
+        m_ecsBridge->data().selected = entt::null;
+
+        // Cubes on a grid, dropped from a random height when physics is on
+        const float spacing = 1.5f;
+        int side = std::max(1, (int)std::ceil(std::sqrt((float)m_bench.cubes)));
+        float half = (float)(side - 1) * spacing * 0.5f;
+        entt::entity chainParent = entt::null;
+        for (int i = 0; i < m_bench.cubes; ++i)
+        {
+            char name[32]; snprintf(name, sizeof(name), "Cube %d", i);
+            auto e = m_ecsBridge->data().createEntity(name);
+            auto& tr = reg.get<TransformC>(e);
+            tr.position = { (float)(i % side) * spacing - half, 0.5f + unit(rng) * 4.0f, (float)(i / side) * spacing - half };
+            tr.setEuler({ unit(rng) * 6.2831853f, unit(rng) * 6.2831853f, unit(rng) * 6.2831853f });
+            tr.scale = glm::vec3(0.5f + unit(rng) * 0.5f);
+            reg.emplace<MeshRendererC>(e, MeshRendererC{ m_cube.get(), nullptr, m_texture.get(), false });
+            reg.emplace<BoundsC>(e, BoundsC{ 0.866f });
+            // chains: every cube after the head hangs off the previous one, stacked in local space
+            if (m_bench.chainLength > 1 && i % m_bench.chainLength != 0)
+            {
+                tr.position = { 0.0f, 1.5f, 0.0f };
+                tr.scale = glm::vec3(1.0f);
+                setParent(reg, e, chainParent);
+                chainParent = e;
+                continue;
+            }
+            chainParent = e;
+            if (m_bench.physics)
+            {
+                reg.emplace<RigidBodyC>(e);
+                reg.emplace<BoxColliderC>(e, BoxColliderC{ 0.5f * tr.scale.x, 0.5f * tr.scale.y, 0.5f * tr.scale.z });
+            }
+        }
+
+        auto sun = m_ecsBridge->data().createEntity("Sun");
+        reg.emplace<DirectionalLightC>(sun);
+
+        for (int i = 0; i < m_bench.pointLights; ++i)
+        {
+            char name[32]; snprintf(name, sizeof(name), "PointLight %d", i);
+            auto e = m_ecsBridge->data().createEntity(name);
+            float a = 6.2831853f * (float)i / (float)m_bench.pointLights;
+            reg.get<TransformC>(e).position = { cosf(a) * half * 0.5f, 3.0f + unit(rng) * 2.0f, sinf(a) * half * 0.5f };
+            auto& pl = reg.emplace<PointLightC>(e);
+            pl.color = { 0.5f + unit(rng) * 0.5f, 0.5f + unit(rng) * 0.5f, 0.5f + unit(rng) * 0.5f };
+            pl.range = std::max(10.0f, half);
+        }
+
+        for (int i = 0; i < m_bench.emitters; ++i)
+        {
+            char name[32]; snprintf(name, sizeof(name), "Emitter %d", i);
+            auto e = m_ecsBridge->data().createEntity(name);
+            reg.get<TransformC>(e).position = { (unit(rng) * 2.0f - 1.0f) * half, 0.5f, (unit(rng) * 2.0f - 1.0f) * half };
+            reg.emplace<ParticleEmitterC>(e, ParticleEmitterC{ true, 50.0f + unit(rng) * 100.0f });
+        }
+
+        if (m_bench.terrain && m_terrain)
+        {
+            // Procedural heightmap: a few seeded sine octaves
+            const int hs = 257;
+            float phase[4]; for (float& p : phase) p = unit(rng) * 6.2831853f;
+            std::vector<uint8_t> px((size_t)hs * hs * 4);
+            for (int y = 0; y < hs; ++y)
+                for (int x = 0; x < hs; ++x)
+                {
+                    float u = (float)x / (float)(hs - 1), v = (float)y / (float)(hs - 1);
+                    float h = 0.5f
+                        + 0.25f * sinf(u * 6.2831853f * 2.0f + phase[0]) * cosf(v * 6.2831853f * 2.0f + phase[1])
+                        + 0.125f * sinf(u * 6.2831853f * 7.0f + phase[2]) * sinf(v * 6.2831853f * 5.0f + phase[3]);
+                    uint8_t b = (uint8_t)std::min(255.0f, std::max(0.0f, h * 255.0f));
+                    size_t o = ((size_t)y * hs + x) * 4;
+                    px[o + 0] = b; px[o + 1] = b; px[o + 2] = b; px[o + 3] = 255;
+                }
+            m_benchHeightmap = std::make_unique<Texture2D>();
+            if (m_benchHeightmap->createRGBA8(hs, hs, px))
+                m_terrain->setHeightmap(m_benchHeightmap.get());
+        }
+
+        if (!m_bench.skinnedPath.empty() && !loadSkinnedModel(m_bench.skinnedPath.c_str()))
+            std::cerr << "[Bench] skinned model load failed: " << m_bench.skinnedPath << std::endl;
+
+        if (m_physics) rebuildPhysicsFromECS();
+
+        // Fixed camera looking over the grid
+        float dist = half + 8.0f;
+        m_camera->setPerspective(45.0f * 3.14159265f / 180.0f, (float)m_bench.width / (float)m_bench.height, 0.1f, std::max(100.0f, dist * 4.0f));
+        m_camera->setView({ 0.0f, dist * 0.8f, dist }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+        m_vsync = false;
+        std::cout << "[Bench] scene: " << m_bench.cubes << " cubes, " << m_bench.pointLights << " point lights, "
+                  << m_bench.emitters << " emitters" << std::endl;
+    }
+
+    bool Application::writeBenchmarkReport()
+    {
+        if (!m_benchRecorder) return true;
+        bool ok = m_benchRecorder->writeJson(m_bench.reportPath);
+        if (!m_bench.csvPath.empty()) ok = m_benchRecorder->writeCsv(m_bench.csvPath) && ok;
+        std::cout << "[Bench] " << m_benchRecorder->measuredFrames() << " frames measured, report: " << m_bench.reportPath << std::endl;
+        return ok;
+    }
+
     int Application::run()
     {
         if (!initialize())
             return -1;
 
         std::cout << "[App] Entering main loop" << std::endl;
-        while (m_window->isOpen())
+        BenchmarkRecorder* bench = m_benchRecorder.get();
+        const int benchTotalFrames = m_bench.warmupFrames + m_bench.frames;
+        int frameIndex = 0;
+        while (m_window->isOpen() && (!bench || frameIndex < benchTotalFrames))
         {
+            auto frameStart = std::chrono::steady_clock::now();
+            Profiler::instance().beginFrame();
+            m_frameStats = renderStats();
+            renderStats() = RenderStats();
+            if (m_gpuTimer) m_gpuTimer->beginFrame();
+            if (bench) bench->beginFrame(frameIndex);
+            // The simulation job kicked last frame writes the registry: finish it before input/UI
+            waitForSimulation();
+            // per-system times of the run that just finished (the previous frame's in pipelined mode)
+            if (bench && m_systems)
+                for (const auto& s : m_systems->systems())
+                    if (s.enabled) bench->record((std::string("system/") + s.name).c_str(), s.ms);
+            if (m_autosave && m_autosaveEnabled) m_autosave->update(m_autosaveInterval);
+            ProfileScope inputZone("input");
             m_input->beginFrame();
             m_window->pollEvents();
             // Shortcuts
-            if ((m_input->isKeyPressed(GLFW_KEY_LEFT_CONTROL) || m_input->isKeyPressed(GLFW_KEY_RIGHT_CONTROL)) && m_input->isKeyPressed(GLFW_KEY_S))
+            // Ctrl+S once per press: ECS changes go to the delta log, the legacy scene is written from a copy
+            // (taken here on the main thread, in proportion to its few editor entities)
+            bool saveShortcut = (m_input->isKeyPressed(GLFW_KEY_LEFT_CONTROL) || m_input->isKeyPressed(GLFW_KEY_RIGHT_CONTROL)) && m_input->isKeyPressed(GLFW_KEY_S);
+            if (saveShortcut && !m_saveShortcutHeld)
             {
-                SceneSerializer::save(*m_scene, "scene.json");
+                if (m_autosave)
+                {
+                    if (m_ecsBridge) m_autosave->attach(m_ecsBridge->data(), m_ecsPath);
+                    m_autosave->checkpoint();
+                    m_autosave->enqueue([scene = *m_scene]() { SceneSerializer::save(scene, "scene.json"); });
+                }
+                else SceneSerializer::save(*m_scene, "scene.json");
                 // optionally save physics-specific data is already included
             }
+            m_saveShortcutHeld = saveShortcut;
             if ((m_input->isKeyPressed(GLFW_KEY_LEFT_CONTROL) || m_input->isKeyPressed(GLFW_KEY_RIGHT_CONTROL)) && m_input->isKeyPressed(GLFW_KEY_O))
             {
                 SceneSerializer::load(*m_scene, "scene.json");
@@ -1208,6 +2606,9 @@ namespace engine
                 }
             }
 
+            inputZone.stop();
+
+            ProfileScope uiZone("ui_build");
             m_ui->beginFrame();
             // Gizmo external lib removed; using simple keyboard nudge
 
@@ -1247,18 +2648,30 @@ namespace engine
                 {
                     if (ImGui::Begin("Hierarchy (ECS)", &g_panelHierarchyECS))
                     {
+                        // roots in view order, children indented under their parent
                         auto view = reg.view<TagC>();
-                        for (auto e : view)
+                        std::vector<std::pair<entt::entity, int>> stack;
+                        for (auto root : view)
                         {
-                            const auto& tag = view.get<TagC>(e);
-                            const char* name = tag.name.c_str();
-                            bool hasMesh = reg.any_of<MeshRendererC>(e);
-                            bool hasLight = reg.any_of<DirectionalLightC, PointLightC, SpotLightC>(e);
-                            bool hasPart = reg.any_of<ParticleEmitterC>(e);
-                            bool hasPhys = reg.any_of<RigidBodyC, BoxColliderC>(e);
-                            std::string label = std::string(hasMesh?"[M]": hasLight?"[L]": hasPart?"[P]":"[ ]") + " " + name;
-                            bool sel = (ecsSelected==e);
-                            if (ImGui::Selectable(label.c_str(), sel)) ecsSelected = e;
+                            if (parentOf(reg, root) != entt::null) continue;
+                            stack.push_back({ root, 0 });
+                            while (!stack.empty())
+                            {
+                                auto [e, depth] = stack.back();
+                                stack.pop_back();
+                                const auto* tag = reg.try_get<TagC>(e);
+                                const char* name = tag ? tag->name.c_str() : "(unnamed)";
+                                bool hasMesh = resolveComponent<MeshRendererC>(reg, e) != nullptr;
+                                bool hasLight = reg.any_of<DirectionalLightC, PointLightC, SpotLightC>(e);
+                                bool hasPart = reg.any_of<ParticleEmitterC>(e);
+                                std::string label = std::string((size_t)depth * 2, ' ') + (hasMesh?"[M]": hasLight?"[L]": hasPart?"[P]":"[ ]") + " " + name
+                                    + "##" + std::to_string((uint32_t)e);
+                                bool sel = (ecsSelected==e);
+                                if (ImGui::Selectable(label.c_str(), sel)) ecsSelected = e;
+                                if (const auto* h = reg.try_get<HierarchyC>(e))
+                                    for (entt::entity c = h->firstChild; c != entt::null; c = reg.get<HierarchyC>(c).nextSibling)
+                                        stack.push_back({ c, depth + 1 });
+                            }
                         }
                     }
                     ImGui::End();
@@ -1284,14 +2697,75 @@ namespace engine
                         {
                             static char buf[128];
                             strncpy_s(buf, tag->name.c_str(), sizeof(buf)-1);
-                            if (ImGui::InputText("Name", buf, sizeof(buf))) tag->name = buf;
+                            if (ImGui::InputText("Name", buf, sizeof(buf))) { tag->name = buf; reg.patch<TagC>(ecsSelected); }
                         }
                         // Transform
                         if (auto tr = reg.try_get<TransformC>(ecsSelected))
                         {
-                            ImGui::DragFloat3("Position", &tr->position.x, 0.01f);
-                            ImGui::DragFloat3("Rotation", &tr->rotationEuler.x, 0.1f);
-                            ImGui::DragFloat3("Scale", &tr->scale.x, 0.01f);
+                            bool changed = ImGui::DragFloat3("Position", &tr->position.x, 0.01f);
+                            glm::vec3 euler = tr->euler();
+                            if (ImGui::DragFloat3("Rotation", &euler.x, 0.1f)) { tr->setEuler(euler); changed = true; }
+                            changed |= ImGui::DragFloat3("Scale", &tr->scale.x, 0.01f);
+                            if (changed) reg.patch<TransformC>(ecsSelected);
+                        }
+                        // Parent
+                        {
+                            entt::entity parent = parentOf(reg, ecsSelected);
+                            const TagC* ptag = parent != entt::null ? reg.try_get<TagC>(parent) : nullptr;
+                            if (ImGui::BeginCombo("Parent", ptag ? ptag->name.c_str() : "(none)"))
+                            {
+                                if (ImGui::Selectable("(none)", parent == entt::null)) setParent(reg, ecsSelected, entt::null);
+                                auto tags = reg.view<TagC>();
+                                for (auto e : tags)
+                                {
+                                    if (e == ecsSelected) continue;
+                                    std::string label = tags.get<TagC>(e).name + "##" + std::to_string((uint32_t)e);
+                                    if (ImGui::Selectable(label.c_str(), e == parent) && !setParent(reg, ecsSelected, e))
+                                        std::cerr << "[ECS] setParent rejected (cycle)" << std::endl;
+                                }
+                                ImGui::EndCombo();
+                            }
+                        }
+                        // Prefab: shared components stay read-only here until overridden
+                        if (const auto* pc = reg.try_get<PrefabC>(ecsSelected))
+                        {
+                            const unsigned int prefabId = pc->id;
+                            const Prefab* prefab = findPrefab(reg, prefabId);
+                            ImGui::Text("Prefab: %s", prefab ? prefab->name.c_str() : "(missing)");
+                            if (prefab)
+                            {
+                                bool hasPrefabMesh = prefab->meshRenderer.has_value();
+                                bool hasPrefabRB = prefab->rigidBody.has_value();
+                                bool hasPrefabBC = prefab->boxCollider.has_value();
+                                if (hasPrefabMesh && !reg.all_of<MeshRendererC>(ecsSelected) && ImGui::SmallButton("Override MeshRenderer")) overrideComponent<MeshRendererC>(reg, ecsSelected);
+                                else if (hasPrefabMesh && reg.all_of<MeshRendererC>(ecsSelected) && ImGui::SmallButton("Revert MeshRenderer")) revertOverride<MeshRendererC>(reg, ecsSelected);
+                                if (hasPrefabRB && !reg.all_of<RigidBodyC>(ecsSelected) && ImGui::SmallButton("Override RigidBody")) overrideComponent<RigidBodyC>(reg, ecsSelected);
+                                else if (hasPrefabRB && reg.all_of<RigidBodyC>(ecsSelected) && ImGui::SmallButton("Revert RigidBody")) revertOverride<RigidBodyC>(reg, ecsSelected);
+                                if (hasPrefabBC && !reg.all_of<BoxColliderC>(ecsSelected) && ImGui::SmallButton("Override BoxCollider")) overrideComponent<BoxColliderC>(reg, ecsSelected);
+                                else if (hasPrefabBC && reg.all_of<BoxColliderC>(ecsSelected) && ImGui::SmallButton("Revert BoxCollider")) revertOverride<BoxColliderC>(reg, ecsSelected);
+                                ImGui::DragInt("Spawn Count", &m_prefabSpawnCount, 1.0f, 1, 100000);
+                                if (ImGui::Button("Spawn Instances"))
+                                {
+                                    // square grid next to the selected instance
+                                    const glm::vec3 origin = reg.get<TransformC>(ecsSelected).position;
+                                    const int side = (int)std::ceil(std::sqrt((float)m_prefabSpawnCount));
+                                    std::vector<TransformC> transforms(m_prefabSpawnCount);
+                                    for (int i = 0; i < m_prefabSpawnCount; ++i)
+                                        transforms[i].position = origin + glm::vec3(1.5f * (float)(1 + i % side), 0.0f, 1.5f * (float)(i / side));
+                                    instantiatePrefab(reg, prefabId, transforms.size(), transforms.data());
+                                }
+                            }
+                        }
+                        else if (reg.all_of<TagC, TransformC>(ecsSelected) && ImGui::Button("Make Prefab"))
+                        {
+                            // moves the entity's shareable components into a new prefab and links it as the first instance
+                            Prefab prefab;
+                            prefab.name = reg.get<TagC>(ecsSelected).name;
+                            if (auto* mr = reg.try_get<MeshRendererC>(ecsSelected)) prefab.meshRenderer = *mr;
+                            if (auto* rb = reg.try_get<RigidBodyC>(ecsSelected)) prefab.rigidBody = *rb;
+                            if (auto* bc = reg.try_get<BoxColliderC>(ecsSelected)) prefab.boxCollider = *bc;
+                            reg.emplace<PrefabC>(ecsSelected, PrefabC{ registerPrefab(reg, std::move(prefab)) });
+                            reg.remove<MeshRendererC, RigidBodyC, BoxColliderC>(ecsSelected);
                         }
                         // Components toggle
                         bool hasMesh = reg.any_of<MeshRendererC>(ecsSelected);
@@ -1316,11 +2790,12 @@ namespace engine
                             if (ImGui::CollapsingHeader("RigidBody", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##rb")) { reg.remove<RigidBodyC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::Checkbox("Static", &rb->isStatic);
-                                ImGui::Checkbox("Kinematic", &rb->isKinematic);
-                                ImGui::DragFloat("Mass", &rb->mass, 0.01f, 0.001f, 1000.0f);
-                                ImGui::DragFloat("Friction", &rb->friction, 0.01f, 0.0f, 1.0f);
-                                ImGui::DragFloat("Restitution", &rb->restitution, 0.01f, 0.0f, 1.0f);
+                                bool changed = ImGui::Checkbox("Static", &rb->isStatic);
+                                changed |= ImGui::Checkbox("Kinematic", &rb->isKinematic);
+                                changed |= ImGui::DragFloat("Mass", &rb->mass, 0.01f, 0.001f, 1000.0f);
+                                changed |= ImGui::DragFloat("Friction", &rb->friction, 0.01f, 0.0f, 1.0f);
+                                changed |= ImGui::DragFloat("Restitution", &rb->restitution, 0.01f, 0.0f, 1.0f);
+                                if (changed) reg.patch<RigidBodyC>(ecsSelected);
                                 if (ImGui::Button("Rebuild Physics")) rebuildPhysicsFromECS();
                             }
                         }
@@ -1329,7 +2804,7 @@ namespace engine
                             if (ImGui::CollapsingHeader("BoxCollider", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##bc")) { reg.remove<BoxColliderC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::DragFloat3("Half Extents", &bc->hx, 0.01f, 0.01f, 100.0f);
+                                if (ImGui::DragFloat3("Half Extents", &bc->hx, 0.01f, 0.01f, 100.0f)) reg.patch<BoxColliderC>(ecsSelected);
                                 if (ImGui::Button("Rebuild Physics##bc")) rebuildPhysicsFromECS();
                             }
                         }
@@ -1340,13 +2815,14 @@ namespace engine
                             {
                                 ImGui::SameLine();
                                 if (ImGui::SmallButton("Remove##mr")) { reg.remove<MeshRendererC>(ecsSelected); goto ecs_inspector_end_components; }
-                            ImGui::Checkbox("Use PBR", &mr->usePBR);
+                            if (ImGui::Checkbox("Use PBR", &mr->usePBR)) reg.patch<MeshRendererC>(ecsSelected);
                             // Material asset path
                             static char matBuf[260];
                             strncpy_s(matBuf, mr->materialPath.c_str(), sizeof(matBuf)-1);
                             if (ImGui::InputText("Material Asset", matBuf, sizeof(matBuf)))
                             {
                                 mr->materialPath = matBuf;
+                                reg.patch<MeshRendererC>(ecsSelected);
                             }
                             if (ImGui::Button("Load Material") && !mr->materialPath.empty() && m_resources)
                             {
@@ -1355,6 +2831,7 @@ namespace engine
                                     mr->material = mat;
                                     if (mat->albedoTex) mr->albedoTex = mat->albedoTex;
                                     mr->usePBR = true;
+                                    reg.patch<MeshRendererC>(ecsSelected);
                                 }
                             }
                             }
@@ -1364,9 +2841,10 @@ namespace engine
                             if (ImGui::CollapsingHeader("DirectionalLight", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##dl")) { reg.remove<DirectionalLightC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::ColorEdit3("DirLight Color", &dl->color.x);
-                                ImGui::DragFloat("Intensity", &dl->intensity, 0.01f, 0.0f, 10.0f);
-                                ImGui::DragFloat3("Direction", &dl->direction.x, 0.01f);
+                                bool changed = ImGui::ColorEdit3("DirLight Color", &dl->color.x);
+                                changed |= ImGui::DragFloat("Intensity", &dl->intensity, 0.01f, 0.0f, 10.0f);
+                                changed |= ImGui::DragFloat3("Direction", &dl->direction.x, 0.01f);
+                                if (changed) reg.patch<DirectionalLightC>(ecsSelected);
                             }
                         }
                         if (auto pl = reg.try_get<PointLightC>(ecsSelected))
@@ -1374,9 +2852,10 @@ namespace engine
                             if (ImGui::CollapsingHeader("PointLight", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##pl")) { reg.remove<PointLightC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::ColorEdit3("Point Color", &pl->color.x);
-                                ImGui::DragFloat("Intensity", &pl->intensity, 0.01f, 0.0f, 10.0f);
-                                ImGui::DragFloat("Range", &pl->range, 0.1f, 0.1f, 200.0f);
+                                bool changed = ImGui::ColorEdit3("Point Color", &pl->color.x);
+                                changed |= ImGui::DragFloat("Intensity", &pl->intensity, 0.01f, 0.0f, 10.0f);
+                                changed |= ImGui::DragFloat("Range", &pl->range, 0.1f, 0.1f, 200.0f);
+                                if (changed) reg.patch<PointLightC>(ecsSelected);
                             }
                         }
                         if (auto sl = reg.try_get<SpotLightC>(ecsSelected))
@@ -1384,13 +2863,14 @@ namespace engine
                             if (ImGui::CollapsingHeader("SpotLight", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##sl")) { reg.remove<SpotLightC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::ColorEdit3("Spot Color", &sl->color.x);
-                                ImGui::DragFloat("Intensity", &sl->intensity, 0.01f, 0.0f, 10.0f);
-                                ImGui::DragFloat3("Direction", &sl->direction.x, 0.01f);
-                                ImGui::DragFloat("Inner (deg)", &sl->innerDegrees, 0.1f, 1.0f, 89.0f);
-                                ImGui::DragFloat("Outer (deg)", &sl->outerDegrees, 0.1f, 1.0f, 89.0f);
-                                ImGui::DragFloat("Near", &sl->nearPlane, 0.01f, 0.01f, 5.0f);
-                                ImGui::DragFloat("Far", &sl->farPlane, 0.1f, 1.0f, 200.0f);
+                                bool changed = ImGui::ColorEdit3("Spot Color", &sl->color.x);
+                                changed |= ImGui::DragFloat("Intensity", &sl->intensity, 0.01f, 0.0f, 10.0f);
+                                changed |= ImGui::DragFloat3("Direction", &sl->direction.x, 0.01f);
+                                changed |= ImGui::DragFloat("Inner (deg)", &sl->innerDegrees, 0.1f, 1.0f, 89.0f);
+                                changed |= ImGui::DragFloat("Outer (deg)", &sl->outerDegrees, 0.1f, 1.0f, 89.0f);
+                                changed |= ImGui::DragFloat("Near", &sl->nearPlane, 0.01f, 0.01f, 5.0f);
+                                changed |= ImGui::DragFloat("Far", &sl->farPlane, 0.1f, 1.0f, 200.0f);
+                                if (changed) reg.patch<SpotLightC>(ecsSelected);
                             }
                         }
                         if (auto pe = reg.try_get<ParticleEmitterC>(ecsSelected))
@@ -1398,8 +2878,9 @@ namespace engine
                             if (ImGui::CollapsingHeader("ParticleEmitter", ImGuiTreeNodeFlags_DefaultOpen))
                             {
                                 ImGui::SameLine(); if (ImGui::SmallButton("Remove##pe")) { reg.remove<ParticleEmitterC>(ecsSelected); goto ecs_inspector_end_components; }
-                                ImGui::Checkbox("Emit", &pe->emit);
-                                ImGui::DragFloat("Rate", &pe->rate, 1.0f, 0.0f, 1000.0f);
+                                bool changed = ImGui::Checkbox("Emit", &pe->emit);
+                                changed |= ImGui::DragFloat("Rate", &pe->rate, 1.0f, 0.0f, 1000.0f);
+                                if (changed) reg.patch<ParticleEmitterC>(ecsSelected);
                             }
                         }
 ecs_inspector_end_components: ;
@@ -1408,19 +2889,26 @@ ecs_inspector_end_components: ;
                 }
             }
 
+            uiZone.stop();
+
             // Defer ImGui::Render() until after gizmo manipulation is submitted
             int display_w, display_h;
             glfwGetFramebufferSize(m_window->getNativeHandle(), &display_w, &display_h);
             Renderer::setWireframe(m_wireframe);
             glfwSwapInterval(m_vsync ? 1 : 0);
             // Bind HDR FBO for scene rendering
+            ProfileScope frameBeginZone("frame_begin");
             if (m_post)
                 m_post->begin(display_w, display_h, m_clearColor.x * m_clearColor.w, m_clearColor.y * m_clearColor.w, m_clearColor.z * m_clearColor.w, m_clearColor.w);
             else
                 Renderer::beginFrame(display_w, display_h, m_clearColor.x * m_clearColor.w, m_clearColor.y * m_clearColor.w, m_clearColor.z * m_clearColor.w, m_clearColor.w);
 
+            frameBeginZone.stop();
+
             // Camera controls
+            ProfileScope cameraZone("camera");
             float dt = m_time->tick();
+            if (bench) dt = m_bench.fixedDt;
             double mdx, mdy; m_input->getCursorDelta(mdx, mdy);
             double sdx, sdy; m_input->getScrollDelta(sdx, sdy);
             const float mouseSensitivity = m_mouseSensitivity;
@@ -1465,47 +2953,97 @@ ecs_inspector_end_components: ;
                 if (move.x != 0 || move.y != 0 || move.z != 0) m_camera->moveLocal(move);
             }
 
-            // Update cube rotation
-            static float angle = 0.0f;
-            angle += dt;
-            for (size_t i = 0; i < m_scene->entities().size(); ++i)
-            {
-                m_scene->entities()[i].transform.rotationEuler.y = angle * (1.0f + 0.2f * (float)i);
-            }
-
-            // ECS physics update + picking
-            if (m_physics) { syncECSFromPhysics(dt); handlePickingECS(); }
+            cameraZone.stop();
 
-            // Lua update
-            if (m_lua) m_lua->onUpdate(dt);
-            // Pull lighting from ECS (first directional + first point)
-            if (m_renderFromECS && m_ecsBridge)
+            // Simple keyboard gizmo (ECS)
+            if (m_ecsBridge)
             {
+                PROFILE_SCOPE("gizmo");
+                static entt::entity ecsSel = entt::null;
+                // use last selection from hierarchy panel scope
+                // move selected entity with arrow keys
                 auto& reg = m_ecsBridge->reg();
-                auto vdir = reg.view<DirectionalLightC>();
-                for (auto e : vdir)
+                if (ecsSel == entt::null)
+                {
+                    // pick first entity as default
+                    auto v = reg.view<TagC>();
+                    for (auto e : v) { ecsSel = e; break; }
+                }
+                if (ecsSel != entt::null)
                 {
-                    const auto& dl = vdir.get<DirectionalLightC>(e);
-                    glm::vec3 dir = glm::normalize(dl.direction);
-                    if (glm::length(dir) < 1e-3f) dir = glm::vec3(-0.5f,-1.0f,-0.3f);
-                    glm::vec3 pos = -dir * 10.0f;
-                    m_lightPos[0]=pos.x; m_lightPos[1]=pos.y; m_lightPos[2]=pos.z;
-                    m_lightColor[0]=dl.color.x * dl.intensity; m_lightColor[1]=dl.color.y * dl.intensity; m_lightColor[2]=dl.color.z * dl.intensity;
-                    break;
+                    if (auto tr = reg.try_get<TransformC>(ecsSel))
+                    {
+                        if (m_input->isKeyPressed(GLFW_KEY_T)) m_gizmoOp = 0;
+                        if (m_input->isKeyPressed(GLFW_KEY_R)) m_gizmoOp = 1;
+                        if (m_input->isKeyPressed(GLFW_KEY_S)) m_gizmoOp = 2;
+                        float delta = (float)m_gizmoSensitivity;
+                        glm::vec3 gizmoAxis(0.0f); gizmoAxis[m_gizmoAxis] = 1.0f;
+                        if (m_input->isKeyPressed(GLFW_KEY_LEFT))
+                        {
+                            if (m_gizmoOp == 0) (&tr->position.x)[m_gizmoAxis] -= delta;
+                            else if (m_gizmoOp == 1) tr->rotation = tr->rotation * glm::angleAxis(-delta, gizmoAxis);
+                            else (&tr->scale.x)[m_gizmoAxis] *= (1.0f - delta);
+                        }
+                        if (m_input->isKeyPressed(GLFW_KEY_RIGHT))
+                        {
+                            if (m_gizmoOp == 0) (&tr->position.x)[m_gizmoAxis] += delta;
+                            else if (m_gizmoOp == 1) tr->rotation = tr->rotation * glm::angleAxis(delta, gizmoAxis);
+                            else (&tr->scale.x)[m_gizmoAxis] *= (1.0f + delta);
+                        }
+                        if (m_input->isKeyPressed(GLFW_KEY_LEFT) || m_input->isKeyPressed(GLFW_KEY_RIGHT))
+                            reg.patch<TransformC>(ecsSel);
+                    }
                 }
-                auto vpl = reg.view<PointLightC, TransformC>();
-                for (auto e : vpl)
+            }
+
+            // Frustum culling visibility compute
+            if (m_frustumCulling)
+            {
+                PROFILE_SCOPE("frustum");
+                glm::mat4 vp = m_camera->projection() * m_camera->view();
+                computeCameraFrustum(&vp[0][0]);
+                m_frustumVisible.assign(m_scene->getEntities().size(), 1);
+                for (size_t i=0;i<m_scene->getEntities().size();++i)
                 {
-                    const auto& pl = vpl.get<PointLightC>(e);
-                    const auto& tr = vpl.get<TransformC>(e);
-                    m_pointShadowEnabled = true;
-                    m_pointLightPos[0]=tr.position.x; m_pointLightPos[1]=tr.position.y; m_pointLightPos[2]=tr.position.z;
-                    m_pointLightColor[0]=pl.color.x*pl.intensity; m_pointLightColor[1]=pl.color.y*pl.intensity; m_pointLightColor[2]=pl.color.z*pl.intensity;
-                    m_pointShadowFar = std::max(1.0f, pl.range);
-                    break;
+                    const auto& e = m_scene->getEntities()[i];
+                    float center[3] = { e.transform.position.x, e.transform.position.y, e.transform.position.z };
+                    float radius = 1.0f * std::max({e.transform.scale.x, e.transform.scale.y, e.transform.scale.z});
+                    if (!sphereInFrustum(center, radius)) m_frustumVisible[i] = 0;
                 }
             }
 
+            // Simulation + render snapshot. Pipelined: this frame renders the snapshot the
+            // previous frame's job produced while the job for the next frame runs.
+            const bool pipelined = m_pipelined && m_jobs && m_renderFromECS && m_ecsBridge;
+            syncEmitterSystems();
+            { PROFILE_SCOPE("picking"); handlePickingECS(); }
+            if (pipelined)
+            {
+                if (m_backSnapshotReady) m_frontSnapshot ^= 1;
+                else buildRenderSnapshot(*m_snapshots[m_frontSnapshot]);
+                RenderSnapshot* back = m_snapshots[m_frontSnapshot ^ 1].get();
+                m_jobs->run([this, dt, back]() {
+                    PROFILE_SCOPE("simulate");
+                    simulateFrame(dt);
+                    buildRenderSnapshot(*back);
+                }, m_simCounter.get());
+                m_backSnapshotReady = true;
+            }
+            else
+            {
+                m_backSnapshotReady = false;
+                simulateFrame(dt);
+                buildRenderSnapshot(*m_snapshots[m_frontSnapshot]);
+            }
+            const RenderSnapshot& snap = *m_snapshots[m_frontSnapshot];
+            if (m_renderFromECS && m_ecsBridge)
+            {
+                applySnapshotLights(snap);
+                glm::mat4 camVP = m_camera->projection() * m_camera->view();
+                cullSnapshot(snap, &camVP[0][0], m_visibleItems);
+            }
+            prepareLocalLights(snap);
+
             // Shadow pass (directional light with orthographic proj)
             glm::mat4 lightView = glm::lookAt(
                 glm::vec3(m_lightPos[0], m_lightPos[1], m_lightPos[2]),
@@ -1513,32 +3051,131 @@ ecs_inspector_end_components: ;
                 glm::vec3(0,1,0));
             glm::mat4 lightProj = glm::ortho(-m_shadowOrthoSize, m_shadowOrthoSize, -m_shadowOrthoSize, m_shadowOrthoSize, m_shadowNear, m_shadowFar);
             glm::mat4 lightVP = lightProj * lightView;
-            if (m_shadowsEnabled && !m_wireframe)
+            // cascades split the light's depth range. The near cascade is redrawn every frame, the
+            // far ones round-robin every m_cascadeUpdateInterval frames (at once when they moved);
+            // a skipped cascade keeps the matrix it was rendered with.
+            bool cascadeDue[4] = {};
+            {
+                if (!m_shadowsEnabled || m_wireframe || !m_csmEnabled)
+                    for (bool& rendered : m_cascadeRendered) rendered = false;
+                const bool rebuild = !m_csm || m_csm->size() != m_csmSize || m_csm->cascades() != m_cascadeCount;
+                float prevEnd = m_shadowNear;
+                for (int c = 0; c < m_cascadeCount; ++c)
+                {
+                    glm::mat4 proj = glm::ortho(-m_shadowOrthoSize, m_shadowOrthoSize, -m_shadowOrthoSize, m_shadowOrthoSize, prevEnd, m_cascadeEnds[c]);
+                    glm::mat4 vp = proj * lightView;
+                    const bool moved = memcmp(m_cascadeMatrices[c], &vp[0][0], sizeof(float)*16) != 0;
+                    const int interval = std::max(1, m_cascadeUpdateInterval);
+                    cascadeDue[c] = c == 0 || rebuild || moved || !m_cascadeRendered[c] || (m_shadowFrame + (uint32_t)c) % (uint32_t)interval == 0;
+                    if (cascadeDue[c]) memcpy(m_cascadeMatrices[c], &vp[0][0], sizeof(float)*16);
+                    prevEnd = m_cascadeEnds[c];
+                }
+                ++m_shadowFrame;
+            }
+            // Point light cube faces
+            glm::vec3 lp(m_pointLightPos[0], m_pointLightPos[1], m_pointLightPos[2]);
+            glm::mat4 pointProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, m_pointShadowFar);
+            glm::mat4 pointViews[6];
+            {
+                const glm::vec3 dirs[6] = { {1,0,0},{-1,0,0},{0,1,0},{0,-1,0},{0,0,1},{0,0,-1} };
+                const glm::vec3 ups[6]  = { {0,-1,0},{0,-1,0},{0,0,1},{0,0,-1},{0,-1,0},{0,-1,0} };
+                for (int f = 0; f < 6; ++f) pointViews[f] = glm::lookAt(lp, lp + dirs[f], ups[f]);
+            }
+            // Spot light
+            glm::vec3 spotPos(m_spotPos[0], m_spotPos[1], m_spotPos[2]);
+            glm::vec3 spotDir = glm::normalize(glm::vec3(m_spotDir[0], m_spotDir[1], m_spotDir[2]));
+            glm::mat4 spotView = glm::lookAt(spotPos, spotPos + spotDir, glm::vec3(0,1,0));
+            glm::mat4 spotProj = glm::perspective(glm::radians(m_spotOuter * 2.0f), 1.0f, m_spotNear, m_spotFar);
+            glm::mat4 spotVP = spotProj * spotView;
+
+            // Caster lists of every shadow view, culled together in one pass over the snapshot.
+            // Directional views are extended toward the light (depth clamp keeps those casters),
+            // the point faces are narrowed by the light range and the spot view by its cone.
+            const bool shadowDir = m_shadowsEnabled && !m_wireframe;
+            // with the atlas, ECS point and spot lights cast through their tiles instead
+            const bool atlasLights = m_renderFromECS && m_ecsBridge && m_shadowAtlasEnabled && m_shadowAtlas;
+            const bool shadowPoint = m_pointShadowEnabled && !m_wireframe && !atlasLights;
+            const bool shadowSpot = m_spotEnabled && !m_wireframe && !atlasLights;
+            const bool layered = m_layeredShadows && m_layeredDepthShader && m_layeredPointShader;
+            int dirViews = -1, pointFaceViews = -1, spotViews = -1; // first slot in m_shadowCasters
+            int atlasViews = -1;
+            int cascadeViews[4] = { -1, -1, -1, -1 };
+            m_shadowCacheUpdates = 0;
+            if (m_renderFromECS && m_ecsBridge)
+            {
+                m_shadowViews.clear();
+                if (shadowDir)
+                {
+                    dirViews = 0;
+                    if (!m_csmEnabled) m_shadowViews.push_back(CullView::fromViewProj(lightVP, true));
+                    else
+                        for (int c = 0; c < m_cascadeCount; ++c)
+                        {
+                            if (!cascadeDue[c]) continue;
+                            cascadeViews[c] = (int)m_shadowViews.size();
+                            m_shadowViews.push_back(CullView::fromViewProj(glm::make_mat4(m_cascadeMatrices[c]), true));
+                        }
+                }
+                if (shadowPoint)
+                {
+                    pointFaceViews = (int)m_shadowViews.size();
+                    for (int f = 0; f < 6; ++f)
+                    {
+                        CullView v = CullView::fromViewProj(pointProj * pointViews[f], false);
+                        if (snap.lights.hasPoint) v.setRange(lp, std::max(1.0f, snap.lights.pointRange));
+                        m_shadowViews.push_back(v);
+                    }
+                }
+                if (shadowSpot)
+                {
+                    spotViews = (int)m_shadowViews.size();
+                    CullView v = CullView::fromViewProj(spotVP, false);
+                    v.setCone(spotPos, spotDir, glm::radians(m_spotOuter), m_spotFar);
+                    m_shadowViews.push_back(v);
+                }
+                if (m_atlasTileCount > 0)
+                {
+                    atlasViews = (int)m_shadowViews.size();
+                    for (int t = 0; t < m_atlasTileCount; ++t)
+                    {
+                        const LocalLightEntry& l = m_localLightEntries[m_atlasTileLight[t]];
+                        CullView v = CullView::fromViewProj(m_localLights->tiles[t].viewProj, false);
+                        if (l.isSpot) v.setCone(l.position, l.direction, std::acos(l.cosOuter), l.range);
+                        else v.setRange(l.position, l.range);
+                        m_shadowViews.push_back(v);
+                    }
+                }
+                m_shadowCasters.resize(m_shadowViews.size());
+                if (m_frustumCulling)
+                {
+                    m_culler->cullViews(snap.bounds, m_shadowViews.data(), (int)m_shadowViews.size(), m_shadowCasters.data(), m_jobs.get());
+                }
+                else
+                {
+                    for (auto& casters : m_shadowCasters)
+                    {
+                        casters.resize(snap.items.size());
+                        for (size_t i = 0; i < casters.size(); ++i) casters[i] = (uint32_t)i;
+                    }
+                }
+            }
+
+            if (shadowDir)
             {
+                PROFILE_GPU_SCOPE(m_csmEnabled ? "shadow_csm" : "shadow_dir");
+                // casters in front of the near plane are flattened onto it instead of clipped
+                glEnable(GL_DEPTH_CLAMP);
                 if (!m_csmEnabled)
                 {
-                    m_shadowMap->begin();
                     if (m_renderFromECS && m_ecsBridge)
                     {
-                        auto& reg = m_ecsBridge->reg();
-                        auto v = reg.view<TransformC, MeshRendererC>();
-                        for (auto ent : v)
-                        {
-                            const auto& tr = v.get<TransformC>(ent);
-                            const auto& mr = v.get<MeshRendererC>(ent);
-                            if (!mr.mesh) continue;
-                            glm::mat4 T = glm::translate(glm::mat4(1.0f), tr.position);
-                            glm::mat4 R = glm::yawPitchRoll(tr.rotationEuler.y, tr.rotationEuler.x, tr.rotationEuler.z);
-                            glm::mat4 S = glm::scale(glm::mat4(1.0f), tr.scale);
-                            glm::mat4 model = T * R * S;
-                            m_depthShader->bind();
-                            m_depthShader->setMat4("u_LightVP", &lightVP[0][0]);
-                            m_depthShader->setMat4("u_Model", &model[0][0]);
-                            mr.mesh->draw();
-                        }
+                        drawShadowView(snap, m_shadowCasters[dirViews], kCacheDir, m_shadowMap->width(), &lightVP[0][0],
+                            [&]() { m_shadowMap->begin(); }, *m_depthShader, *m_depthInstancedShader,
+                            [&](Shader& sh) { sh.setMat4("u_LightVP", &lightVP[0][0]); });
                     }
                     else
                     {
+                        m_shadowMap->begin();
                         for (const auto& e : m_scene->getEntities())
                         {
                             glm::mat4 model = e.transform.modelMatrix();
@@ -1560,35 +3197,44 @@ ecs_inspector_end_components: ;
                         else m_csm->destroy();
                         m_csm->create(m_csmSize, cascades);
                     }
-                    float prevEnd = m_shadowNear;
-                    for (int c = 0; c < cascades; ++c)
+                    if (m_renderFromECS && m_ecsBridge && layered)
+                    {
+                        // each due cascade cleared (or filled from its cache) on its own, then the
+                        // remaining casters of all of them drawn once into every due layer
+                        m_layerCasters.clear();
+                        m_casterSeen.assign(snap.items.size(), 0);
+                        int mask = 0;
+                        for (int c = 0; c < cascades; ++c)
+                        {
+                            if (!cascadeDue[c]) continue;
+                            glm::mat4 vp = glm::make_mat4(m_cascadeMatrices[c]);
+                            beginShadowView(snap, m_shadowCasters[cascadeViews[c]], kCacheCascade0 + c, m_csm->size(), m_cascadeMatrices[c],
+                                [&]() { m_csm->beginCascade(c); }, *m_depthShader, *m_depthInstancedShader,
+                                [&](Shader& sh) { sh.setMat4("u_LightVP", &vp[0][0]); }, m_dynamicCasters);
+                            appendUnique(m_dynamicCasters, m_layerCasters, m_casterSeen);
+                            mask |= 1 << c;
+                            m_cascadeRendered[c] = true;
+                        }
+                        m_csm->beginLayered();
+                        drawDepthCasters(snap, m_layerCasters, *m_layeredDepthShader, *m_layeredDepthInstancedShader, [&](Shader& sh)
+                        {
+                            for (int c = 0; c < cascades; ++c) sh.setMat4(sh.uniform("u_LayerVP", c), m_cascadeMatrices[c]);
+                            sh.setInt("u_LayerMask", mask);
+                        });
+                    }
+                    else for (int c = 0; c < cascades; ++c)
                     {
-                        float endZ = m_cascadeEnds[c];
-                        glm::mat4 proj = glm::ortho(-m_shadowOrthoSize, m_shadowOrthoSize, -m_shadowOrthoSize, m_shadowOrthoSize, prevEnd, endZ);
-                        glm::mat4 vp = proj * lightView;
-                        memcpy(m_cascadeMatrices[c], &vp[0][0], sizeof(float)*16);
-                        m_csm->beginCascade(c);
+                        if (!cascadeDue[c]) continue;
+                        glm::mat4 vp = glm::make_mat4(m_cascadeMatrices[c]);
                         if (m_renderFromECS && m_ecsBridge)
                         {
-                            auto& reg = m_ecsBridge->reg();
-                            auto v = reg.view<TransformC, MeshRendererC>();
-                            for (auto ent : v)
-                            {
-                                const auto& tr = v.get<TransformC>(ent);
-                                const auto& mr = v.get<MeshRendererC>(ent);
-                                if (!mr.mesh) continue;
-                                glm::mat4 T = glm::translate(glm::mat4(1.0f), tr.position);
-                                glm::mat4 R = glm::yawPitchRoll(tr.rotationEuler.y, tr.rotationEuler.x, tr.rotationEuler.z);
-                                glm::mat4 S = glm::scale(glm::mat4(1.0f), tr.scale);
-                                glm::mat4 model = T * R * S;
-                                m_depthShader->bind();
-                                m_depthShader->setMat4("u_LightVP", &vp[0][0]);
-                                m_depthShader->setMat4("u_Model", &model[0][0]);
-                                mr.mesh->draw();
-                            }
+                            drawShadowView(snap, m_shadowCasters[cascadeViews[c]], kCacheCascade0 + c, m_csm->size(), m_cascadeMatrices[c],
+                                [&]() { m_csm->beginCascade(c); }, *m_depthShader, *m_depthInstancedShader,
+                                [&](Shader& sh) { sh.setMat4("u_LightVP", &vp[0][0]); });
                         }
                         else
                         {
+                            m_csm->beginCascade(c);
                             for (const auto& e : m_scene->getEntities())
                             {
                                 glm::mat4 model = e.transform.modelMatrix();
@@ -1599,51 +3245,74 @@ ecs_inspector_end_components: ;
                             }
                         }
                         m_depthShader->unbind();
-                        prevEnd = endZ;
+                        m_cascadeRendered[c] = true;
                     }
                     m_csm->end(display_w, display_h);
                 }
+                glDisable(GL_DEPTH_CLAMP);
             }
 
-            // Point shadow pass: render 6 faces storing distance in cubemap
-            if (m_pointShadowEnabled && !m_wireframe)
+            // Point shadow pass: the 6 cube faces store distance / far as depth
+            if (shadowPoint)
             {
+                PROFILE_GPU_SCOPE("shadow_point");
                 if (m_pointShadowMap->size() != m_pointShadowSize)
                 {
                     m_pointShadowMap->destroy();
                     m_pointShadowMap->create(m_pointShadowSize);
                 }
-                glm::vec3 lp(m_pointLightPos[0], m_pointLightPos[1], m_pointLightPos[2]);
-                glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, m_pointShadowFar);
-                glm::vec3 dirs[6] = { {1,0,0},{-1,0,0},{0,1,0},{0,-1,0},{0,0,1},{0,0,-1} };
-                glm::vec3 ups[6]  = { {0,-1,0},{0,-1,0},{0,0,1},{0,0,-1},{0,-1,0},{0,-1,0} };
-                for (int f = 0; f < 6; ++f)
+                const glm::mat4& proj = pointProj;
+                static const char* faceNames[6] = { "shadow_point_face_px", "shadow_point_face_nx", "shadow_point_face_py",
+                                                    "shadow_point_face_ny", "shadow_point_face_pz", "shadow_point_face_nz" };
+                if (m_renderFromECS && m_ecsBridge && layered)
+                {
+                    // faces cleared (or filled from their caches) one by one, then the remaining
+                    // casters drawn once, the geometry stage routing triangles to their faces
+                    glm::mat4 faceVP[6];
+                    m_layerCasters.clear();
+                    m_casterSeen.assign(snap.items.size(), 0);
+                    for (int f = 0; f < 6; ++f)
+                    {
+                        const glm::mat4& view = pointViews[f];
+                        faceVP[f] = proj * view;
+                        beginShadowView(snap, m_shadowCasters[pointFaceViews + f], kCachePoint0 + f, m_pointShadowMap->size(), &faceVP[f][0][0],
+                            [&]() { m_pointShadowMap->beginFace(f); }, *m_pointDepthShader, *m_pointDepthInstancedShader, [&](Shader& sh)
+                        {
+                            sh.setMat4("u_Proj", &proj[0][0]);
+                            sh.setMat4("u_View", &view[0][0]);
+                            sh.setVec3("u_LightPos", lp.x, lp.y, lp.z);
+                            sh.setFloat("u_FarPlane", m_pointShadowFar);
+                        }, m_dynamicCasters);
+                        appendUnique(m_dynamicCasters, m_layerCasters, m_casterSeen);
+                    }
+                    m_pointShadowMap->beginLayered();
+                    drawDepthCasters(snap, m_layerCasters, *m_layeredPointShader, *m_layeredPointInstancedShader, [&](Shader& sh)
+                    {
+                        for (int f = 0; f < 6; ++f) sh.setMat4(sh.uniform("u_LayerVP", f), &faceVP[f][0][0]);
+                        sh.setInt("u_LayerMask", 0x3f);
+                        sh.setVec3("u_LightPos", lp.x, lp.y, lp.z);
+                        sh.setFloat("u_FarPlane", m_pointShadowFar);
+                    });
+                }
+                else for (int f = 0; f < 6; ++f)
                 {
-                    m_pointShadowMap->beginFace(f);
-                    glm::mat4 view = glm::lookAt(lp, lp + dirs[f], ups[f]);
+                    PROFILE_GPU_SCOPE(faceNames[f]);
+                    const glm::mat4& view = pointViews[f];
                     if (m_renderFromECS && m_ecsBridge)
                     {
-                        auto& reg = m_ecsBridge->reg();
-                        auto v = reg.view<TransformC, MeshRendererC>();
-                        for (auto ent : v)
+                        const glm::mat4 faceVP = proj * view;
+                        drawShadowView(snap, m_shadowCasters[pointFaceViews + f], kCachePoint0 + f, m_pointShadowMap->size(), &faceVP[0][0],
+                            [&]() { m_pointShadowMap->beginFace(f); }, *m_pointDepthShader, *m_pointDepthInstancedShader, [&](Shader& sh)
                         {
-                            const auto& tr = v.get<TransformC>(ent);
-                            const auto& mr = v.get<MeshRendererC>(ent);
-                            if (!mr.mesh) continue;
-                            glm::mat4 T = glm::translate(glm::mat4(1.0f), tr.position);
-                            glm::mat4 R = glm::yawPitchRoll(tr.rotationEuler.y, tr.rotationEuler.x, tr.rotationEuler.z);
-                            glm::mat4 S = glm::scale(glm::mat4(1.0f), tr.scale);
-                            glm::mat4 model = T * R * S;
-                            m_pointDepthShader->bind();
-                            m_pointDepthShader->setMat4("u_Proj", &proj[0][0]);
-                            m_pointDepthShader->setMat4("u_View", &view[0][0]);
-                            m_pointDepthShader->setMat4("u_Model", &model[0][0]);
-                            m_pointDepthShader->setVec3("u_LightPos", lp.x, lp.y, lp.z);
-                            mr.mesh->draw();
-                        }
+                            sh.setMat4("u_Proj", &proj[0][0]);
+                            sh.setMat4("u_View", &view[0][0]);
+                            sh.setVec3("u_LightPos", lp.x, lp.y, lp.z);
+                            sh.setFloat("u_FarPlane", m_pointShadowFar);
+                        });
                     }
                     else
                     {
+                        m_pointShadowMap->beginFace(f);
                         for (const auto& e : m_scene->getEntities())
                         {
                             glm::mat4 model = e.transform.modelMatrix();
@@ -1652,6 +3321,7 @@ ecs_inspector_end_components: ;
                             m_pointDepthShader->setMat4("u_View", &view[0][0]);
                             m_pointDepthShader->setMat4("u_Model", &model[0][0]);
                             m_pointDepthShader->setVec3("u_LightPos", lp.x, lp.y, lp.z);
+                            m_pointDepthShader->setFloat("u_FarPlane", m_pointShadowFar);
                             e.mesh->draw();
                         }
                     }
@@ -1661,61 +3331,18 @@ ecs_inspector_end_components: ;
             }
 
             // Spot shadow pass: reuse 2D ShadowMap with perspective proj
-            glm::mat4 spotView = glm::lookAt(
-                glm::vec3(m_spotPos[0], m_spotPos[1], m_spotPos[2]),
-                glm::vec3(m_spotPos[0], m_spotPos[1], m_spotPos[2]) + glm::normalize(glm::vec3(m_spotDir[0], m_spotDir[1], m_spotDir[2])),
-                glm::vec3(0,1,0));
-            glm::mat4 spotProj = glm::perspective(glm::radians(m_spotOuter * 2.0f), 1.0f, m_spotNear, m_spotFar);
-            glm::mat4 spotVP = spotProj * spotView;
-            // If ECS has a SpotLight, map the first one into legacy variables for shader
-            if (m_renderFromECS && m_ecsBridge)
-            {
-                auto& reg = m_ecsBridge->reg();
-                auto vsl = reg.view<SpotLightC, TransformC>();
-                for (auto e : vsl)
-                {
-                    const auto& sl = vsl.get<SpotLightC>(e);
-                    const auto& tr = vsl.get<TransformC>(e);
-                    glm::vec3 pos = tr.position;
-                    glm::vec3 dir = glm::normalize(sl.direction);
-                    m_spotEnabled = true;
-                    m_spotPos[0]=pos.x; m_spotPos[1]=pos.y; m_spotPos[2]=pos.z;
-                    m_spotDir[0]=dir.x; m_spotDir[1]=dir.y; m_spotDir[2]=dir.z;
-                    m_spotColor[0]=sl.color.x*sl.intensity; m_spotColor[1]=sl.color.y*sl.intensity; m_spotColor[2]=sl.color.z*sl.intensity;
-                    m_spotInner = sl.innerDegrees; m_spotOuter = sl.outerDegrees; m_spotNear = sl.nearPlane; m_spotFar = sl.farPlane;
-                    spotView = glm::lookAt(
-                        glm::vec3(m_spotPos[0], m_spotPos[1], m_spotPos[2]),
-                        glm::vec3(m_spotPos[0], m_spotPos[1], m_spotPos[2]) + glm::normalize(glm::vec3(m_spotDir[0], m_spotDir[1], m_spotDir[2])),
-                        glm::vec3(0,1,0));
-                    spotProj = glm::perspective(glm::radians(m_spotOuter * 2.0f), 1.0f, m_spotNear, m_spotFar);
-                    spotVP = spotProj * spotView;
-                    break;
-                }
-            }
-            if (m_spotEnabled && !m_wireframe)
+            if (shadowSpot)
             {
-                m_shadowMap->begin();
+                PROFILE_GPU_SCOPE("shadow_spot");
                 if (m_renderFromECS && m_ecsBridge)
                 {
-                    auto& reg = m_ecsBridge->reg();
-                    auto v = reg.view<TransformC, MeshRendererC>();
-                    for (auto ent : v)
-                    {
-                        const auto& tr = v.get<TransformC>(ent);
-                        const auto& mr = v.get<MeshRendererC>(ent);
-                        if (!mr.mesh) continue;
-                        glm::mat4 T = glm::translate(glm::mat4(1.0f), tr.position);
-                        glm::mat4 R = glm::yawPitchRoll(tr.rotationEuler.y, tr.rotationEuler.x, tr.rotationEuler.z);
-                        glm::mat4 S = glm::scale(glm::mat4(1.0f), tr.scale);
-                        glm::mat4 model = T * R * S;
-                        m_depthShader->bind();
-                        m_depthShader->setMat4("u_LightVP", &spotVP[0][0]);
-                        m_depthShader->setMat4("u_Model", &model[0][0]);
-                        mr.mesh->draw();
-                    }
+                    drawShadowView(snap, m_shadowCasters[spotViews], kCacheSpot, m_shadowMap->width(), &spotVP[0][0],
+                        [&]() { m_shadowMap->begin(); }, *m_depthShader, *m_depthInstancedShader,
+                        [&](Shader& sh) { sh.setMat4("u_LightVP", &spotVP[0][0]); });
                 }
                 else
                 {
+                    m_shadowMap->begin();
                     for (const auto& e : m_scene->getEntities())
                     {
                         glm::mat4 model = e.transform.modelMatrix();
@@ -1729,32 +3356,37 @@ ecs_inspector_end_components: ;
                 m_shadowMap->end(display_w, display_h);
             }
 
+            // Local light tiles, packed into the atlas by prepareLocalLights
+            if (atlasViews >= 0)
+            {
+                PROFILE_GPU_SCOPE("shadow_atlas");
+                for (int t = 0; t < m_atlasTileCount; ++t)
+                {
+                    const glm::mat4& vp = m_localLights->tiles[t].viewProj;
+                    m_shadowAtlas->beginTile(m_atlasTiles[t]);
+                    drawDepthCasters(snap, m_shadowCasters[atlasViews + t], *m_depthShader, *m_depthInstancedShader,
+                        [&](Shader& sh) { sh.setMat4("u_LightVP", &vp[0][0]); });
+                }
+                m_depthShader->unbind();
+                m_shadowAtlas->end(display_w, display_h);
+            }
+
+            // Camera, lights and cascades for every shader of the frame, once
+            uploadUniformBlocks(dt, &lightVP[0][0], &spotVP[0][0]);
+
             // Re-bind HDR FBO after shadow passes (they restore default FBO)
             if (m_post)
                 m_post->bind(display_w, display_h);
 
-            // Skinned update & draw
+            // Skinned draw (animated in simulateFrame, palette from the snapshot)
             if (m_skinMesh && m_skinSkeleton && m_skinAnimator)
             {
-                if (m_skinPlaying)
-                {
-                    // temporarily scale dt by speed by advancing animator time outside; update uses dt directly
-                    float dtLocal = dt * m_skinSpeed;
-                    m_skinAnimator->update(*m_skinSkeleton, dtLocal);
-                }
+                PROFILE_GPU_SCOPE("skinned");
                 // upload bones
                 const int maxBones = 128;
-                int count = (int)std::min<size_t>(m_skinSkeleton->posePalette.size(), maxBones);
+                int count = (int)std::min<size_t>(snap.bonePalette.size(), maxBones);
                 m_skinShader->bind();
-                glm::mat4 model = glm::mat4(1.0f);
-                glm::mat4 vp = m_camera->projection() * m_camera->view();
-                glm::mat3 nrm = glm::mat3(glm::transpose(glm::inverse(model)));
-                m_skinShader->setMat4("u_Model", &model[0][0]);
-                m_skinShader->setMat4("u_VP", &vp[0][0]);
-                m_skinShader->setMat3("u_NormalMatrix", &nrm[0][0]);
-                m_skinShader->setVec3("u_CameraPos", m_camera->position().x, m_camera->position().y, m_camera->position().z);
-                m_skinShader->setVec3("u_LightPos", m_lightPos[0], m_lightPos[1], m_lightPos[2]);
-                m_skinShader->setVec3("u_LightColor", m_lightColor[0], m_lightColor[1], m_lightColor[2]);
+                m_skinShader->setInt("u_ObjectIndex", 0);
                 m_skinShader->setVec3("u_Albedo", 1.0f, 1.0f, 1.0f);
                 m_skinShader->setFloat("u_Shininess", 64.0f);
                 if (m_skinDiffuse)
@@ -1768,237 +3400,78 @@ ecs_inspector_end_components: ;
                     m_skinShader->setInt("u_UseTexture", 0);
                 }
                 if (count > 0)
-                    m_skinShader->setMat4Array("u_Bones", &m_skinSkeleton->posePalette[0][0][0], count);
-                m_skinMesh->draw();
+                    m_skinShader->setMat4Array("u_Bones", &snap.bonePalette[0][0][0], count);
+                // identity model
+                drawThroughObjectBlock(*m_objectStream, 1, [](int, ObjectEntry& entry) { entry = ObjectEntry{}; },
+                                       [&](int, int) { m_skinMesh->draw(); });
                 m_skinShader->unbind();
             }
 
-            // Frustum culling visibility compute
-            if (m_frustumCulling)
-            {
-                glm::mat4 vp = m_camera->projection() * m_camera->view();
-                computeCameraFrustum(&vp[0][0]);
-                m_frustumVisible.assign(m_scene->getEntities().size(), 1);
-                for (size_t i=0;i<m_scene->getEntities().size();++i)
-                {
-                    const auto& e = m_scene->getEntities()[i];
-                    float center[3] = { e.transform.position.x, e.transform.position.y, e.transform.position.z };
-                    float radius = 1.0f * std::max({e.transform.scale.x, e.transform.scale.y, e.transform.scale.z});
-                    if (!sphereInFrustum(center, radius)) m_frustumVisible[i] = 0;
-                }
-            }
-
             // Render scene: ECS registry (MeshRendererC + TransformC)
-            if (m_renderFromECS && m_ecsBridge)
+            if (m_renderFromECS && m_ecsBridge && m_pbrShader)
             {
-                auto& reg = m_ecsBridge->reg();
-                auto view = reg.view<TransformC, MeshRendererC>();
-                for (auto e : view)
-                {
-                    const auto& tr = view.get<TransformC>(e);
-                    const auto& mr = view.get<MeshRendererC>(e);
-                    if (!mr.mesh) continue;
-                    glm::mat4 T = glm::translate(glm::mat4(1.0f), tr.position);
-                    glm::mat4 R = glm::yawPitchRoll(tr.rotationEuler.y, tr.rotationEuler.x, tr.rotationEuler.z);
-                    glm::mat4 S = glm::scale(glm::mat4(1.0f), tr.scale);
-                    glm::mat4 model = T * R * S;
-                    glm::mat4 mvp = m_camera->projection() * m_camera->view() * model;
-                    glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
-                    // PBR shader path with IBL + optional CSM
-                    if (m_pbrShader)
-                    {
-                        m_pbrShader->bind();
-                        m_pbrShader->setMat4("u_MVP", &mvp[0][0]);
-                        m_pbrShader->setMat4("u_Model", &model[0][0]);
-                        m_pbrShader->setMat3("u_NormalMatrix", &normalMat[0][0]);
-                        m_pbrShader->setVec3("u_Cam", m_camera->position().x, m_camera->position().y, m_camera->position().z);
-                        m_pbrShader->setVec3("u_LightPos", m_lightPos[0], m_lightPos[1], m_lightPos[2]);
-                        if (mr.material)
-                        {
-                            m_pbrShader->setVec3("u_Albedo", mr.material->albedo[0], mr.material->albedo[1], mr.material->albedo[2]);
-                            m_pbrShader->setFloat("u_Metallic", mr.material->metallic);
-                            m_pbrShader->setFloat("u_Roughness", mr.material->roughness);
-                            m_pbrShader->setFloat("u_AO", mr.material->ao);
-                            int useAlbedoTex = (mr.material->albedoTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseAlbedoTex", useAlbedoTex); if (useAlbedoTex){ m_pbrShader->setInt("u_AlbedoTex",0); mr.material->albedoTex->bind(0);} 
-                            int useMetalTex = (mr.material->metallicTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseMetalTex", useMetalTex); if (useMetalTex){ m_pbrShader->setInt("u_MetalTex",1); mr.material->metallicTex->bind(1);} 
-                            int useRoughTex = (mr.material->roughnessTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseRoughTex", useRoughTex); if (useRoughTex){ m_pbrShader->setInt("u_RoughTex",2); mr.material->roughnessTex->bind(2);} 
-                            int useAOTex = (mr.material->aoTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseAOTex", useAOTex); if (useAOTex){ m_pbrShader->setInt("u_AOTex",3); mr.material->aoTex->bind(3);} 
-                            int useNormal = (mr.material->normalTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseNormalMap", useNormal); if (useNormal){ m_pbrShader->setInt("u_NormalTex",4); mr.material->normalTex->bind(4);} 
-                        }
-                        else
-                        {
-                            m_pbrShader->setVec3("u_Albedo", 1.0f, 1.0f, 1.0f);
-                            m_pbrShader->setFloat("u_Metallic", 0.0f);
-                            m_pbrShader->setFloat("u_Roughness", 0.8f);
-                            m_pbrShader->setFloat("u_AO", 1.0f);
-                            int useAlbedoTex = (mr.albedoTex!=nullptr)?1:0; m_pbrShader->setInt("u_UseAlbedoTex", useAlbedoTex); if (useAlbedoTex){ m_pbrShader->setInt("u_AlbedoTex",0); mr.albedoTex->bind(0);} 
-                            m_pbrShader->setInt("u_UseMetalTex", 0);
-                            m_pbrShader->setInt("u_UseRoughTex", 0);
-                            m_pbrShader->setInt("u_UseAOTex", 0);
-                            m_pbrShader->setInt("u_UseNormalMap", 0);
-                        }
-                        if (m_useIBL && m_ibl && m_ibl->valid())
-                        {
-                            m_pbrShader->setInt("u_UseIBL", 1);
-                            m_pbrShader->setInt("u_IrradianceMap", 5); glActiveTexture(GL_TEXTURE0+5); glBindTexture(GL_TEXTURE_CUBE_MAP, m_ibl->irradianceMap());
-                            m_pbrShader->setInt("u_PrefilterMap", 6); glActiveTexture(GL_TEXTURE0+6); glBindTexture(GL_TEXTURE_CUBE_MAP, m_ibl->prefilterMap());
-                            m_pbrShader->setInt("u_BRDFLUT", 7); glActiveTexture(GL_TEXTURE0+7); glBindTexture(GL_TEXTURE_2D, m_ibl->brdfLUT());
-                        }
-                        else m_pbrShader->setInt("u_UseIBL", 0);
-                        m_pbrShader->setInt("u_ShadowsEnabled", (m_shadowsEnabled && !m_wireframe) ? 1 : 0);
-                        if (!m_csmEnabled)
-                        {
-                            m_pbrShader->setInt("u_UseCSM", 0);
-                            m_pbrShader->setMat4("u_LightVP", &lightVP[0][0]);
-                            m_pbrShader->setFloat("u_ShadowBias", m_shadowBias);
-                            m_shadowMap->bindDepthTexture(8);
-                            m_pbrShader->setInt("u_ShadowMap", 8);
-                            m_pbrShader->setInt("u_PCFKernel", m_usePCF ? m_pcfKernel : 0);
-                            m_pbrShader->setFloat("u_ShadowMapSize", (float)m_shadowMapSize);
-                            m_pbrShader->setInt("u_UsePCSS", m_usePCSS ? 1 : 0);
-                            m_pbrShader->setFloat("u_LightRadius", m_lightRadius);
-                        }
-                        else
-                        {
-                            m_pbrShader->setInt("u_UseCSM", 1);
-                            int cascades = m_cascadeCount;
-                            for (int c = 0; c < cascades; ++c)
-                            {
-                                char name[32]; sprintf_s(name, "u_CascadeVP[%d]", c);
-                                m_pbrShader->setMat4(name, m_cascadeMatrices[c]);
-                                m_csm->bindCascade(c, 8 + c);
-                                char smp[32]; sprintf_s(smp, "u_CascadeMap[%d]", c);
-                                m_pbrShader->setInt(smp, 8 + c);
-                            }
-                            m_pbrShader->setInt("u_CascadeCount", cascades);
-                            m_pbrShader->setFloat("u_ShadowBias", m_shadowBias);
-                            m_pbrShader->setInt("u_PCFKernel", m_usePCF ? m_pcfKernel : 0);
-                            m_pbrShader->setFloat("u_ShadowMapSize", (float)m_csmSize);
-                            m_pbrShader->setInt("u_UsePCSS", m_usePCSS ? 1 : 0);
-                            m_pbrShader->setFloat("u_LightRadius", m_lightRadius);
-                        }
-                        mr.mesh->draw();
-                        m_pbrShader->unbind();
-                    }
-                }
+                PROFILE_GPU_SCOPE("ecs_pbr");
+                submitPbrQueue(snap);
             }
             // Legacy path removed from draw
 
             // Debug draw colliders (boxes only) - legacy Scene only; TODO: ECS physics
             if (m_drawColliders && m_physics)
             {
+                PROFILE_GPU_SCOPE("colliders");
                 bool prevWire = m_wireframe;
                 Renderer::setWireframe(true);
-                for (const auto& b : m_physBindings)
+                m_shader->bind();
+                m_shader->setVec3("u_Albedo", 0.0f, 1.0f, 0.0f);
+                m_shader->setFloat("u_Shininess", 8.0f);
+                m_shader->setInt("u_UseTexture", 0);
+                m_shader->setInt("u_ReceiveShadows", 0);
+                const UniformHandle uObject = m_shader->uniform("u_ObjectIndex");
+                drawThroughObjectBlock(*m_objectStream, (int)snap.colliders.size(), [&](int i, ObjectEntry& entry)
                 {
-                    physx::PxRigidDynamic* body = reinterpret_cast<physx::PxRigidDynamic*>(b.actor);
-                    if (!body) continue;
-                    physx::PxU32 numShapes = body->getNbShapes();
-                    if (numShapes == 0) continue;
-                    std::vector<physx::PxShape*> shapes(numShapes);
-                    body->getShapes(shapes.data(), numShapes);
-                    for (physx::PxShape* s : shapes)
-                    {
-                        physx::PxBoxGeometry boxGeo;
-                        if (s->getBoxGeometry(boxGeo))
-                        {
-                            physx::PxTransform aPose = body->getGlobalPose() * s->getLocalPose();
-                            glm::mat4 T = glm::translate(glm::mat4(1.0f), glm::vec3(aPose.p.x, aPose.p.y, aPose.p.z));
-                            glm::quat rq(aPose.q.w, aPose.q.x, aPose.q.y, aPose.q.z);
-                            glm::mat4 R = glm::toMat4(rq);
-                            glm::mat4 S = glm::scale(glm::mat4(1.0f), glm::vec3(boxGeo.halfExtents.x * 2.0f, boxGeo.halfExtents.y * 2.0f, boxGeo.halfExtents.z * 2.0f));
-                            glm::mat4 model = T * R * S;
-                            glm::mat4 mvp = m_camera->projection() * m_camera->view() * model;
-                            glm::mat3 normalMat = glm::mat3(glm::transpose(glm::inverse(model)));
-                            m_shader->bind();
-                            m_shader->setMat4("u_MVP", &mvp[0][0]);
-                            m_shader->setMat4("u_Model", &model[0][0]);
-                            m_shader->setMat3("u_NormalMatrix", &normalMat[0][0]);
-                            m_shader->setVec3("u_CameraPos", m_camera->position().x, m_camera->position().y, m_camera->position().z);
-                            m_shader->setVec3("u_LightPos", m_lightPos[0], m_lightPos[1], m_lightPos[2]);
-                            m_shader->setVec3("u_LightColor", 0.0f, 1.0f, 0.0f);
-                            m_shader->setVec3("u_Albedo", 0.0f, 1.0f, 0.0f);
-                            m_shader->setFloat("u_Shininess", 8.0f);
-                            m_shader->setInt("u_UseTexture", 0);
-                            m_shader->setInt("u_ShadowsEnabled", 0);
-                            m_cube->draw();
-                            m_shader->unbind();
-                        }
-                    }
-                }
+                    entry.model = snap.colliders[i];
+                    entry.normal = glm::mat4(glm::mat3(glm::transpose(glm::inverse(snap.colliders[i]))));
+                },
+                [&](int, int slot)
+                {
+                    m_shader->setInt(uObject, slot);
+                    m_cube->draw();
+                });
+                m_shader->unbind();
                 Renderer::setWireframe(prevWire);
             }
 
-            // Simple keyboard gizmo (ECS)
-            if (m_ecsBridge)
+            // Draw skybox last
             {
-                static entt::entity ecsSel = entt::null;
-                // use last selection from hierarchy panel scope
-                // move selected entity with arrow keys
-                auto& reg = m_ecsBridge->reg();
-                if (ecsSel == entt::null)
-                {
-                    // pick first entity as default
-                    auto v = reg.view<TagC>();
-                    for (auto e : v) { ecsSel = e; break; }
-                }
-                if (ecsSel != entt::null)
-                {
-                    if (auto tr = reg.try_get<TransformC>(ecsSel))
-                    {
-                        if (m_input->isKeyPressed(GLFW_KEY_T)) m_gizmoOp = 0;
-                        if (m_input->isKeyPressed(GLFW_KEY_R)) m_gizmoOp = 1;
-                        if (m_input->isKeyPressed(GLFW_KEY_S)) m_gizmoOp = 2;
-                        float delta = (float)m_gizmoSensitivity;
-                        if (m_input->isKeyPressed(GLFW_KEY_LEFT))
-                        {
-                            if (m_gizmoOp == 0) (&tr->position.x)[m_gizmoAxis] -= delta;
-                            else if (m_gizmoOp == 1) (&tr->rotationEuler.x)[m_gizmoAxis] -= delta;
-                            else (&tr->scale.x)[m_gizmoAxis] *= (1.0f - delta);
-                        }
-                        if (m_input->isKeyPressed(GLFW_KEY_RIGHT))
-                        {
-                            if (m_gizmoOp == 0) (&tr->position.x)[m_gizmoAxis] += delta;
-                            else if (m_gizmoOp == 1) (&tr->rotationEuler.x)[m_gizmoAxis] += delta;
-                            else (&tr->scale.x)[m_gizmoAxis] *= (1.0f + delta);
-                        }
-                    }
-                }
+                PROFILE_GPU_SCOPE("skybox");
+                m_skybox->draw(m_camera->projection(), m_camera->view(), {m_skyTop[0], m_skyTop[1], m_skyTop[2]}, {m_skyBottom[0], m_skyBottom[1], m_skyBottom[2]});
             }
 
-            // Draw skybox last
-            m_skybox->draw(m_camera->projection(), m_camera->view(), {m_skyTop[0], m_skyTop[1], m_skyTop[2]}, {m_skyBottom[0], m_skyBottom[1], m_skyBottom[2]});
-
             // Terrain draw
             if (m_terrain)
             {
-                m_terrain->draw(
-                    m_camera->projection(),
-                    m_camera->view(),
-                    m_camera->position(),
-                    glm::vec3(m_lightPos[0], m_lightPos[1], m_lightPos[2]),
-                    glm::vec3(m_lightColor[0], m_lightColor[1], m_lightColor[2])
-                );
+                PROFILE_GPU_SCOPE("terrain");
+                m_terrain->draw();
             }
 
-            // Update & draw particles (after opaque)
-            if (m_particles)
+            // Draw particles (after opaque); simulated in simulateFrame
             {
-                m_particles->update(dt,
-                    m_particlesEmit,
-                    glm::vec3(0.0f, 1.0f, 0.0f),
-                    m_particlesRate,
-                    m_particlesLifetime,
-                    m_particlesSize,
-                    glm::vec3(m_particlesColor[0], m_particlesColor[1], m_particlesColor[2]),
-                    m_particlesGravityY,
-                    m_particlesAdditive);
-                m_particles->draw(&m_camera->projection()[0][0], &m_camera->view()[0][0]);
+                PROFILE_GPU_SCOPE("particles");
+                glm::vec3 color(m_particlesColor[0], m_particlesColor[1], m_particlesColor[2]);
+                for (int i = 0; i < snap.particleCount; ++i)
+                {
+                    const ParticleBatch& b = snap.particles[i];
+                    if (!b.system) continue;
+                    b.system->setStyle(color, m_particlesAdditive);
+                    b.system->upload(b.packed.data(), b.count);
+                    b.system->draw();
+                }
             }
 
             // Update audio listener from camera
             if (m_audio)
             {
+                PROFILE_SCOPE("audio");
                 glm::vec3 camPos = m_camera->position();
                 // approximate forward/up from view matrix
                 glm::mat4 V = m_camera->view();
@@ -2008,36 +3481,88 @@ ecs_inspector_end_components: ;
             }
 
             // Finalize ImGui and render draw data
+            ProfileScope imguiZone("imgui");
             m_ui->endFrame();
+            imguiZone.stop();
             // Post-process to screen, then draw ImGui on top
             if (m_wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }
             if (m_post)
+            {
+                PROFILE_GPU_SCOPE("post_process");
                 m_post->drawToScreen(display_w, display_h, m_exposure, m_gamma, m_fxaa,
                     m_bloomEnabled, m_bloomThreshold, m_bloomIntensity, m_bloomIterations,
                     m_ssaoEnabled, m_ssaoRadius, m_ssaoBias, m_ssaoPower,
                     m_taaEnabled, m_taaAlpha);
+            }
             // Ensure UI draws in fill mode
             if (m_wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }
-            if (m_ui) m_ui->renderDrawData();
+            if (m_ui) { PROFILE_GPU_SCOPE("imgui"); m_ui->renderDrawData(); }
             if (m_wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
 
-            m_window->swapBuffers();
+            if (m_gpuTimer) m_gpuTimer->endFrame();
+            {
+                PROFILE_SCOPE("swap");
+                m_window->swapBuffers();
+            }
+            StreamBuffer::advanceFrame();
+            Profiler::instance().endFrame();
+            {
+                std::chrono::duration<float, std::milli> frameMs = std::chrono::steady_clock::now() - frameStart;
+                m_frameHistory[m_frameHistoryPos] = frameMs.count();
+                m_frameHistoryPos = (m_frameHistoryPos + 1) % kFrameHistory;
+                if (m_profFreezeOnSpike && frameMs.count() > m_profSpikeMs) Profiler::instance().setFrozen(true);
+            }
+            if (bench)
+            {
+                for (const auto& z : Profiler::instance().lastFrame())
+                    bench->record(z.name, (double)(z.endNs - z.startNs) / 1.0e6);
+                // GPU results lag kFrameLatency frames; fine for aggregate stats
+                if (m_gpuTimer)
+                {
+                    for (const auto& g : m_gpuTimer->results())
+                        bench->record((std::string("gpu/") + g.name).c_str(), g.ms);
+                    bench->record("gpu/frame", m_gpuTimer->frameMs());
+                }
+                std::chrono::duration<double, std::milli> frameMs = std::chrono::steady_clock::now() - frameStart;
+                bench->endFrame(frameMs.count());
+            }
+            ++frameIndex;
         }
 
+        waitForSimulation();
+        bool reportOk = writeBenchmarkReport();
         shutdown();
         std::cout << "[App] Shutdown completed" << std::endl;
-        return 0;
+        return reportOk ? 0 : 1;
     }
 
     void Application::shutdown()
     {
+        waitForSimulation();
+        if (m_autosave)
+        {
+            if (m_autosaveEnabled) m_autosave->checkpoint();
+            m_autosave.reset(); // drains pending writes
+        }
         if (m_ui) { m_ui->shutdown(); m_ui.reset(); }
+        m_gpuTimer.reset();
         Renderer::shutdown();
         // release physics actors first
         for (auto& b : m_physBindings) b.actor = nullptr;
         m_physBindings.clear();
         m_cube.reset();
         m_shader.reset();
+        m_frameUbo.reset();
+        m_lightUbo.reset();
+        m_objectStream.reset();
+        m_localLightUbo.reset();
+        m_localLightTbo.reset();
+        m_clusterCellTbo.reset();
+        m_clusterIndexTbo.reset();
+        m_shadowAtlas.reset();
+        m_shadowCaches.clear();
+        GeometryArena::instance().destroy();
+        StreamBuffer::releaseFences();
         m_camera.reset();
         if (m_input)
         {
@@ -2055,11 +3580,24 @@ ecs_inspector_end_components: ;
     bool Application::initializeGLFW()
     {
         glfwSetErrorCallback(glfw_error_callback);
+        // Headless benchmark: null platform (no display server) + offscreen EGL/OSMesa context
+        const bool offscreen = m_bench.enabled && m_bench.headless && m_bench.contextApi != "native";
+#ifdef GLFW_PLATFORM_NULL
+        if (offscreen)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
         if (!glfwInit())
             return false;
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (offscreen)
+        {
+            if (m_bench.contextApi == "osmesa")
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            else
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
         return true;
     }
 
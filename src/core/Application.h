@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <imgui.h>
+#include "core/Benchmark.h"
+#include "render/RenderStats.h"
 
 struct GLFWwindow;
 
@@ -33,7 +38,28 @@ namespace engine
     class AudioEngine;
     class IBL;
     class CascadedShadowMap;
+    class ShadowCache;
+    class ShadowAtlas;
+    struct AtlasTile;
+    struct LocalLightBlock;
+    struct LocalLightEntry;
+    class LightClusters;
+    class TextureBuffer;
     class UIManager;
+    class GpuTimer;
+    class JobSystem;
+    class JobCounter;
+    struct RenderSnapshot;
+    class FrustumCuller;
+    struct CullView;
+    class RenderQueue;
+    class UniformBuffer;
+    class StreamBuffer;
+    struct InstanceBatch;
+    struct DrawIndirectCommand;
+    class DynamicBVH;
+    class SceneAutosave;
+    class SystemScheduler;
     struct ECS; // forward decl in ecs/ECS.h
     class ECSBridge; // local bridge class
 
@@ -47,6 +73,9 @@ namespace engine
         int run();
         void shutdown();
 
+        // Enables headless benchmark mode; call before run()
+        void setBenchmark(const BenchmarkSettings& settings) { m_bench = settings; }
+
     private:
         bool initializeGLFW();
         bool initializeGLAD();
@@ -59,13 +88,50 @@ namespace engine
         void rebuildPhysicsFromECS();
         void syncECSFromPhysics(float dt);
         void handlePickingECS();
+        // frame phases: simulation writes the registry, render passes read a snapshot of it
+        void registerSimulationSystems();
+        void simulateFrame(float dt);
+        void buildRenderSnapshot(RenderSnapshot& out);
+        void applySnapshotLights(const RenderSnapshot& snap);
+        void submitPbrQueue(const RenderSnapshot& snap);
+        void uploadUniformBlocks(float dt, const float* lightVP, const float* spotVP);
+        void drawDepthCasters(const RenderSnapshot& snap, const std::vector<uint32_t>& casters,
+                              Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView);
+        void beginShadowView(const RenderSnapshot& snap, const std::vector<uint32_t>& casters, int cacheSlot,
+                             int size, const float* viewProj, const std::function<void()>& beginTarget,
+                             Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView,
+                             std::vector<uint32_t>& remaining);
+        void drawShadowView(const RenderSnapshot& snap, const std::vector<uint32_t>& casters, int cacheSlot,
+                            int size, const float* viewProj, const std::function<void()>& beginTarget,
+                            Shader& shader, Shader& instancedShader, const std::function<void(Shader&)>& setView);
+        // picks the local lights of the frame and packs their shadow tiles into the atlas
+        void prepareLocalLights(const RenderSnapshot& snap);
+        // indices of snap.items inside the frustum of viewProj (all of them with culling off)
+        void cullSnapshot(const RenderSnapshot& snap, const float* viewProj, std::vector<uint32_t>& out);
+        void syncEmitterSystems();
+        void waitForSimulation();
         // picking helpers
         void handlePicking();
+        // refits m_sceneBvh to the legacy Scene entities (unit cube bounds scaled by transform)
+        void syncSceneBvh();
         // frustum culling helpers
         void computeCameraFrustum(const float* viewProj);
         bool sphereInFrustum(const float center[3], float radius) const;
+        // skinned import (UI + benchmark)
+        bool loadSkinnedModel(const char* path);
+        // benchmark helpers
+        void buildBenchmarkScene();
+        bool writeBenchmarkReport();
 
     private:
+        // first member: destroyed last, after everything that may still run jobs
+        std::unique_ptr<JobSystem> m_jobs;
+        // Pipelined frame: frame N+1 simulates on a worker while frame N renders the front snapshot
+        bool m_pipelined = false;
+        std::unique_ptr<JobCounter> m_simCounter;
+        std::unique_ptr<RenderSnapshot> m_snapshots[2];
+        int m_frontSnapshot = 0;
+        bool m_backSnapshotReady = false;
         std::unique_ptr<Window> m_window;
         std::unique_ptr<class InputManager> m_input;
         std::unique_ptr<UIManager> m_ui;
@@ -76,18 +142,37 @@ namespace engine
         std::unique_ptr<Texture2D> m_texture;
         std::unique_ptr<Scene> m_scene;
         std::unique_ptr<ECSBridge> m_ecsBridge;
+        std::unique_ptr<SystemScheduler> m_systems; // simulation systems over m_ecsBridge's registry
+        // ECS scene saves: incremental, written on its own thread once a path is saved or loaded
+        std::unique_ptr<SceneAutosave> m_autosave;
+        bool m_autosaveEnabled = true;
+        float m_autosaveInterval = 30.0f; // seconds
+        bool m_saveShortcutHeld = false;
+        char m_ecsPath[260] = "ecs_scene.ecsb";
+        int m_prefabSpawnCount = 100;
         std::unique_ptr<Transform> m_cubeTransform;
         std::unique_ptr<ResourceManager> m_resources;
         std::unique_ptr<ShadowMap> m_shadowMap;
         std::unique_ptr<Shader> m_depthShader;
+        std::unique_ptr<Shader> m_depthInstancedShader;
         std::unique_ptr<Shader> m_pbrShader;
+        std::unique_ptr<Shader> m_pbrInstancedShader;
         std::unique_ptr<PointShadowMap> m_pointShadowMap;
         std::unique_ptr<Shader> m_pointDepthShader;
+        std::unique_ptr<Shader> m_pointDepthInstancedShader;
+        // one pass for every cascade / cube face (geometry stage sets gl_Layer)
+        std::unique_ptr<Shader> m_layeredDepthShader;
+        std::unique_ptr<Shader> m_layeredDepthInstancedShader;
+        std::unique_ptr<Shader> m_layeredPointShader;
+        std::unique_ptr<Shader> m_layeredPointInstancedShader;
         std::unique_ptr<Skybox> m_skybox;
         std::unique_ptr<InputMap> m_inputMap;
         std::unique_ptr<Physics> m_physics;
         std::unique_ptr<PostProcess> m_post;
+        std::unique_ptr<GpuTimer> m_gpuTimer;
         std::unique_ptr<ParticleSystem> m_particles;
+        // One system per ECS ParticleEmitterC, keyed by entt::to_integral(entity)
+        std::unordered_map<uint32_t, std::unique_ptr<ParticleSystem>> m_emitterSystems;
         // Skinned
         std::unique_ptr<Shader> m_skinShader;
         std::unique_ptr<SkinnedMesh> m_skinMesh;
@@ -202,6 +287,9 @@ namespace engine
         float m_cascadeFade = 0.0f; // not used yet
         float m_cascadeStabilize = 0.0f; // not used yet
         float m_cascadeMatrices[4][16]; // upload helper
+        int m_cascadeUpdateInterval = 2; // far cascades are redrawn every N frames, round-robin
+        bool m_cascadeRendered[4] = {};  // cascade holds a depth map for its current matrix
+        uint32_t m_shadowFrame = 0;
         // Point shadow
         bool m_pointShadowEnabled = false;
         float m_pointLightPos[3] = { 2.0f, 4.0f, 2.0f };
@@ -236,6 +324,9 @@ namespace engine
 
         struct PhysBinding { void* actor; int entityIndex; };
         std::vector<PhysBinding> m_physBindings;
+        // legacy Scene picking: one proxy per entity index
+        std::unique_ptr<DynamicBVH> m_sceneBvh;
+        std::vector<int> m_sceneProxies;
         bool m_drawColliders = true;
         bool m_enablePicking = true;
         bool m_pushOnPick = true;
@@ -246,14 +337,74 @@ namespace engine
 
         // Model import (Assimp)
         char m_modelPath[260] = "";
+        bool m_importAsHierarchy = false; // Assimp nodes become parented ECS entities
         std::vector<std::unique_ptr<Mesh>> m_importedMeshes;
 
         // Performance
         bool m_frustumCulling = true;
-        bool m_useInstancing = false;
+        bool m_useInstancing = true; // batch equal mesh + material into instanced draws
         // frustum planes: 6 planes (a,b,c,d)
         float m_frustumPlanes[6][4] = {};
         std::vector<unsigned char> m_frustumVisible;
+        // ECS path: snapshot item indices that pass the camera / each shadow view of the frame
+        std::unique_ptr<FrustumCuller> m_culler;
+        std::vector<uint32_t> m_visibleItems;
+        std::vector<CullView> m_shadowViews;
+        std::vector<std::vector<uint32_t>> m_shadowCasters; // per entry of m_shadowViews
+        // static caster depth per shadow view (see ShadowCache.h)
+        enum { kCacheDir = 0, kCacheCascade0 = 1, kCachePoint0 = 5, kCacheSpot = 11, kShadowCacheCount = 12 };
+        bool m_shadowCaching = true;
+        std::vector<std::unique_ptr<ShadowCache>> m_shadowCaches;
+        std::vector<uint32_t> m_staticCasters, m_dynamicCasters; // scratch for drawShadowView
+        int m_shadowCacheUpdates = 0; // static re-renders, last frame
+        // cube faces / due cascades drawn in one geometry-shader pass (needs the layered shaders)
+        bool m_layeredShadows = true;
+        std::vector<uint32_t> m_layerCasters; // union of the layers' remaining casters
+        std::vector<uint8_t> m_casterSeen;    // per snapshot item, for m_layerCasters
+        // point/spot lights of the ECS PBR pass; their shadows share one atlas
+        bool m_shadowAtlasEnabled = true;
+        int m_shadowAtlasSize = 4096;
+        int m_shadowAtlasMaxTile = 1024;
+        float m_shadowAtlasBias = 0.0005f;
+        std::unique_ptr<ShadowAtlas> m_shadowAtlas;
+        std::unique_ptr<UniformBuffer> m_localLightUbo;
+        std::unique_ptr<LocalLightBlock> m_localLights; // uploaded with the other blocks
+        std::vector<LocalLightEntry> m_localLightEntries; // lights of m_localLights, in m_localLightTbo
+        std::unique_ptr<TextureBuffer> m_localLightTbo;
+        // froxel light lists: the PBR fragment shader visits only its cluster's lights
+        bool m_clusteredLights = true;
+        std::unique_ptr<LightClusters> m_lightClusters;
+        std::unique_ptr<TextureBuffer> m_clusterCellTbo;  // offset, count per cluster
+        std::unique_ptr<TextureBuffer> m_clusterIndexTbo; // light indices
+        std::vector<int> m_atlasRequests;
+        std::vector<AtlasTile> m_atlasPacked;    // per request
+        std::vector<AtlasTile> m_atlasTiles;     // per entry of m_localLights->tiles
+        std::vector<int> m_atlasTileLight;       // light of each tile
+        int m_atlasTileCount = 0;
+        // ECS PBR draws sorted by state (see RenderQueue.h)
+        std::unique_ptr<RenderQueue> m_renderQueue;
+        int m_pbrPackets = 0;
+        RenderStats m_pbrStats;   // state changes of the ECS PBR pass, last frame
+        RenderStats m_frameStats; // whole frame, last frame
+        // FrameData / LightData blocks shared by the built-in shaders; ObjectData ranges are streamed
+        std::unique_ptr<UniformBuffer> m_frameUbo;
+        std::unique_ptr<UniformBuffer> m_lightUbo;
+        std::unique_ptr<StreamBuffer> m_objectStream;
+        std::vector<InstanceBatch> m_instanceBatches; // instancing scratch, reused across passes
+        std::vector<DrawIndirectCommand> m_indirectCommands; // one per instance batch
+        double m_elapsedTime = 0.0;
+        // CPU profiler UI
+        static const int kFrameHistory = 240;
+        float m_frameHistory[kFrameHistory] = {};
+        int m_frameHistoryPos = 0;
+        bool m_profFreezeOnSpike = false;
+        float m_profSpikeMs = 33.0f;
+        char m_tracePath[260] = "trace.json";
+
+        // Benchmark
+        BenchmarkSettings m_bench;
+        std::unique_ptr<BenchmarkRecorder> m_benchRecorder;
+        std::unique_ptr<Texture2D> m_benchHeightmap;
     };
 }
 
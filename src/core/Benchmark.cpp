@@ -0,0 +1,505 @@
+#include "core/Benchmark.h"
+#include "core/JobSystem.h"
+#include "ecs/ECS.h"
+#include "ecs/ECSSerializer.h"
+#include "ecs/Prefab.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using json = nlohmann::json;
+
+namespace engine
+{
+    static bool argValue(int argc, char** argv, int& i, const char*& value)
+    {
+        if (i + 1 >= argc) { std::cerr << "[Bench] missing value for " << argv[i] << std::endl; return false; }
+        value = argv[++i];
+        return true;
+    }
+
+    BenchmarkSettings::ParseResult BenchmarkSettings::parseArgs(int argc, char** argv, BenchmarkSettings& out)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char* a = argv[i];
+            const char* v = nullptr;
+            if (std::strcmp(a, "--bench") == 0) out.enabled = true;
+            else if (std::strcmp(a, "--bench-windowed") == 0) { out.enabled = true; out.headless = false; }
+            else if (std::strcmp(a, "--bench-gl") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.contextApi = v; }
+            else if (std::strcmp(a, "--bench-size") == 0)
+            {
+                if (!argValue(argc, argv, i, v)) return ParseResult::Error;
+                int w = 0, h = 0;
+                if (std::sscanf(v, "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) { std::cerr << "[Bench] bad size: " << v << std::endl; return ParseResult::Error; }
+                out.width = w; out.height = h;
+            }
+            else if (std::strcmp(a, "--bench-frames") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.frames = std::max(1, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-warmup") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.warmupFrames = std::max(0, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-dt") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.fixedDt = (float)std::atof(v); }
+            else if (std::strcmp(a, "--bench-seed") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.seed = (unsigned int)std::strtoul(v, nullptr, 10); }
+            else if (std::strcmp(a, "--bench-cubes") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.cubes = std::max(0, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-chain") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.chainLength = std::max(1, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-lights") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.pointLights = std::max(0, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-emitters") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.emitters = std::max(0, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-terrain") == 0) out.terrain = true;
+            else if (std::strcmp(a, "--bench-skinned") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.skinnedPath = v; }
+            else if (std::strcmp(a, "--bench-no-physics") == 0) out.physics = false;
+            else if (std::strcmp(a, "--bench-sync-gpu") == 0) out.syncGpu = true;
+            else if (std::strcmp(a, "--bench-pipelined") == 0) out.pipelined = true;
+            else if (std::strcmp(a, "--bench-no-instancing") == 0) out.instancing = false;
+            else if (std::strcmp(a, "--bench-no-shadow-cache") == 0) out.shadowCache = false;
+            else if (std::strcmp(a, "--bench-no-shadow-atlas") == 0) out.shadowAtlas = false;
+            else if (std::strcmp(a, "--bench-no-layered-shadows") == 0) out.layeredShadows = false;
+            else if (std::strcmp(a, "--bench-no-clustered-lights") == 0) out.clusteredLights = false;
+            else if (std::strcmp(a, "--bench-jobs") == 0) { out.enabled = true; out.jobs = true; }
+            else if (std::strcmp(a, "--bench-serialize") == 0) { out.enabled = true; out.serialize = true; }
+            else if (std::strcmp(a, "--bench-spawn") == 0) { out.enabled = true; out.spawn = true; }
+            else if (std::strcmp(a, "--bench-workers") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.jobWorkers = std::max(0, std::atoi(v)); }
+            else if (std::strcmp(a, "--bench-out") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.reportPath = v; }
+            else if (std::strcmp(a, "--bench-csv") == 0) { if (!argValue(argc, argv, i, v)) return ParseResult::Error; out.csvPath = v; }
+            else if (std::strcmp(a, "--help") == 0 || std::strcmp(a, "-h") == 0) { printUsage(); return ParseResult::Exit; }
+        }
+        if (out.fixedDt <= 0.0f) { std::cerr << "[Bench] dt must be positive" << std::endl; return ParseResult::Error; }
+        if (out.contextApi != "egl" && out.contextApi != "osmesa" && out.contextApi != "native")
+        {
+            std::cerr << "[Bench] unknown GL context api: " << out.contextApi << std::endl;
+            return ParseResult::Error;
+        }
+        return ParseResult::Run;
+    }
+
+    void BenchmarkSettings::printUsage()
+    {
+        std::cout <<
+            "Benchmark mode:\n"
+            "  --bench                 run the stress scene headless and write a report\n"
+            "  --bench-windowed        same, but in a visible window\n"
+            "  --bench-gl <api>        offscreen context: egl (default), osmesa, native\n"
+            "  --bench-size WxH        framebuffer size (default 1280x720)\n"
+            "  --bench-frames N        measured frames (default 600)\n"
+            "  --bench-warmup N        warm-up frames excluded from stats (default 30)\n"
+            "  --bench-dt S            fixed timestep in seconds (default 1/60)\n"
+            "  --bench-seed N          scene generation seed\n"
+            "  --bench-cubes N         ECS cubes (default 1000)\n"
+            "  --bench-chain N         parent cubes into chains of N (transform hierarchy)\n"
+            "  --bench-lights N        ECS point lights (default 4)\n"
+            "  --bench-emitters N      ECS particle emitters (default 4)\n"
+            "  --bench-terrain         add procedural terrain\n"
+            "  --bench-skinned <path>  add a skinned model\n"
+            "  --bench-no-physics      no rigid bodies on the cubes\n"
+            "  --bench-sync-gpu        glFinish after every phase\n"
+            "  --bench-pipelined       simulate frame N+1 on workers while frame N renders\n"
+            "  --bench-no-instancing   one draw call per entity instead of instanced batches\n"
+            "  --bench-no-shadow-cache redraw static shadow casters every frame\n"
+            "  --bench-no-shadow-atlas point lights lit without shadows\n"
+            "  --bench-no-layered-shadows one pass per cube face / cascade\n"
+            "  --bench-no-clustered-lights every fragment loops over all local lights\n"
+            "  --bench-jobs            job system throughput/latency benchmarks only\n"
+            "  --bench-workers N       job system worker threads (default cores - 1)\n"
+            "  --bench-serialize       ECS scene save/load, JSON vs binary (--bench-cubes entities)\n"
+            "  --bench-spawn           spawn --bench-cubes props, component copies vs prefab instances\n"
+            "  --bench-out <path>      JSON report (default bench_report.json)\n"
+            "  --bench-csv <path>      per-frame CSV\n";
+    }
+
+    BenchmarkRecorder::BenchmarkRecorder(const BenchmarkSettings& settings)
+        : m_settings(settings)
+    {
+    }
+
+    int BenchmarkRecorder::phaseIndex(const char* phase)
+    {
+        for (int i = 0; i < (int)m_phaseNames.size(); ++i)
+            if (m_phaseNames[i] == phase) return i;
+        m_phaseNames.emplace_back(phase);
+        m_current.push_back(0.0);
+        // phases first seen late are zero for the frames already measured
+        m_samples.emplace_back(m_frameMs.size(), 0.0);
+        return (int)m_phaseNames.size() - 1;
+    }
+
+    void BenchmarkRecorder::beginFrame(int frameIndex)
+    {
+        m_measuring = frameIndex >= m_settings.warmupFrames;
+        std::fill(m_current.begin(), m_current.end(), 0.0);
+    }
+
+    void BenchmarkRecorder::record(const char* phase, double ms)
+    {
+        int idx = phaseIndex(phase);
+        m_current[idx] += ms;
+    }
+
+    void BenchmarkRecorder::endFrame(double frameMs)
+    {
+        if (!m_measuring) return;
+        for (size_t i = 0; i < m_phaseNames.size(); ++i)
+            m_samples[i].push_back(m_current[i]);
+        m_frameMs.push_back(frameMs);
+    }
+
+    void BenchmarkRecorder::setContextInfo(const std::string& vendor, const std::string& renderer, const std::string& version)
+    {
+        m_glVendor = vendor; m_glRenderer = renderer; m_glVersion = version;
+    }
+
+    static json statsToJson(std::vector<double> v)
+    {
+        json j;
+        if (v.empty()) return j;
+        std::sort(v.begin(), v.end());
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        double mean = sum / (double)v.size();
+        double var = 0.0;
+        for (double x : v) var += (x - mean) * (x - mean);
+        var /= (double)v.size();
+        auto pct = [&](double p) { size_t i = (size_t)std::min<double>((double)v.size() - 1, std::floor(p * (double)(v.size() - 1) + 0.5)); return v[i]; };
+        j["mean"] = mean;
+        j["min"] = v.front();
+        j["max"] = v.back();
+        j["p50"] = pct(0.50);
+        j["p95"] = pct(0.95);
+        j["p99"] = pct(0.99);
+        j["stddev"] = std::sqrt(var);
+        j["total"] = sum;
+        return j;
+    }
+
+    bool BenchmarkRecorder::writeJson(const std::string& path) const
+    {
+        json root;
+        json s;
+        s["width"] = m_settings.width; s["height"] = m_settings.height;
+        s["frames"] = m_settings.frames; s["warmupFrames"] = m_settings.warmupFrames;
+        s["fixedDt"] = m_settings.fixedDt; s["seed"] = m_settings.seed;
+        s["cubes"] = m_settings.cubes; s["pointLights"] = m_settings.pointLights; s["emitters"] = m_settings.emitters;
+        s["chainLength"] = m_settings.chainLength;
+        s["terrain"] = m_settings.terrain; s["skinned"] = m_settings.skinnedPath;
+        s["physics"] = m_settings.physics; s["syncGpu"] = m_settings.syncGpu;
+        s["pipelined"] = m_settings.pipelined; s["instancing"] = m_settings.instancing;
+        s["shadowCache"] = m_settings.shadowCache; s["shadowAtlas"] = m_settings.shadowAtlas;
+        s["layeredShadows"] = m_settings.layeredShadows; s["clusteredLights"] = m_settings.clusteredLights;
+        s["headless"] = m_settings.headless; s["contextApi"] = m_settings.contextApi;
+        root["settings"] = s;
+        root["gl"] = { {"vendor", m_glVendor}, {"renderer", m_glRenderer}, {"version", m_glVersion} };
+#ifdef NDEBUG
+        root["build"] = "release";
+#else
+        root["build"] = "debug";
+#endif
+        root["measuredFrames"] = (int)m_frameMs.size();
+        root["frame"] = statsToJson(m_frameMs);
+        json phases = json::object();
+        for (size_t i = 0; i < m_phaseNames.size(); ++i)
+            phases[m_phaseNames[i]] = statsToJson(m_samples[i]);
+        root["phases"] = phases;
+        std::ofstream f(path, std::ios::binary);
+        if (!f) { std::cerr << "[Bench] cannot write " << path << std::endl; return false; }
+        f << root.dump(2);
+        return true;
+    }
+
+    bool BenchmarkRecorder::writeCsv(const std::string& path) const
+    {
+        std::ofstream f(path, std::ios::binary);
+        if (!f) { std::cerr << "[Bench] cannot write " << path << std::endl; return false; }
+        f << "frame,frame_ms";
+        for (const auto& n : m_phaseNames) f << "," << n;
+        f << "\n";
+        for (size_t fr = 0; fr < m_frameMs.size(); ++fr)
+        {
+            f << fr << "," << m_frameMs[fr];
+            for (size_t i = 0; i < m_phaseNames.size(); ++i) f << "," << m_samples[i][fr];
+            f << "\n";
+        }
+        return true;
+    }
+
+    // ---- Job system micro-benchmarks ----
+    using BenchClock = std::chrono::steady_clock;
+
+    static double elapsedMs(BenchClock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(BenchClock::now() - t0).count();
+    }
+
+    int runJobSystemBenchmark(const BenchmarkSettings& settings)
+    {
+        JobSystem jobs(settings.jobWorkers);
+        const int repeats = 5;
+        json root;
+        root["workers"] = jobs.workerCount();
+        root["hardwareThreads"] = (int)std::thread::hardware_concurrency();
+        std::cout << "[Bench] job system, " << jobs.workerCount() << " workers" << std::endl;
+
+        // Throughput: many empty jobs submitted from the main thread
+        {
+            const int count = 200000;
+            std::vector<double> ms;
+            for (int r = 0; r < repeats; ++r)
+            {
+                JobCounter counter;
+                auto t0 = BenchClock::now();
+                for (int i = 0; i < count; ++i) jobs.run([]() {}, &counter);
+                jobs.wait(counter);
+                ms.push_back(elapsedMs(t0));
+            }
+            json j = statsToJson(ms);
+            j["jobs"] = count;
+            j["jobsPerSecond"] = (double)count / (j["min"].get<double>() / 1000.0);
+            root["emptyJobs"] = j;
+        }
+
+        // Nested fan-out: jobs spawn jobs on workers, so most work is stolen
+        {
+            const int outer = 1000, inner = 100;
+            std::vector<double> ms;
+            for (int r = 0; r < repeats; ++r)
+            {
+                JobCounter counter;
+                std::atomic<int> sum{0};
+                auto t0 = BenchClock::now();
+                for (int i = 0; i < outer; ++i)
+                {
+                    jobs.run([&]()
+                    {
+                        for (int k = 0; k < inner; ++k) jobs.run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+                    }, &counter);
+                }
+                jobs.wait(counter);
+                ms.push_back(elapsedMs(t0));
+                if (sum.load() != outer * inner) { std::cerr << "[Bench] fan-out lost jobs" << std::endl; return 1; }
+            }
+            json j = statsToJson(ms);
+            j["jobs"] = outer * (inner + 1);
+            root["fanOut"] = j;
+        }
+
+        // parallelFor speed-up over a serial loop
+        {
+            const int n = 1 << 24;
+            std::vector<float> data(n);
+            for (int i = 0; i < n; ++i) data[i] = (float)(i & 1023);
+            auto work = [&data](int b, int e) { for (int i = b; i < e; ++i) data[i] = std::sqrt(data[i] * 1.0001f + 1.0f); };
+            std::vector<double> serial, parallel;
+            for (int r = 0; r < repeats; ++r)
+            {
+                auto t0 = BenchClock::now();
+                work(0, n);
+                serial.push_back(elapsedMs(t0));
+                t0 = BenchClock::now();
+                jobs.parallelFor(n, 1 << 16, work);
+                parallel.push_back(elapsedMs(t0));
+            }
+            json j;
+            j["elements"] = n;
+            j["serial"] = statsToJson(serial);
+            j["parallel"] = statsToJson(parallel);
+            j["speedup"] = j["serial"]["min"].get<double>() / std::max(1e-6, j["parallel"]["min"].get<double>());
+            root["parallelFor"] = j;
+        }
+
+        // Dependency chain: each job waits on the previous one's counter
+        {
+            const int length = 10000;
+            std::vector<double> perHopUs;
+            for (int r = 0; r < repeats; ++r)
+            {
+                std::vector<std::unique_ptr<JobCounter>> counters;
+                counters.reserve(length);
+                for (int i = 0; i < length; ++i) counters.push_back(std::make_unique<JobCounter>());
+                auto t0 = BenchClock::now();
+                jobs.run([]() {}, counters[0].get());
+                for (int i = 1; i < length; ++i) jobs.runAfter(*counters[i - 1], []() {}, counters[i].get());
+                jobs.wait(*counters[length - 1]);
+                perHopUs.push_back(elapsedMs(t0) * 1000.0 / (double)length);
+            }
+            root["dependencyChainUsPerHop"] = statsToJson(perHopUs);
+        }
+
+        // Wake-up latency: submit to an idle pool, time until the job starts
+        {
+            const int samples = 500;
+            std::vector<double> us;
+            for (int s = 0; s < samples; ++s)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                JobCounter counter;
+                BenchClock::time_point started;
+                auto t0 = BenchClock::now();
+                jobs.run([&started]() { started = BenchClock::now(); }, &counter);
+                // spin instead of helping so a worker has to pick it up
+                while (!counter.done()) std::this_thread::yield();
+                us.push_back(std::chrono::duration<double, std::micro>(started - t0).count());
+            }
+            root["wakeLatencyUs"] = statsToJson(us);
+        }
+
+        std::ofstream f(settings.reportPath, std::ios::binary);
+        if (!f) { std::cerr << "[Bench] cannot write " << settings.reportPath << std::endl; return 1; }
+        f << root.dump(2);
+        std::cout << "[Bench] job report: " << settings.reportPath << std::endl;
+        return 0;
+    }
+
+    // ---- ECS serialization benchmark ----
+    static long long fileSize(const std::string& path)
+    {
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        return f ? (long long)f.tellg() : -1;
+    }
+
+    int runSerializationBenchmark(const BenchmarkSettings& settings)
+    {
+        const int repeats = 5;
+        const int count = std::max(1, settings.cubes);
+        std::mt19937 rng(settings.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        // Same mix as the stress scene: named cubes, some rigid bodies, lights, chains
+        ECS scene;
+        auto& reg = scene.registry;
+        entt::entity chainParent = entt::null;
+        for (int i = 0; i < count; ++i)
+        {
+            auto e = scene.createEntity("Cube " + std::to_string(i));
+            auto& tr = reg.get<TransformC>(e);
+            tr.position = { unit(rng) * 200.0f - 100.0f, unit(rng) * 10.0f, unit(rng) * 200.0f - 100.0f };
+            tr.setEuler({ unit(rng) * 6.2831853f, unit(rng) * 6.2831853f, unit(rng) * 6.2831853f });
+            tr.scale = glm::vec3(0.5f + unit(rng) * 0.5f);
+            MeshRendererC mr;
+            if (i % 8 == 0) mr.materialPath = "assets/materials/bench_" + std::to_string(i % 4) + ".mat";
+            reg.emplace<MeshRendererC>(e, mr);
+            if (i % 4 == 0) { reg.emplace<RigidBodyC>(e); reg.emplace<BoxColliderC>(e); }
+            if (i % 100 == 0) reg.emplace<PointLightC>(e);
+            if (settings.chainLength > 1)
+            {
+                if (i % settings.chainLength != 0) setParent(reg, e, chainParent);
+                chainParent = e;
+            }
+        }
+
+        const std::string jsonPath = settings.reportPath + ".scene.json";
+        const std::string binPath = settings.reportPath + ".scene.ecsb";
+        std::vector<double> jsonSave, jsonLoad, binSave, binLoad;
+        for (int r = 0; r < repeats; ++r)
+        {
+            auto t0 = BenchClock::now();
+            if (!ECSSerializer::saveJson(scene, jsonPath)) { std::cerr << "[Bench] JSON save failed" << std::endl; return 1; }
+            jsonSave.push_back(elapsedMs(t0));
+            t0 = BenchClock::now();
+            if (!ECSSerializer::saveBinary(scene, binPath)) { std::cerr << "[Bench] binary save failed" << std::endl; return 1; }
+            binSave.push_back(elapsedMs(t0));
+
+            ECS loaded;
+            t0 = BenchClock::now();
+            if (!ECSSerializer::loadJson(loaded, jsonPath, nullptr)) { std::cerr << "[Bench] JSON load failed" << std::endl; return 1; }
+            jsonLoad.push_back(elapsedMs(t0));
+            if ((int)loaded.registry.view<TagC>().size() != count) { std::cerr << "[Bench] JSON round trip lost entities" << std::endl; return 1; }
+            t0 = BenchClock::now();
+            if (!ECSSerializer::loadBinary(loaded, binPath, nullptr)) { std::cerr << "[Bench] binary load failed" << std::endl; return 1; }
+            binLoad.push_back(elapsedMs(t0));
+            if ((int)loaded.registry.view<TagC>().size() != count) { std::cerr << "[Bench] binary round trip lost entities" << std::endl; return 1; }
+        }
+
+        json root;
+        root["entities"] = count;
+        root["chainLength"] = settings.chainLength;
+        root["json"] = { {"bytes", fileSize(jsonPath)}, {"saveMs", statsToJson(jsonSave)}, {"loadMs", statsToJson(jsonLoad)} };
+        root["binary"] = { {"bytes", fileSize(binPath)}, {"saveMs", statsToJson(binSave)}, {"loadMs", statsToJson(binLoad)} };
+        root["loadSpeedup"] = root["json"]["loadMs"]["min"].get<double>() / std::max(1e-6, root["binary"]["loadMs"]["min"].get<double>());
+        root["saveSpeedup"] = root["json"]["saveMs"]["min"].get<double>() / std::max(1e-6, root["binary"]["saveMs"]["min"].get<double>());
+        root["sizeRatio"] = (double)fileSize(jsonPath) / (double)std::max(1LL, fileSize(binPath));
+        std::remove(jsonPath.c_str());
+        std::remove(binPath.c_str());
+
+        std::ofstream f(settings.reportPath, std::ios::binary);
+        if (!f) { std::cerr << "[Bench] cannot write " << settings.reportPath << std::endl; return 1; }
+        f << root.dump(2);
+        std::cout << "[Bench] serialization report: " << settings.reportPath << std::endl;
+        return 0;
+    }
+
+    // ---- Prefab spawning benchmark ----
+    int runSpawnBenchmark(const BenchmarkSettings& settings)
+    {
+        const int repeats = 5;
+        const int count = std::max(1, settings.cubes);
+        std::mt19937 rng(settings.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<TransformC> transforms(count);
+        for (auto& tr : transforms)
+        {
+            tr.position = { unit(rng) * 200.0f - 100.0f, unit(rng) * 10.0f, unit(rng) * 200.0f - 100.0f };
+            tr.setEuler({ 0.0f, unit(rng) * 6.2831853f, 0.0f });
+        }
+        // a typical prop: material path too long for the small-string buffer
+        MeshRendererC mesh;
+        mesh.materialPath = "assets/materials/props/crate_weathered.mat";
+        const RigidBodyC rigidBody{ false, false, 2.0f, 0.6f, 0.1f };
+        const BoxColliderC collider{ 0.5f, 0.5f, 0.5f };
+
+        std::vector<double> copyMs, prefabMs;
+        for (int r = 0; r < repeats; ++r)
+        {
+            {
+                ECS scene;
+                auto& reg = scene.registry;
+                auto t0 = BenchClock::now();
+                for (int i = 0; i < count; ++i)
+                {
+                    auto e = scene.createEntity("Crate");
+                    reg.replace<TransformC>(e, transforms[i]);
+                    reg.emplace<MeshRendererC>(e, mesh);
+                    reg.emplace<RigidBodyC>(e, rigidBody);
+                    reg.emplace<BoxColliderC>(e, collider);
+                }
+                copyMs.push_back(elapsedMs(t0));
+            }
+            {
+                ECS scene;
+                auto& reg = scene.registry;
+                Prefab prefab;
+                prefab.name = "Crate";
+                prefab.meshRenderer = mesh;
+                prefab.rigidBody = rigidBody;
+                prefab.boxCollider = collider;
+                unsigned int id = registerPrefab(reg, std::move(prefab));
+                std::vector<entt::entity> created;
+                auto t0 = BenchClock::now();
+                instantiatePrefab(reg, id, (size_t)count, transforms.data(), &created);
+                prefabMs.push_back(elapsedMs(t0));
+                const auto* rb = resolveComponent<RigidBodyC>(reg, created.back());
+                if ((int)created.size() != count || !rb || rb->mass != rigidBody.mass) { std::cerr << "[Bench] prefab instances do not resolve" << std::endl; return 1; }
+            }
+        }
+
+        // per-instance bytes of the shareable components (pool entries plus string heap)
+        const size_t copyBytes = sizeof(MeshRendererC) + mesh.materialPath.capacity() + 1 + sizeof(RigidBodyC) + sizeof(BoxColliderC);
+        const size_t prefabBytes = sizeof(PrefabC);
+        json root;
+        root["entities"] = count;
+        root["copies"] = { {"spawnMs", statsToJson(copyMs)}, {"componentBytesPerEntity", copyBytes} };
+        root["prefab"] = { {"spawnMs", statsToJson(prefabMs)}, {"componentBytesPerEntity", prefabBytes} };
+        root["spawnSpeedup"] = root["copies"]["spawnMs"]["min"].get<double>() / std::max(1e-6, root["prefab"]["spawnMs"]["min"].get<double>());
+        root["componentMemoryRatio"] = (double)copyBytes / (double)prefabBytes;
+
+        std::ofstream f(settings.reportPath, std::ios::binary);
+        if (!f) { std::cerr << "[Bench] cannot write " << settings.reportPath << std::endl; return 1; }
+        f << root.dump(2);
+        std::cout << "[Bench] spawn report: " << settings.reportPath << std::endl;
+        return 0;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace engine
+{
+    // Headless benchmark configuration (filled from command line)
+    struct BenchmarkSettings
+    {
+        bool enabled = false;
+        bool headless = true;          // offscreen context, no visible window
+        std::string contextApi = "egl"; // egl | osmesa | native
+        int width = 1280;
+        int height = 720;
+        int frames = 600;              // measured frames
+        int warmupFrames = 30;         // not included in statistics
+        float fixedDt = 1.0f / 60.0f;
+        unsigned int seed = 1337;
+        // Procedural stress scene
+        int cubes = 1000;
+        int chainLength = 1;           // cubes per parent/child chain (1 = flat)
+        int pointLights = 4;
+        int emitters = 4;
+        bool terrain = false;
+        std::string skinnedPath;       // optional skinned model
+        bool physics = true;           // rigid bodies for the cubes
+        bool jobs = false;             // job system micro-benchmarks only (no window)
+        int jobWorkers = 0;            // 0 = hardware threads - 1
+        bool syncGpu = false;          // glFinish at each zone end (CPU+GPU time per phase)
+        bool pipelined = false;        // overlap next-frame simulation with rendering
+        bool instancing = true;        // batch equal mesh + material into instanced draws
+        bool shadowCache = true;       // cache static caster depth per shadow view
+        bool shadowAtlas = true;       // point/spot light shadows in the atlas
+        bool layeredShadows = true;    // cube faces / cascades in one layered draw
+        bool clusteredLights = true;   // per-froxel light lists for the ECS point/spot lights
+        bool serialize = false;        // ECS scene save/load benchmark only (no window)
+        bool spawn = false;            // prefab vs per-entity spawning benchmark only (no window)
+        // Output
+        std::string reportPath = "bench_report.json";
+        std::string csvPath;           // optional per-frame CSV
+
+        // Error on malformed arguments, Exit after printing --help; unknown arguments are ignored
+        enum class ParseResult { Run, Exit, Error };
+        static ParseResult parseArgs(int argc, char** argv, BenchmarkSettings& out);
+        static void printUsage();
+    };
+
+    // Job system throughput/latency micro-benchmarks; writes settings.reportPath, returns exit code
+    int runJobSystemBenchmark(const BenchmarkSettings& settings);
+    // ECS scene save/load time and file size, JSON vs binary, for settings.cubes entities
+    int runSerializationBenchmark(const BenchmarkSettings& settings);
+    // Spawning settings.cubes props as full component copies vs prefab instances
+    int runSpawnBenchmark(const BenchmarkSettings& settings);
+
+    // Collects per-phase CPU timings for each frame and writes JSON/CSV reports
+    class BenchmarkRecorder
+    {
+    public:
+        explicit BenchmarkRecorder(const BenchmarkSettings& settings);
+
+        void beginFrame(int frameIndex);
+        // Adds ms to the named phase of the current frame (phases may be hit several times)
+        void record(const char* phase, double ms);
+        void endFrame(double frameMs);
+
+        bool measuring() const { return m_measuring; }
+        bool syncGpu() const { return m_settings.syncGpu; }
+        int measuredFrames() const { return (int)m_frameMs.size(); }
+
+        void setContextInfo(const std::string& vendor, const std::string& renderer, const std::string& version);
+        bool writeJson(const std::string& path) const;
+        bool writeCsv(const std::string& path) const;
+
+    private:
+        int phaseIndex(const char* phase);
+
+    private:
+        BenchmarkSettings m_settings;
+        bool m_measuring = false;
+        std::vector<std::string> m_phaseNames;
+        std::vector<double> m_current;                // current frame, per phase
+        std::vector<std::vector<double>> m_samples;   // [phase][frame]
+        std::vector<double> m_frameMs;
+        std::string m_glVendor, m_glRenderer, m_glVersion;
+    };
+}
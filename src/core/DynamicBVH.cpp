@@ -0,0 +1,186 @@
+#include "core/DynamicBVH.h"
+
+#include <algorithm>
+
+namespace engine
+{
+    int DynamicBVH::allocNode()
+    {
+        if (m_free == kNull)
+        {
+            m_nodes.emplace_back();
+            return (int)m_nodes.size() - 1;
+        }
+        int id = m_free;
+        m_free = m_nodes[id].parent;
+        m_nodes[id] = Node();
+        return id;
+    }
+
+    void DynamicBVH::freeNode(int node)
+    {
+        m_nodes[node].parent = m_free;
+        m_nodes[node].height = -1;
+        m_free = node;
+    }
+
+    void DynamicBVH::clear()
+    {
+        m_nodes.clear();
+        m_root = kNull;
+        m_free = kNull;
+        m_proxyCount = 0;
+    }
+
+    int DynamicBVH::createProxy(const Aabb& box, uint32_t userData)
+    {
+        int id = allocNode();
+        Node& n = m_nodes[id];
+        n.box = { box.min - glm::vec3(m_margin), box.max + glm::vec3(m_margin) };
+        n.userData = userData;
+        n.height = 0;
+        insertLeaf(id);
+        ++m_proxyCount;
+        return id;
+    }
+
+    void DynamicBVH::destroyProxy(int proxy)
+    {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --m_proxyCount;
+    }
+
+    bool DynamicBVH::moveProxy(int proxy, const Aabb& box)
+    {
+        if (m_nodes[proxy].box.contains(box)) return false;
+        removeLeaf(proxy);
+        m_nodes[proxy].box = { box.min - glm::vec3(m_margin), box.max + glm::vec3(m_margin) };
+        insertLeaf(proxy);
+        return true;
+    }
+
+    void DynamicBVH::insertLeaf(int leaf)
+    {
+        if (m_root == kNull)
+        {
+            m_root = leaf;
+            m_nodes[leaf].parent = kNull;
+            return;
+        }
+
+        // Descend towards the sibling whose merge costs the least area
+        const Aabb leafBox = m_nodes[leaf].box;
+        int index = m_root;
+        while (!m_nodes[index].leaf())
+        {
+            const Node& n = m_nodes[index];
+            float area = n.box.area();
+            float combined = Aabb::merge(n.box, leafBox).area();
+            float cost = 2.0f * combined;                  // new parent here
+            float inherit = 2.0f * (combined - area);      // growth pushed to descendants
+            auto childCost = [&](int c) {
+                const Node& cn = m_nodes[c];
+                float merged = Aabb::merge(cn.box, leafBox).area();
+                return cn.leaf() ? merged + inherit : merged - cn.box.area() + inherit;
+            };
+            float cost1 = childCost(n.child1);
+            float cost2 = childCost(n.child2);
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? n.child1 : n.child2;
+        }
+
+        int sibling = index;
+        int oldParent = m_nodes[sibling].parent;
+        int newParent = allocNode();
+        Node& p = m_nodes[newParent];
+        p.parent = oldParent;
+        p.box = Aabb::merge(leafBox, m_nodes[sibling].box);
+        p.height = m_nodes[sibling].height + 1;
+        p.child1 = sibling;
+        p.child2 = leaf;
+        m_nodes[sibling].parent = newParent;
+        m_nodes[leaf].parent = newParent;
+        if (oldParent == kNull) m_root = newParent;
+        else if (m_nodes[oldParent].child1 == sibling) m_nodes[oldParent].child1 = newParent;
+        else m_nodes[oldParent].child2 = newParent;
+
+        refitUp(m_nodes[leaf].parent);
+    }
+
+    void DynamicBVH::removeLeaf(int leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = kNull;
+            return;
+        }
+        int parent = m_nodes[leaf].parent;
+        int grand = m_nodes[parent].parent;
+        int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+        if (grand == kNull)
+        {
+            m_root = sibling;
+            m_nodes[sibling].parent = kNull;
+            freeNode(parent);
+            return;
+        }
+        if (m_nodes[grand].child1 == parent) m_nodes[grand].child1 = sibling;
+        else m_nodes[grand].child2 = sibling;
+        m_nodes[sibling].parent = grand;
+        freeNode(parent);
+        refitUp(grand);
+    }
+
+    void DynamicBVH::refitUp(int index)
+    {
+        while (index != kNull)
+        {
+            index = balance(index);
+            Node& n = m_nodes[index];
+            const Node& c1 = m_nodes[n.child1];
+            const Node& c2 = m_nodes[n.child2];
+            n.height = 1 + std::max(c1.height, c2.height);
+            n.box = Aabb::merge(c1.box, c2.box);
+            index = n.parent;
+        }
+    }
+
+    // Rotates a child up if one side is more than one level taller; returns the subtree root
+    int DynamicBVH::balance(int iA)
+    {
+        Node& A = m_nodes[iA];
+        if (A.leaf() || A.height < 2) return iA;
+        int iB = A.child1, iC = A.child2;
+        int diff = m_nodes[iC].height - m_nodes[iB].height;
+        if (diff >= -1 && diff <= 1) return iA;
+
+        // the taller child (up) replaces A; A takes the shorter grandchild's place
+        const bool rightTaller = diff > 1;
+        int iUp = rightTaller ? iC : iB;
+        int iOther = rightTaller ? iB : iC;
+        Node& up = m_nodes[iUp];
+        int iF = up.child1, iG = up.child2;
+
+        up.child1 = iA;
+        up.parent = A.parent;
+        A.parent = iUp;
+        if (up.parent == kNull) m_root = iUp;
+        else if (m_nodes[up.parent].child1 == iA) m_nodes[up.parent].child1 = iUp;
+        else m_nodes[up.parent].child2 = iUp;
+
+        // keep the taller grandchild under up, give the other to A
+        int iKeep = m_nodes[iF].height > m_nodes[iG].height ? iF : iG;
+        int iMove = iKeep == iF ? iG : iF;
+        up.child2 = iKeep;
+        if (rightTaller) A.child2 = iMove;
+        else A.child1 = iMove;
+        m_nodes[iMove].parent = iA;
+
+        A.box = Aabb::merge(m_nodes[iOther].box, m_nodes[iMove].box);
+        A.height = 1 + std::max(m_nodes[iOther].height, m_nodes[iMove].height);
+        up.box = Aabb::merge(A.box, m_nodes[iKeep].box);
+        up.height = 1 + std::max(A.height, m_nodes[iKeep].height);
+        return iUp;
+    }
+}
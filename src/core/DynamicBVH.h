@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace engine
+{
+    struct Aabb
+    {
+        glm::vec3 min{0.0f};
+        glm::vec3 max{0.0f};
+
+        bool contains(const Aabb& o) const
+        {
+            return min.x <= o.min.x && min.y <= o.min.y && min.z <= o.min.z
+                && max.x >= o.max.x && max.y >= o.max.y && max.z >= o.max.z;
+        }
+        bool overlaps(const Aabb& o) const
+        {
+            return min.x <= o.max.x && max.x >= o.min.x
+                && min.y <= o.max.y && max.y >= o.min.y
+                && min.z <= o.max.z && max.z >= o.min.z;
+        }
+        float area() const
+        {
+            glm::vec3 d = max - min;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+        static Aabb merge(const Aabb& a, const Aabb& b) { return { glm::min(a.min, b.min), glm::max(a.max, b.max) }; }
+        static Aabb fromSphere(const glm::vec3& c, float r) { return { c - glm::vec3(r), c + glm::vec3(r) }; }
+    };
+
+    // Dynamic AABB tree: leaves are proxies with a 32-bit user value and a box fattened
+    // by a margin, so small moves don't touch the tree. Inserts pick the sibling with the
+    // least surface-area growth; rotations keep it balanced.
+    class DynamicBVH
+    {
+    public:
+        static constexpr int kNull = -1;
+
+        explicit DynamicBVH(float margin = 0.1f) : m_margin(margin) {}
+
+        int createProxy(const Aabb& box, uint32_t userData);
+        void destroyProxy(int proxy);
+        // Returns true if the proxy left its fat box and was reinserted
+        bool moveProxy(int proxy, const Aabb& box);
+        void clear();
+
+        uint32_t userData(int proxy) const { return m_nodes[proxy].userData; }
+        const Aabb& fatAabb(int proxy) const { return m_nodes[proxy].box; }
+        int proxyCount() const { return m_proxyCount; }
+        int height() const { return m_root == kNull ? 0 : m_nodes[m_root].height; }
+
+        // fn(proxy) -> bool for every leaf whose fat box passes; return false to stop
+        template<typename Fn> void queryAabb(const Aabb& box, Fn&& fn) const;
+        template<typename Fn> void querySphere(const glm::vec3& center, float radius, Fn&& fn) const;
+        // planes: (a, b, c, d) facing inward, e.g. FrustumPlanes::p
+        template<typename Fn> void queryFrustum(const float (&planes)[6][4], Fn&& fn) const;
+        // fn(proxy, tEnter) -> float: new max distance (return 0 to stop). dir must be normalized.
+        template<typename Fn> void raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, Fn&& fn) const;
+
+    private:
+        struct Node
+        {
+            Aabb box;
+            int parent = kNull; // next free node while on the free list
+            int child1 = kNull;
+            int child2 = kNull;
+            int height = -1;    // 0 for leaves, -1 for free nodes
+            uint32_t userData = 0;
+            bool leaf() const { return child1 == kNull; }
+        };
+
+        int allocNode();
+        void freeNode(int node);
+        void insertLeaf(int leaf);
+        void removeLeaf(int leaf);
+        int balance(int a);
+        void refitUp(int node);
+
+        template<typename Test, typename Fn> void query(Test&& test, Fn&& fn) const;
+
+    private:
+        std::vector<Node> m_nodes;
+        int m_root = kNull;
+        int m_free = kNull;
+        int m_proxyCount = 0;
+        float m_margin;
+    };
+
+    // Traversal stack; rotations keep the height logarithmic, far below this
+    static constexpr int kBVHStackSize = 256;
+
+    // Fixed traversal storage that spills to the heap instead of dropping nodes when a
+    // degenerate tree goes deeper
+    class BVHStack
+    {
+    public:
+        bool empty() const { return m_size == 0; }
+        void push(int node)
+        {
+            if (m_size < kBVHStackSize) m_fixed[m_size] = node;
+            else m_spill.push_back(node);
+            ++m_size;
+        }
+        int pop()
+        {
+            if (--m_size < kBVHStackSize) return m_fixed[m_size];
+            int node = m_spill.back();
+            m_spill.pop_back();
+            return node;
+        }
+
+    private:
+        int m_fixed[kBVHStackSize];
+        std::vector<int> m_spill;
+        int m_size = 0;
+    };
+
+    template<typename Test, typename Fn>
+    void DynamicBVH::query(Test&& test, Fn&& fn) const
+    {
+        if (m_root == kNull) return;
+        BVHStack stack;
+        stack.push(m_root);
+        while (!stack.empty())
+        {
+            const int id = stack.pop();
+            const Node& n = m_nodes[id];
+            if (!test(n.box)) continue;
+            if (n.leaf())
+            {
+                if (!fn(id)) return;
+            }
+            else
+            {
+                stack.push(n.child1);
+                stack.push(n.child2);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void DynamicBVH::queryAabb(const Aabb& box, Fn&& fn) const
+    {
+        query([&](const Aabb& b) { return b.overlaps(box); }, fn);
+    }
+
+    template<typename Fn>
+    void DynamicBVH::querySphere(const glm::vec3& center, float radius, Fn&& fn) const
+    {
+        const float r2 = radius * radius;
+        query([&](const Aabb& b) {
+            glm::vec3 d = center - glm::clamp(center, b.min, b.max);
+            return glm::dot(d, d) <= r2;
+        }, fn);
+    }
+
+    template<typename Fn>
+    void DynamicBVH::queryFrustum(const float (&planes)[6][4], Fn&& fn) const
+    {
+        query([&](const Aabb& b) {
+            for (int i = 0; i < 6; ++i)
+            {
+                const float* p = planes[i];
+                // corner furthest along the plane normal
+                float x = p[0] >= 0.0f ? b.max.x : b.min.x;
+                float y = p[1] >= 0.0f ? b.max.y : b.min.y;
+                float z = p[2] >= 0.0f ? b.max.z : b.min.z;
+                if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f) return false;
+            }
+            return true;
+        }, fn);
+    }
+
+    template<typename Fn>
+    void DynamicBVH::raycast(const glm::vec3& origin, const glm::vec3& dir, float maxDist, Fn&& fn) const
+    {
+        if (m_root == kNull) return;
+        glm::vec3 inv(0.0f);
+        for (int a = 0; a < 3; ++a)
+            if (dir[a] != 0.0f) inv[a] = 1.0f / dir[a];
+        auto slab = [&](const Aabb& b, float& tEnter) {
+            float t0 = 0.0f, t1 = maxDist;
+            for (int a = 0; a < 3; ++a)
+            {
+                // parallel to this slab: the ray is inside it everywhere or nowhere (a 1/0
+                // here gives 0 * inf = NaN for an origin on the face)
+                if (dir[a] == 0.0f)
+                {
+                    if (origin[a] < b.min[a] || origin[a] > b.max[a]) return false;
+                    continue;
+                }
+                float lo = (b.min[a] - origin[a]) * inv[a];
+                float hi = (b.max[a] - origin[a]) * inv[a];
+                if (lo > hi) std::swap(lo, hi);
+                t0 = std::max(t0, lo);
+                t1 = std::min(t1, hi);
+            }
+            tEnter = t0;
+            return t0 <= t1;
+        };
+        BVHStack stack;
+        stack.push(m_root);
+        while (!stack.empty())
+        {
+            const int id = stack.pop();
+            const Node& n = m_nodes[id];
+            float tEnter;
+            if (!slab(n.box, tEnter)) continue;
+            if (n.leaf())
+            {
+                maxDist = fn(id, tEnter);
+                if (maxDist <= 0.0f) return;
+            }
+            else
+            {
+                stack.push(n.child1);
+                stack.push(n.child2);
+            }
+        }
+    }
+}
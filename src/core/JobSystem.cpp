@@ -0,0 +1,193 @@
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <string>
+
+namespace engine
+{
+    static thread_local const JobSystem* t_owner = nullptr;
+    static thread_local int t_index = -1;
+
+    JobSystem::JobSystem(int workerCount)
+    {
+        if (workerCount <= 0)
+            workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+        m_queues.reserve(workerCount + 1);
+        for (int i = 0; i < workerCount + 1; ++i)
+            m_queues.push_back(std::make_unique<Queue>());
+        m_workers.reserve(workerCount);
+        for (int i = 1; i <= workerCount; ++i)
+            m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        m_running.store(false);
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_all();
+        for (auto& t : m_workers) t.join();
+    }
+
+    int JobSystem::currentWorker() const
+    {
+        return t_owner == this ? t_index : -1;
+    }
+
+    void JobSystem::push(Job job)
+    {
+        int self = currentWorker();
+        Queue& q = *m_queues[self > 0 ? self : 0];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.jobs.push_back(std::move(job));
+        }
+        m_queued.fetch_add(1, std::memory_order_release);
+        // empty lock: a worker between its predicate check and sleeping can't miss this
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    void JobSystem::run(std::function<void()> fn, JobCounter* counter)
+    {
+        if (counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        push(Job{ std::move(fn), counter });
+    }
+
+    void JobSystem::runAfter(JobCounter& dependency, std::function<void()> fn, JobCounter* counter)
+    {
+        if (counter) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(dependency.m_mutex);
+            if (dependency.m_pending.load(std::memory_order_acquire) != 0)
+            {
+                dependency.m_continuations.push_back({ std::move(fn), counter });
+                return;
+            }
+        }
+        push(Job{ std::move(fn), counter });
+    }
+
+    void JobSystem::finish(JobCounter* counter)
+    {
+        if (!counter) return;
+        // Not the last job: plain decrement, the counter isn't touched afterwards
+        int v = counter->m_pending.load(std::memory_order_relaxed);
+        while (v > 1)
+        {
+            if (counter->m_pending.compare_exchange_weak(v, v - 1, std::memory_order_acq_rel))
+                return;
+        }
+        // Last job: reach zero under the lock so a waiter can't destroy the counter mid-release
+        std::vector<JobCounter::Continuation> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter->m_mutex);
+            if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                ready.swap(counter->m_continuations);
+        }
+        for (auto& c : ready)
+            push(Job{ std::move(c.fn), c.counter });
+    }
+
+    void JobSystem::execute(Job& job)
+    {
+        job.fn();
+        finish(job.counter);
+    }
+
+    bool JobSystem::popOrSteal(int self, Job& out)
+    {
+        if (m_queued.load(std::memory_order_acquire) <= 0) return false;
+        const int n = (int)m_queues.size();
+        // own queue first, newest job (cache-warm)
+        {
+            Queue& q = *m_queues[self];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.jobs.empty())
+            {
+                out = std::move(q.jobs.back());
+                q.jobs.pop_back();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        // steal the oldest job from someone else
+        for (int i = 1; i < n; ++i)
+        {
+            Queue& q = *m_queues[(self + i) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.jobs.empty())
+            {
+                out = std::move(q.jobs.front());
+                q.jobs.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool JobSystem::tryRunOne(int self)
+    {
+        Job job;
+        if (!popOrSteal(self, job)) return false;
+        execute(job);
+        return true;
+    }
+
+    void JobSystem::wait(JobCounter& counter)
+    {
+        int self = std::max(0, currentWorker());
+        while (!counter.done())
+        {
+            if (!tryRunOne(self))
+                std::this_thread::yield();
+        }
+    }
+
+    bool JobSystem::runPending()
+    {
+        return tryRunOne(std::max(0, currentWorker()));
+    }
+
+    void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)>& fn)
+    {
+        if (count <= 0) return;
+        grain = std::max(1, grain);
+        int chunks = (count + grain - 1) / grain;
+        if (chunks == 1) { fn(0, count); return; }
+        JobCounter counter;
+        for (int c = 1; c < chunks; ++c)
+        {
+            int b = c * grain;
+            int e = std::min(count, b + grain);
+            run([&fn, b, e]() { fn(b, e); }, &counter);
+        }
+        fn(0, std::min(count, grain));
+        wait(counter);
+    }
+
+    void JobSystem::workerLoop(int index)
+    {
+        t_owner = this;
+        t_index = index;
+        std::string name = "Worker " + std::to_string(index);
+        Profiler::instance().setThreadName(name.c_str());
+        while (true)
+        {
+            Job job;
+            if (popOrSteal(index, job))
+            {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            if (!m_running.load() && m_queued.load() <= 0) break;
+            m_wake.wait(lock, [this]() { return m_queued.load(std::memory_order_acquire) > 0 || !m_running.load(); });
+        }
+    }
+}
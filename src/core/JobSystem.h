@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+    class JobSystem;
+
+    // Completion counter: incremented per scheduled job, decremented when it finishes.
+    // Jobs queued with runAfter() start once it reaches zero.
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        // waits for a finisher that may still be releasing continuations
+        ~JobCounter() { std::lock_guard<std::mutex> lock(m_mutex); }
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        struct Continuation { std::function<void()> fn; JobCounter* counter; };
+        std::atomic<int> m_pending{0};
+        std::mutex m_mutex;
+        std::vector<Continuation> m_continuations;
+    };
+
+    // Work-stealing scheduler: each worker owns a deque (LIFO for the owner, FIFO for
+    // thieves). Threads that are not workers submit into a shared slot and help while waiting.
+    class JobSystem
+    {
+    public:
+        // workerCount <= 0: hardware threads - 1 (at least 1)
+        explicit JobSystem(int workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        int workerCount() const { return (int)m_workers.size(); }
+
+        void run(std::function<void()> fn, JobCounter* counter = nullptr);
+        // Starts fn once dependency reaches zero (immediately if it already has)
+        void runAfter(JobCounter& dependency, std::function<void()> fn, JobCounter* counter = nullptr);
+        // Runs other jobs until counter reaches zero
+        void wait(JobCounter& counter);
+        // Runs one queued job on the calling thread; false if there was none.
+        // For jobs that block on external work which itself runs on this pool.
+        bool runPending();
+
+        // fn(begin, end) over [0, count) in chunks of grain; the caller helps, returns when done
+        void parallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+        // Worker index of the calling thread, -1 if not a worker of this system
+        int currentWorker() const;
+
+    private:
+        struct Job { std::function<void()> fn; JobCounter* counter; };
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void push(Job job);
+        bool tryRunOne(int self);
+        bool popOrSteal(int self, Job& out);
+        void execute(Job& job);
+        void finish(JobCounter* counter);
+        void workerLoop(int index);
+
+    private:
+        // slot 0 is shared by non-worker threads, slots 1..N belong to workers
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<int> m_queued{0};
+        std::atomic<bool> m_running{true};
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+    };
+}
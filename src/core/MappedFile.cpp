@@ -0,0 +1,80 @@
+#include "core/MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine
+{
+    MappedFile::~MappedFile() { close(); }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); return false; }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { CloseHandle(file); return false; }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            std::cerr << "[MappedFile] MapViewOfFile failed: " << path << std::endl;
+            CloseHandle(mapping); CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = (size_t)size.QuadPart;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle((HANDLE)m_mapping);
+        if (m_file) CloseHandle((HANDLE)m_file);
+        m_data = nullptr; m_size = 0; m_mapping = nullptr; m_file = nullptr;
+    }
+#else
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+        {
+            std::cerr << "[MappedFile] mmap failed: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+        m_fd = fd;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = (size_t)st.st_size;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+        m_data = nullptr; m_size = 0; m_fd = -1;
+    }
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace engine
+{
+    // Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+}
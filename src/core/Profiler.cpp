@@ -0,0 +1,167 @@
+#include "core/Profiler.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using json = nlohmann::json;
+
+namespace engine
+{
+    static const uint64_t kRingCapacity = 1u << 15; // zones per thread
+    static const int kMaxDepth = 64;
+
+    struct Profiler::ThreadBuffer
+    {
+        std::vector<ProfileZone> ring;
+        std::atomic<uint64_t> head{0}; // total zones written
+        uint32_t threadId = 0;
+        std::string name;
+        // open zones (owning thread only)
+        const char* openNames[kMaxDepth];
+        uint64_t openStart[kMaxDepth];
+        int depth = 0;
+        int overflow = 0; // zones deeper than kMaxDepth (not recorded)
+    };
+
+    static thread_local Profiler::ThreadBuffer* t_buffer = nullptr;
+    static Profiler::ThreadBuffer* s_mainBuffer = nullptr;
+
+    Profiler& Profiler::instance()
+    {
+        static Profiler s_profiler;
+        return s_profiler;
+    }
+
+    uint64_t Profiler::nowNs()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Profiler::ThreadBuffer* Profiler::threadBuffer()
+    {
+        if (t_buffer) return t_buffer;
+        auto* tb = new ThreadBuffer();
+        tb->ring.resize(kRingCapacity);
+        {
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            tb->threadId = (uint32_t)m_threads.size();
+            tb->name = "Thread " + std::to_string(tb->threadId);
+            m_threads.push_back(tb);
+        }
+        t_buffer = tb;
+        return tb;
+    }
+
+    void Profiler::setThreadName(const char* name)
+    {
+        threadBuffer()->name = name;
+    }
+
+    void Profiler::beginZone(const char* name)
+    {
+        ThreadBuffer* tb = threadBuffer();
+        if (tb->depth >= kMaxDepth) { ++tb->overflow; return; }
+        tb->openNames[tb->depth] = name;
+        tb->openStart[tb->depth] = nowNs();
+        ++tb->depth;
+    }
+
+    void Profiler::endZone()
+    {
+        ThreadBuffer* tb = threadBuffer();
+        if (tb->overflow > 0) { --tb->overflow; return; }
+        if (tb->depth == 0) return;
+        if (m_fence && tb == s_mainBuffer) m_fence();
+        --tb->depth;
+        uint64_t h = tb->head.load(std::memory_order_relaxed);
+        ProfileZone& z = tb->ring[h % kRingCapacity];
+        z.name = tb->openNames[tb->depth];
+        z.startNs = tb->openStart[tb->depth];
+        z.endNs = nowNs();
+        z.depth = (uint32_t)tb->depth;
+        z.threadId = tb->threadId;
+        tb->head.store(h + 1, std::memory_order_release);
+    }
+
+    void Profiler::beginFrame()
+    {
+        ThreadBuffer* tb = threadBuffer();
+        if (!s_mainBuffer)
+        {
+            s_mainBuffer = tb;
+            tb->name = "Main";
+        }
+        m_frameStart = nowNs();
+        m_frameHead = tb->head.load(std::memory_order_relaxed);
+    }
+
+    void Profiler::endFrame()
+    {
+        if (!s_mainBuffer || m_frozen) return;
+        uint64_t h = s_mainBuffer->head.load(std::memory_order_relaxed);
+        uint64_t first = m_frameHead;
+        if (h - first > kRingCapacity) first = h - kRingCapacity;
+        m_lastFrame.clear();
+        for (uint64_t i = first; i < h; ++i)
+            m_lastFrame.push_back(s_mainBuffer->ring[i % kRingCapacity]);
+        m_lastFrameStart = m_frameStart;
+        m_lastFrameEnd = nowNs();
+    }
+
+    bool Profiler::dumpChromeTrace(const std::string& path)
+    {
+        std::vector<ProfileZone> zones;
+        std::vector<std::pair<uint32_t, std::string>> names;
+        {
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            for (ThreadBuffer* tb : m_threads)
+            {
+                names.emplace_back(tb->threadId, tb->name);
+                uint64_t h1 = tb->head.load(std::memory_order_acquire);
+                uint64_t first = h1 > kRingCapacity ? h1 - kRingCapacity : 0;
+                size_t base = zones.size();
+                for (uint64_t i = first; i < h1; ++i)
+                    zones.push_back(tb->ring[i % kRingCapacity]);
+                // drop entries the owner overwrote while we were copying
+                uint64_t h2 = tb->head.load(std::memory_order_acquire);
+                uint64_t safeFirst = h2 > kRingCapacity ? h2 - kRingCapacity : 0;
+                if (safeFirst > first)
+                {
+                    size_t drop = (size_t)std::min<uint64_t>(safeFirst - first, h1 - first);
+                    zones.erase(zones.begin() + base, zones.begin() + base + drop);
+                }
+            }
+        }
+        uint64_t t0 = UINT64_MAX;
+        for (const auto& z : zones) t0 = std::min(t0, z.startNs);
+
+        json events = json::array();
+        for (const auto& n : names)
+            events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", n.first}, {"args", { {"name", n.second} }} });
+        for (const auto& z : zones)
+        {
+            events.push_back({
+                {"name", z.name}, {"ph", "X"}, {"pid", 1}, {"tid", z.threadId},
+                {"ts", (double)(z.startNs - t0) / 1000.0},
+                {"dur", (double)(z.endNs - z.startNs) / 1000.0}
+            });
+        }
+        json root;
+        root["traceEvents"] = events;
+        root["displayTimeUnit"] = "ms";
+        std::ofstream f(path, std::ios::binary);
+        if (!f)
+        {
+            std::cerr << "[Profiler] cannot write " << path << std::endl;
+            return false;
+        }
+        f << root.dump();
+        std::cout << "[Profiler] wrote " << zones.size() << " zones to " << path << std::endl;
+        return true;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace engine
+{
+    // One closed zone; name must be a string literal (stored by pointer)
+    struct ProfileZone
+    {
+        const char* name;
+        uint64_t startNs;
+        uint64_t endNs;
+        uint32_t depth;
+        uint32_t threadId;
+    };
+
+    // Hierarchical CPU profiler. Each thread records into its own ring buffer
+    // without locking; the main thread's zones are collected per frame for the UI.
+    class Profiler
+    {
+    public:
+        static Profiler& instance();
+
+        // Read by every zone on every thread; a scope keeps the value it opened with
+        void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+        bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        // Called from zone scopes
+        void beginZone(const char* name);
+        void endZone();
+
+        // Optional callback run before a main-thread zone closes (e.g. glFinish in benchmarks)
+        void setZoneFence(void (*fence)()) { m_fence = fence; }
+
+        // Frame boundaries (main thread); endFrame snapshots the frame's main-thread zones
+        void beginFrame();
+        void endFrame();
+        const std::vector<ProfileZone>& lastFrame() const { return m_lastFrame; }
+        uint64_t lastFrameStartNs() const { return m_lastFrameStart; }
+        uint64_t lastFrameEndNs() const { return m_lastFrameEnd; }
+        // Keeps the last snapshot (UI inspection)
+        void setFrozen(bool frozen) { m_frozen = frozen; }
+        bool frozen() const { return m_frozen; }
+
+        // Names the calling thread in traces
+        void setThreadName(const char* name);
+
+        // Writes everything still in the ring buffers as chrome://tracing / Perfetto JSON
+        bool dumpChromeTrace(const std::string& path);
+
+        static uint64_t nowNs();
+
+        struct ThreadBuffer; // per-thread ring, defined in Profiler.cpp
+
+    private:
+        Profiler() = default;
+        ThreadBuffer* threadBuffer();
+
+    private:
+        std::atomic<bool> m_enabled{true};
+        bool m_frozen = false;
+        void (*m_fence)() = nullptr;
+        std::mutex m_threadsMutex;
+        std::vector<ThreadBuffer*> m_threads; // owned; threads may exit before a dump
+        uint64_t m_frameStart = 0;
+        uint64_t m_frameHead = 0; // main ring position at beginFrame
+        uint64_t m_lastFrameStart = 0;
+        uint64_t m_lastFrameEnd = 0;
+        std::vector<ProfileZone> m_lastFrame;
+    };
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name)
+            : m_active(Profiler::instance().enabled())
+        {
+            if (m_active) Profiler::instance().beginZone(name);
+        }
+        ~ProfileScope() { stop(); }
+        // Closes the zone early (for phases that don't map to a block)
+        void stop() { if (m_active) { Profiler::instance().endZone(); m_active = false; } }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        bool m_active;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ::engine::ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
@@ -2,7 +2,11 @@
 
 #include <string>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/euler_angles.hpp>
 #include <entt/entt.hpp>
+#include "ecs/TransformSystem.h"
+#include "ecs/SpatialSystem.h"
 
 namespace engine
 {
@@ -11,10 +15,49 @@ namespace engine
     struct TransformC
     {
         glm::vec3 position{0.0f};
-        glm::vec3 rotationEuler{0.0f};
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
         glm::vec3 scale{1.0f};
+
+        // Editor view: radians as (pitch, yaw, roll), composed yaw * pitch * roll
+        glm::vec3 euler() const
+        {
+            glm::vec3 e;
+            glm::extractEulerAngleYXZ(glm::mat4_cast(rotation), e.y, e.x, e.z);
+            return e;
+        }
+        void setEuler(const glm::vec3& e)
+        {
+            rotation = glm::angleAxis(e.y, glm::vec3(0.0f, 1.0f, 0.0f))
+                     * glm::angleAxis(e.x, glm::vec3(1.0f, 0.0f, 0.0f))
+                     * glm::angleAxis(e.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        }
     };
 
+    // Parent/child links (intrusive sibling list); edit only through setParent()
+    struct HierarchyC
+    {
+        entt::entity parent{entt::null};
+        entt::entity firstChild{entt::null};
+        entt::entity nextSibling{entt::null};
+        unsigned int depth{0};
+        int slot{-1}; // position in the propagation order
+    };
+
+    // Cached world matrix, rebuilt by updateWorldMatrices() only when TransformC changes
+    struct WorldMatrixC
+    {
+        glm::mat4 model{1.0f};
+        glm::mat3 normal{1.0f}; // transpose(inverse(model))
+    };
+
+    struct TransformDirtyC {};
+
+    // Leaf of the entity in the spatial index (runtime only, see SpatialSystem.h)
+    struct SpatialProxyC { int proxy{-1}; };
+
+    // Saved components changed since the last autosave checkpoint (bits: SceneDeltaLog.h)
+    struct SaveDirtyC { unsigned int mask{0}; };
+
     class Mesh;
     struct MeshRendererC
     {
@@ -58,6 +101,7 @@ namespace engine
         float rate{50.0f};
     };
 
+    // Bounding sphere radius in local space; scaled by the world matrix when culling
     struct BoundsC { float radius{1.0f}; };
 
     struct RigidBodyC
@@ -77,6 +121,9 @@ namespace engine
         float hz{0.5f};
     };
 
+    // Instance of a prefab (see Prefab.h); components it lacks are read from the prefab
+    struct PrefabC { unsigned int id{0}; };
+
     struct PhysActorC
     {
         void* actor{nullptr}; // runtime PhysX actor pointer (not serialized)
@@ -87,6 +134,12 @@ namespace engine
         entt::registry registry;
         entt::entity selected{entt::null};
 
+        ECS()
+        {
+            connectTransformTracking(registry);
+            connectSpatialTracking(registry);
+        }
+
         entt::entity createEntity(const std::string& name)
         {
             entt::entity e = registry.create();
@@ -1,11 +1,20 @@
 #include "ecs/ECSSerializer.h"
 #include "ecs/ECS.h"
+#include "ecs/Prefab.h"
 #include "core/ResourceManager.h"
+#include "core/MappedFile.h"
 
 #include <nlohmann/json.hpp>
+#include <cstdint>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 using json = nlohmann::json;
 
@@ -15,17 +24,23 @@ namespace engine
     {
         json j;
         j["position"] = { t.position.x, t.position.y, t.position.z };
-        j["rotationEuler"] = { t.rotationEuler.x, t.rotationEuler.y, t.rotationEuler.z };
+        j["rotation"] = { t.rotation.x, t.rotation.y, t.rotation.z, t.rotation.w }; // quaternion xyzw
         j["scale"] = { t.scale.x, t.scale.y, t.scale.z };
         return j;
     }
     static void jsonToTransform(const json& j, TransformC& t)
     {
         auto p = j.value("position", std::vector<float>{0,0,0});
-        auto r = j.value("rotationEuler", std::vector<float>{0,0,0});
         auto s = j.value("scale", std::vector<float>{1,1,1});
         t.position = { p[0], p[1], p[2] };
-        t.rotationEuler = { r[0], r[1], r[2] };
+        auto q = j.value("rotation", std::vector<float>{});
+        if (q.size() == 4) t.rotation = glm::quat(q[3], q[0], q[1], q[2]);
+        else
+        {
+            // scenes saved before quaternion storage
+            auto r = j.value("rotationEuler", std::vector<float>{0,0,0});
+            t.setEuler({ r[0], r[1], r[2] });
+        }
         t.scale = { s[0], s[1], s[2] };
     }
     static json meshRendererToJson(const MeshRendererC& mr)
@@ -100,37 +115,45 @@ namespace engine
         bc.hx = h[0]; bc.hy = h[1]; bc.hz = h[2];
     }
 
-    bool ECSSerializer::save(ECS& ecs, const std::string& path)
+    bool ECSSerializer::saveJson(ECS& ecs, const std::string& path)
     {
         json root; root["entities"] = json::array();
         auto& reg = ecs.registry;
         auto view = reg.view<TagC>();
+        // parents are stored as indices into the entities array
+        std::unordered_map<entt::entity, int> index;
+        for (auto e : view) index.emplace(e, (int)index.size());
         for (auto e : view)
         {
             json je;
             je["name"] = view.get<TagC>(e).name;
+            entt::entity parent = parentOf(reg, e);
+            if (parent != entt::null && index.count(parent)) je["parent"] = index[parent];
             if (auto tr = reg.try_get<TransformC>(e)) je["transform"] = transformToJson(*tr);
-            if (auto mr = reg.try_get<MeshRendererC>(e)) je["meshRenderer"] = meshRendererToJson(*mr);
+            // prefab instances are written flattened, with the shared components resolved
+            if (auto mr = resolveComponent<MeshRendererC>(reg, e)) je["meshRenderer"] = meshRendererToJson(*mr);
             if (auto dl = reg.try_get<DirectionalLightC>(e)) je["dirLight"] = dirLightToJson(*dl);
             if (auto pl = reg.try_get<PointLightC>(e)) je["pointLight"] = pointLightToJson(*pl);
             if (auto sl = reg.try_get<SpotLightC>(e)) je["spotLight"] = spotLightToJson(*sl);
             if (auto pe = reg.try_get<ParticleEmitterC>(e)) je["particle"] = particleToJson(*pe);
-            if (auto rb = reg.try_get<RigidBodyC>(e)) je["rigidBody"] = rigidBodyToJson(*rb);
-            if (auto bc = reg.try_get<BoxColliderC>(e)) je["boxCollider"] = boxColliderToJson(*bc);
+            if (auto rb = resolveComponent<RigidBodyC>(reg, e)) je["rigidBody"] = rigidBodyToJson(*rb);
+            if (auto bc = resolveComponent<BoxColliderC>(reg, e)) je["boxCollider"] = boxColliderToJson(*bc);
             root["entities"].push_back(std::move(je));
         }
         std::ofstream f(path, std::ios::binary); if (!f) return false; f << root.dump(2); return true;
     }
 
-    bool ECSSerializer::load(ECS& ecs, const std::string& path, ResourceManager* resources)
+    bool ECSSerializer::loadJson(ECS& ecs, const std::string& path, ResourceManager* resources)
     {
         std::ifstream f(path, std::ios::binary); if (!f) return false; json root; f >> root;
         ecs.registry.clear();
         if (!root.contains("entities")) return true;
+        std::vector<entt::entity> created;
         for (const auto& je : root["entities"])
         {
             std::string name = je.value("name", std::string("Entity"));
             entt::entity e = ecs.registry.create();
+            created.push_back(e);
             ecs.registry.emplace<TagC>(e, name);
             ecs.registry.emplace<TransformC>(e);
             if (je.contains("transform")) jsonToTransform(je["transform"], ecs.registry.get<TransformC>(e));
@@ -142,9 +165,483 @@ namespace engine
             if (je.contains("rigidBody")) { auto& rb = ecs.registry.emplace<RigidBodyC>(e); jsonToRigidBody(je["rigidBody"], rb); }
             if (je.contains("boxCollider")) { auto& bc = ecs.registry.emplace<BoxColliderC>(e); jsonToBoxCollider(je["boxCollider"], bc); }
         }
+        // second pass: parents may come later in the array
+        const auto& entities = root["entities"];
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            int p = entities[i].value("parent", -1);
+            if (p >= 0 && p < (int)created.size()) setParent(ecs.registry, created[i], created[p]);
+        }
         return true;
     }
-}
 
+    // ---- Binary format -------------------------------------------------------------
+    // FileHeader, then chunks. Each chunk: ChunkHeader, then its columns, each column
+    // padded to 4 bytes and the chunk to 8. Component chunks start with a column of
+    // entity indices (u32) followed by one column per field. Little-endian only.
+    static const uint32_t kBinaryMagic = 0x42534345; // "ECSB"
+    static const uint32_t kBinaryVersion = 1;
+    static const uint32_t kNoString = 0xFFFFFFFFu;
+
+    static constexpr uint32_t fourcc(char a, char b, char c, char d)
+    {
+        return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+    }
+    static const uint32_t kChunkEntityIds = fourcc('E','I','D','S'); // u32 entity id per entity (recreated as is)
+    static const uint32_t kChunkStrings   = fourcc('S','T','R','S'); // count strings: u32 offsets[count+1], chars
+    static const uint32_t kChunkTags      = fourcc('T','A','G','S'); // u32 name string per entity
+    static const uint32_t kChunkParents   = fourcc('P','R','N','T'); // i32 parent index per entity
+    static const uint32_t kChunkTransform = fourcc('X','F','R','M'); // vec3 position, quat rotation, vec3 scale
+    static const uint32_t kChunkMesh      = fourcc('M','E','S','H'); // u8 usePBR, u32 material path string
+    static const uint32_t kChunkDirLight  = fourcc('D','L','I','T'); // vec3 color, f intensity, vec3 direction
+    static const uint32_t kChunkPointLight= fourcc('P','L','I','T'); // vec3 color, f intensity, f range
+    static const uint32_t kChunkSpotLight = fourcc('S','L','I','T'); // vec3 color, f intensity, vec3 dir, f inner/outer/near/far
+    static const uint32_t kChunkParticle  = fourcc('P','E','M','T'); // u8 emit, f rate
+    static const uint32_t kChunkRigidBody = fourcc('R','B','D','Y'); // u8 static, u8 kinematic, f mass/friction/restitution
+    static const uint32_t kChunkCollider  = fourcc('B','O','X','C'); // vec3 half extents
+
+    struct BinFileHeader { uint32_t magic; uint32_t version; uint32_t entityCount; uint32_t chunkCount; };
+    struct BinChunkHeader { uint32_t id; uint32_t count; uint64_t bytes; };
+    static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::quat) == 16, "packed glm types expected");
+
+    struct BinWriter
+    {
+        std::vector<uint8_t> buf;
+        uint32_t chunks = 0;
+
+        void raw(const void* p, size_t n) { const uint8_t* b = (const uint8_t*)p; buf.insert(buf.end(), b, b + n); }
+        void align(size_t a) { buf.resize((buf.size() + a - 1) / a * a, 0); }
+        template<typename T> void column(const std::vector<T>& v) { raw(v.data(), v.size() * sizeof(T)); align(4); }
+        size_t beginChunk(uint32_t id, uint32_t count)
+        {
+            align(8);
+            size_t at = buf.size();
+            BinChunkHeader h{ id, count, 0 };
+            raw(&h, sizeof(h));
+            ++chunks;
+            return at;
+        }
+        void endChunk(size_t at)
+        {
+            align(8);
+            uint64_t bytes = buf.size() - at - sizeof(BinChunkHeader);
+            std::memcpy(buf.data() + at + offsetof(BinChunkHeader, bytes), &bytes, sizeof(bytes));
+        }
+    };
+
+    struct BinStrings
+    {
+        std::vector<std::string> list;
+        std::unordered_map<std::string, uint32_t> ids;
+        uint32_t id(const std::string& s)
+        {
+            auto it = ids.find(s);
+            if (it != ids.end()) return it->second;
+            uint32_t i = (uint32_t)list.size();
+            list.push_back(s);
+            ids.emplace(s, i);
+            return i;
+        }
+    };
+
+    // Entity index column + component pointers for all saved entities having T (own or from their prefab)
+    template<typename T>
+    static void collectComponent(entt::registry& reg, const std::vector<entt::entity>& order, std::vector<uint32_t>& ents, std::vector<const T*>& comps)
+    {
+        for (uint32_t i = 0; i < (uint32_t)order.size(); ++i)
+            if (const T* c = resolveComponent<T>(reg, order[i])) { ents.push_back(i); comps.push_back(c); }
+    }
+
+    template<typename T, typename F>
+    static std::vector<F> fieldColumn(const std::vector<const T*>& comps, F T::*field)
+    {
+        std::vector<F> out(comps.size());
+        for (size_t i = 0; i < comps.size(); ++i) out[i] = comps[i]->*field;
+        return out;
+    }
+
+    template<typename T, typename F>
+    static std::vector<uint8_t> flagColumn(const std::vector<const T*>& comps, F T::*field)
+    {
+        std::vector<uint8_t> out(comps.size());
+        for (size_t i = 0; i < comps.size(); ++i) out[i] = (comps[i]->*field) ? 1 : 0;
+        return out;
+    }
+
+    // Writes one component chunk; columns(w, comps) appends the field columns
+    template<typename T, typename Columns>
+    static void writeComponentChunk(BinWriter& w, entt::registry& reg, const std::vector<entt::entity>& order, uint32_t id, Columns&& columns)
+    {
+        std::vector<uint32_t> ents;
+        std::vector<const T*> comps;
+        collectComponent<T>(reg, order, ents, comps);
+        if (ents.empty()) return;
+        size_t at = w.beginChunk(id, (uint32_t)ents.size());
+        w.column(ents);
+        columns(w, comps);
+        w.endChunk(at);
+    }
+
+    bool ECSSerializer::saveBinary(ECS& ecs, const std::string& path)
+    {
+        auto& reg = ecs.registry;
+        auto view = reg.view<TagC>();
+        std::vector<entt::entity> order(view.begin(), view.end());
+        const uint32_t count = (uint32_t)order.size();
+        // entity -> saved index, by entity slot
+        std::vector<int> indexOf;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            size_t slot = (size_t)entt::to_entity(order[i]);
+            if (indexOf.size() <= slot) indexOf.resize(slot + 1, -1);
+            indexOf[slot] = (int)i;
+        }
+
+        BinStrings strings;
+        std::vector<uint32_t> tags(count);
+        std::vector<int32_t> parents(count, -1);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            tags[i] = strings.id(view.get<TagC>(order[i]).name);
+            entt::entity p = parentOf(reg, order[i]);
+            if (p != entt::null && reg.valid(p) && (size_t)entt::to_entity(p) < indexOf.size())
+                parents[i] = indexOf[(size_t)entt::to_entity(p)];
+        }
+        std::vector<uint32_t> materialPaths;
+        {
+            std::vector<uint32_t> ents; std::vector<const MeshRendererC*> comps;
+            collectComponent<MeshRendererC>(reg, order, ents, comps);
+            for (auto* mr : comps) materialPaths.push_back(mr->materialPath.empty() ? kNoString : strings.id(mr->materialPath));
+        }
+
+        BinWriter w;
+        w.buf.reserve((size_t)count * 96 + 1024);
+        BinFileHeader header{ kBinaryMagic, kBinaryVersion, count, 0 };
+        w.raw(&header, sizeof(header));
+
+        // entity ids first, so delta logs keyed by id replay onto the loaded scene
+        {
+            std::vector<uint32_t> ids(count);
+            for (uint32_t i = 0; i < count; ++i) ids[i] = (uint32_t)entt::to_integral(order[i]);
+            size_t at = w.beginChunk(kChunkEntityIds, count);
+            w.column(ids);
+            w.endChunk(at);
+        }
+        // string table next: later chunks refer to it
+        {
+            size_t at = w.beginChunk(kChunkStrings, (uint32_t)strings.list.size());
+            std::vector<uint32_t> offsets{ 0 };
+            for (const auto& s : strings.list) offsets.push_back(offsets.back() + (uint32_t)s.size());
+            w.column(offsets);
+            for (const auto& s : strings.list) w.raw(s.data(), s.size());
+            w.endChunk(at);
+        }
+        { size_t at = w.beginChunk(kChunkTags, count); w.column(tags); w.endChunk(at); }
+        { size_t at = w.beginChunk(kChunkParents, count); w.column(parents); w.endChunk(at); }
+        writeComponentChunk<TransformC>(w, reg, order, kChunkTransform, [](BinWriter& w, const std::vector<const TransformC*>& c) {
+            w.column(fieldColumn(c, &TransformC::position));
+            w.column(fieldColumn(c, &TransformC::rotation));
+            w.column(fieldColumn(c, &TransformC::scale));
+        });
+        writeComponentChunk<MeshRendererC>(w, reg, order, kChunkMesh, [&](BinWriter& w, const std::vector<const MeshRendererC*>& c) {
+            w.column(flagColumn(c, &MeshRendererC::usePBR));
+            w.column(materialPaths);
+        });
+        writeComponentChunk<DirectionalLightC>(w, reg, order, kChunkDirLight, [](BinWriter& w, const std::vector<const DirectionalLightC*>& c) {
+            w.column(fieldColumn(c, &DirectionalLightC::color));
+            w.column(fieldColumn(c, &DirectionalLightC::intensity));
+            w.column(fieldColumn(c, &DirectionalLightC::direction));
+        });
+        writeComponentChunk<PointLightC>(w, reg, order, kChunkPointLight, [](BinWriter& w, const std::vector<const PointLightC*>& c) {
+            w.column(fieldColumn(c, &PointLightC::color));
+            w.column(fieldColumn(c, &PointLightC::intensity));
+            w.column(fieldColumn(c, &PointLightC::range));
+        });
+        writeComponentChunk<SpotLightC>(w, reg, order, kChunkSpotLight, [](BinWriter& w, const std::vector<const SpotLightC*>& c) {
+            w.column(fieldColumn(c, &SpotLightC::color));
+            w.column(fieldColumn(c, &SpotLightC::intensity));
+            w.column(fieldColumn(c, &SpotLightC::direction));
+            w.column(fieldColumn(c, &SpotLightC::innerDegrees));
+            w.column(fieldColumn(c, &SpotLightC::outerDegrees));
+            w.column(fieldColumn(c, &SpotLightC::nearPlane));
+            w.column(fieldColumn(c, &SpotLightC::farPlane));
+        });
+        writeComponentChunk<ParticleEmitterC>(w, reg, order, kChunkParticle, [](BinWriter& w, const std::vector<const ParticleEmitterC*>& c) {
+            w.column(flagColumn(c, &ParticleEmitterC::emit));
+            w.column(fieldColumn(c, &ParticleEmitterC::rate));
+        });
+        writeComponentChunk<RigidBodyC>(w, reg, order, kChunkRigidBody, [](BinWriter& w, const std::vector<const RigidBodyC*>& c) {
+            w.column(flagColumn(c, &RigidBodyC::isStatic));
+            w.column(flagColumn(c, &RigidBodyC::isKinematic));
+            w.column(fieldColumn(c, &RigidBodyC::mass));
+            w.column(fieldColumn(c, &RigidBodyC::friction));
+            w.column(fieldColumn(c, &RigidBodyC::restitution));
+        });
+        writeComponentChunk<BoxColliderC>(w, reg, order, kChunkCollider, [](BinWriter& w, const std::vector<const BoxColliderC*>& c) {
+            w.column(fieldColumn(c, &BoxColliderC::hx));
+            w.column(fieldColumn(c, &BoxColliderC::hy));
+            w.column(fieldColumn(c, &BoxColliderC::hz));
+        });
 
+        header.chunkCount = w.chunks;
+        std::memcpy(w.buf.data(), &header, sizeof(header));
+        std::ofstream f(path, std::ios::binary);
+        if (!f) { std::cerr << "[ECSSerializer] cannot write " << path << std::endl; return false; }
+        f.write((const char*)w.buf.data(), (std::streamsize)w.buf.size());
+        return (bool)f;
+    }
 
+    // Bounds-checked cursor over one mapped chunk
+    struct BinReader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool ok = true;
+
+        template<typename T> bool column(uint32_t count, std::vector<T>& out)
+        {
+            size_t n = (size_t)count * sizeof(T);
+            size_t padded = (n + 3) & ~size_t(3);
+            if ((size_t)(end - p) < padded) { ok = false; return false; }
+            out.resize(count);
+            if (n) std::memcpy(out.data(), p, n);
+            p += padded;
+            return true;
+        }
+        template<typename T> bool flags(uint32_t count, std::vector<T>& out)
+        {
+            std::vector<uint8_t> raw;
+            if (!column(count, raw)) return false;
+            out.assign(raw.begin(), raw.end());
+            return true;
+        }
+    };
+
+    // Inserts count components built by make(i) on the entities listed in the chunk; false for an
+    // index out of range or listed twice (EnTT must not insert T on an entity that has it)
+    template<typename T, typename Make>
+    static bool insertComponents(entt::registry& reg, const std::vector<entt::entity>& created, const std::vector<uint32_t>& ents, Make&& make)
+    {
+        std::vector<entt::entity> targets;
+        std::vector<T> values;
+        std::vector<uint8_t> seen(created.size(), 0);
+        targets.reserve(ents.size());
+        values.reserve(ents.size());
+        for (size_t i = 0; i < ents.size(); ++i)
+        {
+            if (ents[i] >= created.size() || seen[ents[i]]) return false;
+            seen[ents[i]] = 1;
+            targets.push_back(created[ents[i]]);
+            values.push_back(make(i));
+        }
+        reg.insert<T>(targets.begin(), targets.end(), values.begin());
+        return true;
+    }
+
+    bool ECSSerializer::loadBinary(ECS& ecs, const std::string& path, ResourceManager* resources)
+    {
+        MappedFile file;
+        if (!file.open(path)) { std::cerr << "[ECSSerializer] cannot open " << path << std::endl; return false; }
+        BinFileHeader header;
+        if (file.size() < sizeof(header)) return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != kBinaryMagic) { std::cerr << "[ECSSerializer] not a binary ECS scene: " << path << std::endl; return false; }
+        if (header.version > kBinaryVersion) { std::cerr << "[ECSSerializer] unsupported version " << header.version << ": " << path << std::endl; return false; }
+
+        // every entity has at least a 4-byte tag entry, so a count the file cannot hold is corrupt
+        const uint32_t count = header.entityCount;
+        if ((uint64_t)count * sizeof(uint32_t) > file.size() - sizeof(header))
+        {
+            std::cerr << "[ECSSerializer] entity count " << count << " exceeds file size: " << path << std::endl;
+            return false;
+        }
+        auto& reg = ecs.registry;
+        reg.clear();
+        std::vector<entt::entity> created;
+        // entities come from the EIDS chunk when present, otherwise fresh ones before the first other chunk
+        auto ensureCreated = [&]() {
+            if (created.size() == count) return;
+            created.resize(count);
+            reg.create(created.begin(), created.end());
+        };
+
+        std::vector<std::string> strings;
+        auto str = [&strings](uint32_t id) { return id < strings.size() ? strings[id] : std::string(); };
+        std::vector<TransformC> transforms(count);
+        std::vector<int32_t> parents;
+        bool ok = true;
+
+        // the writer emits each chunk id once; a repeat would insert its components twice
+        std::unordered_set<uint32_t> chunkIds;
+        const uint8_t* p = file.data() + sizeof(header);
+        const uint8_t* end = file.data() + file.size();
+        for (uint32_t c = 0; c < header.chunkCount && ok; ++c)
+        {
+            p = file.data() + (((size_t)(p - file.data()) + 7) & ~size_t(7));
+            BinChunkHeader ch;
+            if ((size_t)(end - p) < sizeof(ch)) { ok = false; break; }
+            std::memcpy(&ch, p, sizeof(ch));
+            p += sizeof(ch);
+            if ((uint64_t)(end - p) < ch.bytes) { ok = false; break; }
+            BinReader r{ p, p + ch.bytes };
+            p += ch.bytes;
+            if (!chunkIds.insert(ch.id).second) { ok = false; break; }
+
+            std::vector<uint32_t> ents;
+            const bool perEntity = ch.id == kChunkTags || ch.id == kChunkParents || ch.id == kChunkEntityIds;
+            if (perEntity && ch.count != count) { ok = false; break; }
+            if (ch.id == kChunkEntityIds && created.empty())
+            {
+                std::vector<uint32_t> ids;
+                if (!r.column(count, ids)) { ok = false; break; }
+                created.reserve(count);
+                for (uint32_t id : ids) created.push_back(reg.create(entt::entity{ (entt::id_type)id }));
+                continue;
+            }
+            ensureCreated();
+            if (ch.id == kChunkStrings)
+            {
+                std::vector<uint32_t> offsets;
+                if (ch.count == UINT32_MAX || !r.column(ch.count + 1, offsets)) { ok = false; break; }
+                // offsets must rise and stay inside the chunk's string bytes
+                const size_t avail = (size_t)(r.end - r.p);
+                for (uint32_t i = 0; i < ch.count && ok; ++i)
+                    ok = offsets[i] <= offsets[i + 1] && offsets[i + 1] <= avail;
+                if (!ok) break;
+                strings.resize(ch.count);
+                for (uint32_t i = 0; i < ch.count; ++i)
+                    strings[i].assign((const char*)r.p + offsets[i], offsets[i + 1] - offsets[i]);
+            }
+            else if (ch.id == kChunkTags)
+            {
+                std::vector<uint32_t> names;
+                if (!r.column(count, names)) { ok = false; break; }
+                std::vector<TagC> tags(count);
+                for (uint32_t i = 0; i < count; ++i) tags[i].name = str(names[i]);
+                reg.insert<TagC>(created.begin(), created.end(), tags.begin());
+            }
+            else if (ch.id == kChunkParents)
+            {
+                ok = r.column(count, parents);
+            }
+            else if (ch.id == kChunkTransform)
+            {
+                std::vector<glm::vec3> pos, scl; std::vector<glm::quat> rot;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, pos) || !r.column(ch.count, rot) || !r.column(ch.count, scl)) { ok = false; break; }
+                for (uint32_t i = 0; i < ch.count; ++i)
+                {
+                    if (ents[i] >= count) { ok = false; break; }
+                    TransformC& t = transforms[ents[i]];
+                    t.position = pos[i]; t.rotation = rot[i]; t.scale = scl[i];
+                }
+            }
+            else if (ch.id == kChunkMesh)
+            {
+                std::vector<uint8_t> pbr; std::vector<uint32_t> mats;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, pbr) || !r.column(ch.count, mats)) { ok = false; break; }
+                // resolve each distinct material path once
+                std::unordered_map<uint32_t, MaterialAsset*> resolved;
+                ok = insertComponents<MeshRendererC>(reg, created, ents, [&](size_t i) {
+                    MeshRendererC mr;
+                    mr.usePBR = pbr[i] != 0;
+                    if (mats[i] == kNoString) return mr;
+                    mr.materialPath = str(mats[i]);
+                    auto it = resolved.find(mats[i]);
+                    if (it == resolved.end()) it = resolved.emplace(mats[i], resources ? resources->getMaterialFromFile(mr.materialPath) : nullptr).first;
+                    if (MaterialAsset* mat = it->second)
+                    {
+                        mr.material = mat;
+                        if (mat->albedoTex) mr.albedoTex = mat->albedoTex;
+                        mr.usePBR = true;
+                    }
+                    return mr;
+                });
+            }
+            else if (ch.id == kChunkDirLight)
+            {
+                std::vector<glm::vec3> color, dir; std::vector<float> intensity;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, color) || !r.column(ch.count, intensity) || !r.column(ch.count, dir)) { ok = false; break; }
+                ok = insertComponents<DirectionalLightC>(reg, created, ents, [&](size_t i) { return DirectionalLightC{ color[i], intensity[i], dir[i] }; });
+            }
+            else if (ch.id == kChunkPointLight)
+            {
+                std::vector<glm::vec3> color; std::vector<float> intensity, range;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, color) || !r.column(ch.count, intensity) || !r.column(ch.count, range)) { ok = false; break; }
+                ok = insertComponents<PointLightC>(reg, created, ents, [&](size_t i) { return PointLightC{ color[i], intensity[i], range[i] }; });
+            }
+            else if (ch.id == kChunkSpotLight)
+            {
+                std::vector<glm::vec3> color, dir; std::vector<float> intensity, inner, outer, nearP, farP;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, color) || !r.column(ch.count, intensity) || !r.column(ch.count, dir)
+                    || !r.column(ch.count, inner) || !r.column(ch.count, outer) || !r.column(ch.count, nearP) || !r.column(ch.count, farP)) { ok = false; break; }
+                ok = insertComponents<SpotLightC>(reg, created, ents, [&](size_t i) {
+                    SpotLightC sl;
+                    sl.color = color[i]; sl.intensity = intensity[i]; sl.direction = dir[i];
+                    sl.innerDegrees = inner[i]; sl.outerDegrees = outer[i]; sl.nearPlane = nearP[i]; sl.farPlane = farP[i];
+                    return sl;
+                });
+            }
+            else if (ch.id == kChunkParticle)
+            {
+                std::vector<uint8_t> emit; std::vector<float> rate;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, emit) || !r.column(ch.count, rate)) { ok = false; break; }
+                ok = insertComponents<ParticleEmitterC>(reg, created, ents, [&](size_t i) { return ParticleEmitterC{ emit[i] != 0, rate[i] }; });
+            }
+            else if (ch.id == kChunkRigidBody)
+            {
+                std::vector<uint8_t> isStatic, isKinematic; std::vector<float> mass, friction, restitution;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, isStatic) || !r.column(ch.count, isKinematic)
+                    || !r.column(ch.count, mass) || !r.column(ch.count, friction) || !r.column(ch.count, restitution)) { ok = false; break; }
+                ok = insertComponents<RigidBodyC>(reg, created, ents, [&](size_t i) {
+                    return RigidBodyC{ isStatic[i] != 0, isKinematic[i] != 0, mass[i], friction[i], restitution[i] };
+                });
+            }
+            else if (ch.id == kChunkCollider)
+            {
+                std::vector<float> hx, hy, hz;
+                if (!r.column(ch.count, ents) || !r.column(ch.count, hx) || !r.column(ch.count, hy) || !r.column(ch.count, hz)) { ok = false; break; }
+                ok = insertComponents<BoxColliderC>(reg, created, ents, [&](size_t i) { return BoxColliderC{ hx[i], hy[i], hz[i] }; });
+            }
+            // unknown chunks (newer minor additions) are skipped
+            ok = ok && r.ok;
+        }
+        if (!ok)
+        {
+            std::cerr << "[ECSSerializer] corrupt binary scene: " << path << std::endl;
+            reg.clear();
+            return false;
+        }
+
+        ensureCreated();
+        // every entity gets a TransformC, as with JSON
+        reg.insert<TransformC>(created.begin(), created.end(), transforms.begin());
+        for (uint32_t i = 0; i < (uint32_t)parents.size(); ++i)
+            if (parents[i] >= 0 && parents[i] < (int32_t)count) setParent(reg, created[i], created[parents[i]]);
+        return true;
+    }
+
+    static bool hasExtension(const std::string& path, const char* ext)
+    {
+        size_t n = std::strlen(ext);
+        if (path.size() < n) return false;
+        for (size_t i = 0; i < n; ++i)
+            if (std::tolower((unsigned char)path[path.size() - n + i]) != ext[i]) return false;
+        return true;
+    }
+
+    bool ECSSerializer::save(ECS& ecs, const std::string& path)
+    {
+        return hasExtension(path, ".json") ? saveJson(ecs, path) : saveBinary(ecs, path);
+    }
+
+    bool ECSSerializer::load(ECS& ecs, const std::string& path, ResourceManager* resources)
+    {
+        uint32_t magic = 0;
+        {
+            std::ifstream f(path, std::ios::binary);
+            if (!f) return false;
+            f.read((char*)&magic, sizeof(magic));
+        }
+        return magic == kBinaryMagic ? loadBinary(ecs, path, resources) : loadJson(ecs, path, resources);
+    }
+}
@@ -7,14 +7,20 @@ namespace engine
     class ResourceManager;
     struct ECS;
 
-    // JSON tabanli ECS sahne kaydet/yukle
+    // ECS scene save/load. The binary format (.ecsb) is versioned and stores one columnar
+    // chunk per component type; it is memory-mapped and bulk-inserted on load. JSON is
+    // kept as a readable export.
     class ECSSerializer
     {
     public:
+        // .json paths are written as JSON, anything else as binary
         static bool save(ECS& ecs, const std::string& path);
+        // format detected from the file header
         static bool load(ECS& ecs, const std::string& path, ResourceManager* resources);
+
+        static bool saveJson(ECS& ecs, const std::string& path);
+        static bool loadJson(ECS& ecs, const std::string& path, ResourceManager* resources);
+        static bool saveBinary(ECS& ecs, const std::string& path);
+        static bool loadBinary(ECS& ecs, const std::string& path, ResourceManager* resources);
     };
 }
-
-
-
@@ -0,0 +1,80 @@
+#include "ecs/Prefab.h"
+
+namespace engine
+{
+    struct PrefabLibrary
+    {
+        std::vector<Prefab> prefabs; // indexed by id
+    };
+
+    unsigned int registerPrefab(entt::registry& reg, Prefab prefab)
+    {
+        auto& lib = reg.ctx().contains<PrefabLibrary>() ? reg.ctx().get<PrefabLibrary>() : reg.ctx().emplace<PrefabLibrary>();
+        lib.prefabs.push_back(std::move(prefab));
+        return (unsigned int)lib.prefabs.size() - 1;
+    }
+
+    const Prefab* findPrefab(const entt::registry& reg, unsigned int id)
+    {
+        const auto* lib = reg.ctx().find<PrefabLibrary>();
+        return lib && id < lib->prefabs.size() ? &lib->prefabs[id] : nullptr;
+    }
+
+    const Prefab* findPrefab(const entt::registry& reg, const std::string& name, unsigned int* id)
+    {
+        const auto* lib = reg.ctx().find<PrefabLibrary>();
+        if (!lib) return nullptr;
+        for (size_t i = 0; i < lib->prefabs.size(); ++i)
+        {
+            if (lib->prefabs[i].name != name) continue;
+            if (id) *id = (unsigned int)i;
+            return &lib->prefabs[i];
+        }
+        return nullptr;
+    }
+
+    const Prefab* prefabOf(const entt::registry& reg, entt::entity e)
+    {
+        const auto* pc = reg.try_get<PrefabC>(e);
+        return pc ? findPrefab(reg, pc->id) : nullptr;
+    }
+
+    int prefabCount(const entt::registry& reg)
+    {
+        const auto* lib = reg.ctx().find<PrefabLibrary>();
+        return lib ? (int)lib->prefabs.size() : 0;
+    }
+
+    template<typename T>
+    static void reservePool(entt::registry& reg, size_t extra)
+    {
+        auto& pool = reg.storage<T>();
+        pool.reserve(pool.size() + extra);
+    }
+
+    void instantiatePrefab(entt::registry& reg, unsigned int id, size_t count, const TransformC* transforms,
+        std::vector<entt::entity>* created)
+    {
+        const Prefab* prefab = findPrefab(reg, id);
+        if (!prefab || count == 0) return;
+        std::vector<entt::entity> local;
+        std::vector<entt::entity>& ents = created ? *created : local;
+        const size_t first = ents.size();
+        ents.resize(first + count);
+        auto begin = ents.begin() + first;
+        reg.create(begin, ents.end());
+
+        reservePool<TagC>(reg, count);
+        reservePool<PrefabC>(reg, count);
+        reservePool<TransformC>(reg, count);
+        reservePool<WorldMatrixC>(reg, count);
+        reservePool<TransformDirtyC>(reg, count);
+        reg.insert<TagC>(begin, ents.end(), TagC{ prefab->name });
+        reg.insert<PrefabC>(begin, ents.end(), PrefabC{ id });
+        // matrix and dirty flag up front: the TransformC construct hook then has nothing to add
+        reg.insert<WorldMatrixC>(begin, ents.end());
+        reg.insert<TransformDirtyC>(begin, ents.end());
+        if (transforms) reg.insert<TransformC>(begin, ents.end(), transforms);
+        else reg.insert<TransformC>(begin, ents.end());
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <entt/entt.hpp>
+#include "ecs/ECS.h"
+
+namespace engine
+{
+    // Component data shared by all instances of a prefab. An instance (PrefabC) that has
+    // no component of its own reads the prefab's; writing goes through overrideComponent(),
+    // which gives the instance its own copy. Prefabs live in the registry context.
+    struct Prefab
+    {
+        std::string name;
+        std::optional<MeshRendererC> meshRenderer;
+        std::optional<RigidBodyC> rigidBody;
+        std::optional<BoxColliderC> boxCollider;
+    };
+
+    // Returns the prefab id (stable for the registry's lifetime)
+    unsigned int registerPrefab(entt::registry& reg, Prefab prefab);
+    const Prefab* findPrefab(const entt::registry& reg, unsigned int id);
+    const Prefab* findPrefab(const entt::registry& reg, const std::string& name, unsigned int* id = nullptr);
+    const Prefab* prefabOf(const entt::registry& reg, entt::entity e);
+    int prefabCount(const entt::registry& reg);
+
+    // Creates count instances in one pass per pool: TagC (prefab name), TransformC from
+    // transforms (identity if null) and PrefabC. Shared components are not copied.
+    void instantiatePrefab(entt::registry& reg, unsigned int id, size_t count, const TransformC* transforms,
+        std::vector<entt::entity>* created = nullptr);
+
+    template<typename T> const std::optional<T>* sharedSlot(const Prefab&) { return nullptr; }
+    template<> inline const std::optional<MeshRendererC>* sharedSlot<MeshRendererC>(const Prefab& p) { return &p.meshRenderer; }
+    template<> inline const std::optional<RigidBodyC>* sharedSlot<RigidBodyC>(const Prefab& p) { return &p.rigidBody; }
+    template<> inline const std::optional<BoxColliderC>* sharedSlot<BoxColliderC>(const Prefab& p) { return &p.boxCollider; }
+
+    // The entity's own T, else its prefab's, else null
+    template<typename T>
+    const T* resolveComponent(const entt::registry& reg, entt::entity e)
+    {
+        if (const T* own = reg.try_get<T>(e)) return own;
+        const Prefab* prefab = prefabOf(reg, e);
+        if (!prefab) return nullptr;
+        const std::optional<T>* slot = sharedSlot<T>(*prefab);
+        return slot && slot->has_value() ? &**slot : nullptr;
+    }
+
+    // Copy-on-write: gives e its own T (copied from the prefab, or default) and returns it
+    template<typename T>
+    T& overrideComponent(entt::registry& reg, entt::entity e)
+    {
+        if (T* own = reg.try_get<T>(e)) return *own;
+        const T* shared = resolveComponent<T>(reg, e);
+        return reg.emplace<T>(e, shared ? *shared : T{});
+    }
+
+    // Drops e's own T so it reads the prefab's again; false if e is not an instance
+    template<typename T>
+    bool revertOverride(entt::registry& reg, entt::entity e)
+    {
+        if (!reg.all_of<PrefabC>(e)) return false;
+        reg.remove<T>(e);
+        return true;
+    }
+}
@@ -0,0 +1,503 @@
+#include "ecs/SceneDeltaLog.h"
+#include "ecs/ECS.h"
+#include "ecs/ECSSerializer.h"
+#include "ecs/Prefab.h"
+#include "core/ResourceManager.h"
+#include "core/MappedFile.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace engine
+{
+    // Entities whose saved components were removed, or which were destroyed, since the
+    // last checkpoint. Destroy hooks only record here: emplacing during destruction is unsafe.
+    struct SaveTrackingState
+    {
+        std::vector<entt::entity> touched;
+    };
+
+    template<unsigned int Bit>
+    static void onSavedChanged(entt::registry& reg, entt::entity e)
+    {
+        reg.get_or_emplace<SaveDirtyC>(e).mask |= Bit;
+    }
+
+    static void onSavedRemoved(entt::registry& reg, entt::entity e)
+    {
+        reg.ctx().get<SaveTrackingState>().touched.push_back(e);
+    }
+
+    template<typename T, unsigned int Bit>
+    static void trackSaved(entt::registry& reg)
+    {
+        reg.on_construct<T>().template connect<&onSavedChanged<Bit>>();
+        reg.on_update<T>().template connect<&onSavedChanged<Bit>>();
+        reg.on_destroy<T>().template connect<&onSavedRemoved>();
+    }
+
+    void connectSaveTracking(entt::registry& reg)
+    {
+        if (reg.ctx().contains<SaveTrackingState>()) return;
+        reg.ctx().emplace<SaveTrackingState>();
+        trackSaved<TagC, SaveTag>(reg);
+        trackSaved<TransformC, SaveTransform>(reg);
+        trackSaved<MeshRendererC, SaveMesh>(reg);
+        trackSaved<DirectionalLightC, SaveDirLight>(reg);
+        trackSaved<PointLightC, SavePointLight>(reg);
+        trackSaved<SpotLightC, SaveSpotLight>(reg);
+        trackSaved<ParticleEmitterC, SaveParticle>(reg);
+        trackSaved<RigidBodyC, SaveRigidBody>(reg);
+        trackSaved<BoxColliderC, SaveCollider>(reg);
+        trackSaved<PrefabC, SaveAll>(reg);
+    }
+
+    static void resetSaveTracking(entt::registry& reg)
+    {
+        reg.clear<SaveDirtyC>();
+        reg.ctx().get<SaveTrackingState>().touched.clear();
+    }
+
+    // ---- Log format ----------------------------------------------------------------
+    // Batches appended back to back: BatchHeader, then records. Record: u32 entity id,
+    // u16 present bits (payloads follow in bit order), u16 removed bits; removed == kDestroyed
+    // deletes the entity, removed == kClearScene (first record of a full batch) empties the
+    // registry. Records carry whole component values, so replaying twice is harmless.
+    static const uint32_t kLogMagic = 0x42544c44; // "DLTB"
+    static const uint32_t kLogVersion = 2;
+    static const uint16_t kDestroyed = 0xFFFF;
+    static const uint16_t kClearScene = 0xFFFE;
+    static const uint32_t kNoParent = 0xFFFFFFFFu;
+
+    struct BatchHeader { uint32_t magic; uint32_t version; uint32_t sequence; uint32_t records; uint64_t bytes; };
+
+    static_assert(std::is_trivially_copyable<DirectionalLightC>::value && std::is_trivially_copyable<PointLightC>::value
+        && std::is_trivially_copyable<SpotLightC>::value && std::is_trivially_copyable<ParticleEmitterC>::value
+        && std::is_trivially_copyable<RigidBodyC>::value && std::is_trivially_copyable<BoxColliderC>::value,
+        "plain components are stored as raw bytes");
+
+    struct LogWriter
+    {
+        std::vector<uint8_t> buf;
+        void raw(const void* p, size_t n) { const uint8_t* b = (const uint8_t*)p; buf.insert(buf.end(), b, b + n); }
+        template<typename T> void pod(const T& v) { raw(&v, sizeof(T)); }
+        void str(const std::string& s) { pod((uint32_t)s.size()); raw(s.data(), s.size()); }
+    };
+
+    struct LogReader
+    {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool ok = true;
+        bool raw(void* out, size_t n)
+        {
+            if (!ok || (size_t)(end - p) < n) { ok = false; return false; }
+            std::memcpy(out, p, n);
+            p += n;
+            return true;
+        }
+        template<typename T> bool pod(T& v) { return raw(&v, sizeof(T)); }
+        bool str(std::string& s)
+        {
+            uint32_t n = 0;
+            if (!pod(n) || (size_t)(end - p) < n) { ok = false; return false; }
+            s.assign((const char*)p, n);
+            p += n;
+            return true;
+        }
+    };
+
+    template<typename T>
+    static void writePod(LogWriter& w, uint16_t present, unsigned int bit, const T* c)
+    {
+        if (present & bit) w.pod(*c);
+    }
+
+    static void writeRecord(LogWriter& w, entt::registry& reg, entt::entity e, unsigned int dirty)
+    {
+        const auto* tag = reg.try_get<TagC>(e);
+        const auto* tr = reg.try_get<TransformC>(e);
+        const auto* mr = resolveComponent<MeshRendererC>(reg, e); // instances are saved flattened
+        const auto* dl = reg.try_get<DirectionalLightC>(e);
+        const auto* pl = reg.try_get<PointLightC>(e);
+        const auto* sl = reg.try_get<SpotLightC>(e);
+        const auto* pe = reg.try_get<ParticleEmitterC>(e);
+        const auto* rb = resolveComponent<RigidBodyC>(reg, e);
+        const auto* bc = resolveComponent<BoxColliderC>(reg, e);
+        unsigned int has = (tag ? SaveTag : 0u) | (tr ? SaveTransform : 0u) | (mr ? SaveMesh : 0u) | (dl ? SaveDirLight : 0u)
+            | (pl ? SavePointLight : 0u) | (sl ? SaveSpotLight : 0u) | (pe ? SaveParticle : 0u) | (rb ? SaveRigidBody : 0u) | (bc ? SaveCollider : 0u);
+        uint16_t present = (uint16_t)(dirty & has);
+        uint16_t removed = (uint16_t)(SaveAll & ~has);
+        // only tagged entities are part of the saved scene
+        if (!tag) { present = 0; removed = kDestroyed; }
+
+        w.pod((uint32_t)entt::to_integral(e));
+        w.pod(present);
+        w.pod(removed);
+        if (present & SaveTag) w.str(tag->name);
+        if (present & SaveTransform)
+        {
+            w.pod(tr->position); w.pod(tr->rotation); w.pod(tr->scale);
+            entt::entity p = parentOf(reg, e);
+            w.pod(p == entt::null ? kNoParent : (uint32_t)entt::to_integral(p));
+        }
+        if (present & SaveMesh)
+        {
+            w.pod((uint8_t)(mr->usePBR ? 1 : 0));
+            w.str(mr->materialPath);
+        }
+        writePod(w, present, SaveDirLight, dl);
+        writePod(w, present, SavePointLight, pl);
+        writePod(w, present, SaveSpotLight, sl);
+        writePod(w, present, SaveParticle, pe);
+        writePod(w, present, SaveRigidBody, rb);
+        writePod(w, present, SaveCollider, bc);
+    }
+
+    template<typename T>
+    static bool readPod(LogReader& r, entt::registry& reg, entt::entity e, uint16_t present, unsigned int bit)
+    {
+        if (!(present & bit)) return true;
+        T value;
+        if (!r.pod(value)) return false;
+        reg.emplace_or_replace<T>(e, value);
+        return true;
+    }
+
+    template<typename T>
+    static void removeIf(entt::registry& reg, entt::entity e, uint16_t removed, unsigned int bit)
+    {
+        if (removed & bit) reg.remove<T>(e);
+    }
+
+    bool SceneAutosave::replay(entt::registry& reg, const std::string& logPath, ResourceManager* resources)
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(logPath, ec) && std::filesystem::file_size(logPath, ec) == 0) return true; // just compacted
+        MappedFile file;
+        if (!file.open(logPath))
+        {
+            std::cerr << "[SceneAutosave] cannot open " << logPath << std::endl;
+            return false;
+        }
+        const uint8_t* p = file.data();
+        const uint8_t* end = p + file.size();
+        std::vector<std::pair<entt::entity, uint32_t>> parents;
+        while ((size_t)(end - p) >= sizeof(BatchHeader))
+        {
+            BatchHeader h;
+            std::memcpy(&h, p, sizeof(h));
+            if (h.magic != kLogMagic || h.version > kLogVersion || (uint64_t)(end - p - sizeof(h)) < h.bytes)
+            {
+                // torn write at the end of the log: everything before it is intact
+                std::cerr << "[SceneAutosave] ignoring incomplete batch " << h.sequence << " in " << logPath << std::endl;
+                break;
+            }
+            p += sizeof(h);
+            LogReader r{ p, p + h.bytes };
+            p += h.bytes;
+
+            parents.clear();
+            for (uint32_t i = 0; i < h.records && r.ok; ++i)
+            {
+                uint32_t id = 0; uint16_t present = 0, removed = 0;
+                if (!r.pod(id) || !r.pod(present) || !r.pod(removed)) break;
+                entt::entity e{ (entt::id_type)id };
+                if (removed == kClearScene)
+                {
+                    // a full batch supersedes the base scene and everything logged before it
+                    reg.clear();
+                    continue;
+                }
+                if (removed == kDestroyed)
+                {
+                    if (reg.valid(e)) reg.destroy(e);
+                    continue;
+                }
+                if (!reg.valid(e) && reg.create(e) != e)
+                {
+                    std::cerr << "[SceneAutosave] entity id " << id << " is taken, log does not match the base scene" << std::endl;
+                    return false;
+                }
+                if (present & SaveTag)
+                {
+                    std::string name;
+                    if (!r.str(name)) break;
+                    reg.emplace_or_replace<TagC>(e, std::move(name));
+                }
+                if (present & SaveTransform)
+                {
+                    TransformC t; uint32_t parent = kNoParent;
+                    if (!r.pod(t.position) || !r.pod(t.rotation) || !r.pod(t.scale) || !r.pod(parent)) break;
+                    reg.emplace_or_replace<TransformC>(e, t);
+                    parents.push_back({ e, parent });
+                }
+                if (present & SaveMesh)
+                {
+                    uint8_t pbr = 0; std::string path;
+                    if (!r.pod(pbr) || !r.str(path)) break;
+                    // keep the runtime mesh, only the saved fields come from the log
+                    MeshRendererC mr = reg.all_of<MeshRendererC>(e) ? reg.get<MeshRendererC>(e) : MeshRendererC{};
+                    if (path != mr.materialPath) { mr.material = nullptr; mr.albedoTex = nullptr; }
+                    mr.usePBR = pbr != 0;
+                    mr.materialPath = std::move(path);
+                    if (!mr.material && !mr.materialPath.empty() && resources)
+                    {
+                        if (MaterialAsset* mat = resources->getMaterialFromFile(mr.materialPath))
+                        {
+                            mr.material = mat;
+                            if (mat->albedoTex) mr.albedoTex = mat->albedoTex;
+                            mr.usePBR = true;
+                        }
+                    }
+                    reg.emplace_or_replace<MeshRendererC>(e, std::move(mr));
+                }
+                if (!readPod<DirectionalLightC>(r, reg, e, present, SaveDirLight)
+                    || !readPod<PointLightC>(r, reg, e, present, SavePointLight)
+                    || !readPod<SpotLightC>(r, reg, e, present, SaveSpotLight)
+                    || !readPod<ParticleEmitterC>(r, reg, e, present, SaveParticle)
+                    || !readPod<RigidBodyC>(r, reg, e, present, SaveRigidBody)
+                    || !readPod<BoxColliderC>(r, reg, e, present, SaveCollider)) break;
+                removeIf<TagC>(reg, e, removed, SaveTag);
+                removeIf<TransformC>(reg, e, removed, SaveTransform);
+                removeIf<MeshRendererC>(reg, e, removed, SaveMesh);
+                removeIf<DirectionalLightC>(reg, e, removed, SaveDirLight);
+                removeIf<PointLightC>(reg, e, removed, SavePointLight);
+                removeIf<SpotLightC>(reg, e, removed, SaveSpotLight);
+                removeIf<ParticleEmitterC>(reg, e, removed, SaveParticle);
+                removeIf<RigidBodyC>(reg, e, removed, SaveRigidBody);
+                removeIf<BoxColliderC>(reg, e, removed, SaveCollider);
+            }
+            // links last: a parent may be created later in the same batch
+            for (auto& [child, parent] : parents)
+            {
+                if (!reg.valid(child)) continue;
+                entt::entity pe = entt::null;
+                if (parent != kNoParent && reg.valid(entt::entity{ (entt::id_type)parent })) pe = entt::entity{ (entt::id_type)parent };
+                if (parentOf(reg, child) != pe) setParent(reg, child, pe);
+            }
+            if (!r.ok)
+            {
+                std::cerr << "[SceneAutosave] corrupt batch " << h.sequence << " in " << logPath << std::endl;
+                break;
+            }
+        }
+        return true;
+    }
+
+    // ---- SceneAutosave ---------------------------------------------------------------
+
+    SceneAutosave::SceneAutosave()
+        : m_lastCheckpoint(std::chrono::steady_clock::now())
+    {
+        m_thread = std::thread(&SceneAutosave::workerLoop, this);
+    }
+
+    SceneAutosave::~SceneAutosave()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    void SceneAutosave::attach(ECS& ecs, const std::string& basePath)
+    {
+        connectSaveTracking(ecs.registry);
+        if (m_ecs == &ecs && m_basePath == basePath) return;
+        m_ecs = &ecs;
+        m_basePath = basePath;
+        m_needsFull = true;
+    }
+
+    bool SceneAutosave::load(ECS& ecs, const std::string& basePath, ResourceManager* resources)
+    {
+        flush(); // pending writes belong to the scene being replaced
+        connectSaveTracking(ecs.registry);
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        bool hasBase = fs::exists(basePath, ec);
+        bool hasLog = fs::exists(basePath + ".log", ec);
+        if (!hasBase && !hasLog) return false;
+        if (hasBase) { if (!ECSSerializer::load(ecs, basePath, resources)) return false; }
+        else ecs.registry.clear();
+        if (hasLog && !replay(ecs.registry, basePath + ".log", resources)) return false;
+
+        resetSaveTracking(ecs.registry);
+        m_ecs = &ecs;
+        m_basePath = basePath;
+        m_needsFull = false;
+        m_logBytes.store(hasLog ? (uint64_t)fs::file_size(basePath + ".log", ec) : 0);
+        return true;
+    }
+
+    void SceneAutosave::markAll()
+    {
+        auto& reg = m_ecs->registry;
+        for (auto e : reg.view<TagC>())
+            reg.get_or_emplace<SaveDirtyC>(e).mask = SaveAll;
+        reg.ctx().get<SaveTrackingState>().touched.clear();
+    }
+
+    int SceneAutosave::checkpoint()
+    {
+        m_lastCheckpoint = std::chrono::steady_clock::now();
+        if (!m_ecs) return 0;
+        PROFILE_SCOPE("Autosave checkpoint");
+        auto& reg = m_ecs->registry;
+        auto& state = reg.ctx().get<SaveTrackingState>();
+        const bool full = m_needsFull;
+        if (full) markAll();
+
+        LogWriter w;
+        BatchHeader header{ kLogMagic, kLogVersion, m_sequence, 0, 0 };
+        w.pod(header);
+        if (full)
+        {
+            w.pod((uint32_t)0);
+            w.pod((uint16_t)0);
+            w.pod(kClearScene);
+            ++header.records;
+        }
+        // destroyed entities first: their ids may be reused by entities created since
+        auto& touched = state.touched;
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (auto e : touched)
+        {
+            if (reg.valid(e))
+            {
+                // still alive: removed components (or reverted prefab overrides) go with a full record
+                reg.get_or_emplace<SaveDirtyC>(e).mask = SaveAll;
+                continue;
+            }
+            w.pod((uint32_t)entt::to_integral(e));
+            w.pod((uint16_t)0);
+            w.pod(kDestroyed);
+            ++header.records;
+        }
+        touched.clear();
+        for (auto [e, dirty] : reg.view<SaveDirtyC>().each())
+        {
+            writeRecord(w, reg, e, dirty.mask);
+            ++header.records;
+        }
+        reg.clear<SaveDirtyC>();
+
+        m_lastRecords = (int)header.records;
+        if (header.records == 0 && !full) return 0;
+        header.bytes = w.buf.size() - sizeof(header);
+        std::memcpy(w.buf.data(), &header, sizeof(header));
+        ++m_sequence;
+        m_needsFull = false;
+
+        std::string base = m_basePath;
+        enqueue([this, base, full, batch = std::move(w.buf)]() { appendBatch(base, batch, full); });
+        return m_lastRecords;
+    }
+
+    void SceneAutosave::update(float intervalSeconds)
+    {
+        if (intervalSeconds <= 0.0f || !m_ecs) return;
+        float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_lastCheckpoint).count();
+        if (elapsed >= intervalSeconds) checkpoint();
+    }
+
+    void SceneAutosave::compact()
+    {
+        if (m_basePath.empty()) return;
+        std::string base = m_basePath;
+        enqueue([this, base]() { compactNow(base); });
+    }
+
+    void SceneAutosave::appendBatch(const std::string& basePath, const std::vector<uint8_t>& batch, bool reset)
+    {
+        PROFILE_SCOPE("Autosave append");
+        const std::string log = basePath + ".log";
+        // a full batch starts with kClearScene, so it is written aside and renamed over the log:
+        // at every point base + log load either the previous state or the new scene
+        const std::string target = reset ? log + ".tmp" : log;
+        {
+            std::ofstream f(target, std::ios::binary | (reset ? std::ios::trunc : std::ios::app));
+            if (!f) { std::cerr << "[SceneAutosave] cannot write " << target << std::endl; return; }
+            f.write((const char*)batch.data(), (std::streamsize)batch.size());
+            f.flush();
+            if (!f) { std::cerr << "[SceneAutosave] write failed: " << target << std::endl; return; }
+        }
+        std::error_code ec;
+        if (reset)
+        {
+            std::filesystem::rename(target, log, ec);
+            if (ec) { std::cerr << "[SceneAutosave] cannot replace " << log << ": " << ec.message() << std::endl; return; }
+        }
+        m_logBytes.store((uint64_t)std::filesystem::file_size(log, ec));
+        if (reset || m_logBytes.load() > m_compactBytes) compactNow(basePath);
+    }
+
+    void SceneAutosave::compactNow(const std::string& basePath)
+    {
+        PROFILE_SCOPE("Autosave compact");
+        namespace fs = std::filesystem;
+        const std::string log = basePath + ".log";
+        const std::string tmp = basePath + ".tmp";
+        std::error_code ec;
+        // from files only, so the live registry is never touched off the main thread
+        ECS scene;
+        if (fs::exists(basePath, ec) && !ECSSerializer::load(scene, basePath, nullptr)) return;
+        if (fs::exists(log, ec) && !replay(scene.registry, log, nullptr)) return;
+        if (!ECSSerializer::saveBinary(scene, tmp)) return;
+        fs::rename(tmp, basePath, ec);
+        if (ec) { std::cerr << "[SceneAutosave] cannot replace " << basePath << ": " << ec.message() << std::endl; return; }
+        // a crash before this point replays the log onto the new base, which is harmless
+        {
+            std::ofstream truncate(log, std::ios::binary | std::ios::trunc);
+        }
+        m_logBytes.store(0);
+        m_compactions.fetch_add(1);
+    }
+
+    void SceneAutosave::enqueue(std::function<void()> fn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(fn));
+        }
+        m_wake.notify_one();
+    }
+
+    void SceneAutosave::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_tasks.empty() && !m_busy.load(); });
+    }
+
+    void SceneAutosave::workerLoop()
+    {
+        Profiler::instance().setThreadName("Autosave");
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return !m_tasks.empty() || !m_running; });
+                if (m_tasks.empty()) break;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                m_busy.store(true);
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busy.store(false);
+                if (m_tasks.empty()) m_idle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <entt/entt.hpp>
+
+namespace engine
+{
+    struct ECS;
+    class ResourceManager;
+
+    // Component bits of SaveDirtyC
+    enum SaveBits : unsigned int
+    {
+        SaveTag        = 1u << 0,
+        SaveTransform  = 1u << 1, // includes the parent link
+        SaveMesh       = 1u << 2,
+        SaveDirLight   = 1u << 3,
+        SavePointLight = 1u << 4,
+        SaveSpotLight  = 1u << 5,
+        SaveParticle   = 1u << 6,
+        SaveRigidBody  = 1u << 7,
+        SaveCollider   = 1u << 8,
+        SaveAll        = (1u << 9) - 1
+    };
+
+    // Flags saved components on construct/update/destroy with SaveDirtyC and records
+    // destroyed entities. Writes must go through patch()/replace()/emplace() to be seen.
+    void connectSaveTracking(entt::registry& reg);
+
+    // Incremental ECS scene saves. A checkpoint encodes only the entities flagged since
+    // the previous one (main thread, cost proportional to the changes) and appends it as
+    // a batch to <base>.log on a background thread. When the log grows past a limit it is
+    // folded into the binary base scene on that thread, from files only. The exception is
+    // the first checkpoint after attach(): it encodes the whole scene on the main thread.
+    class SceneAutosave
+    {
+    public:
+        SceneAutosave();
+        ~SceneAutosave(); // drains queued writes
+
+        SceneAutosave(const SceneAutosave&) = delete;
+        SceneAutosave& operator=(const SceneAutosave&) = delete;
+
+        // Saves ecs to basePath from now on; the next checkpoint writes the whole scene
+        void attach(ECS& ecs, const std::string& basePath);
+        // Loads base + log into ecs and continues incrementally from there
+        bool load(ECS& ecs, const std::string& basePath, ResourceManager* resources);
+
+        // Writes a delta batch if anything changed; returns the number of records
+        int checkpoint();
+        // Periodic checkpoint, every interval seconds
+        void update(float intervalSeconds);
+        // Queues a full compaction of the log into the base file
+        void compact();
+        // Runs fn on the save thread after the writes queued so far
+        void enqueue(std::function<void()> fn);
+        // Blocks until the save thread is idle
+        void flush();
+
+        const std::string& basePath() const { return m_basePath; }
+        std::string logPath() const { return m_basePath + ".log"; }
+        uint64_t logBytes() const { return m_logBytes.load(); }
+        int compactions() const { return m_compactions.load(); }
+        int lastRecords() const { return m_lastRecords; }
+        bool busy() const { return m_busy.load(); }
+
+        // Applies a delta log onto reg (missing entities are created with their saved ids);
+        // incomplete trailing batches are ignored. Returns false if the file is unreadable.
+        static bool replay(entt::registry& reg, const std::string& logPath, ResourceManager* resources);
+
+    private:
+        void workerLoop();
+        void markAll();
+        void appendBatch(const std::string& basePath, const std::vector<uint8_t>& batch, bool reset);
+        void compactNow(const std::string& basePath);
+
+    private:
+        ECS* m_ecs = nullptr;
+        std::string m_basePath;
+        bool m_needsFull = true;
+        uint32_t m_sequence = 0;
+        int m_lastRecords = 0;
+        std::chrono::steady_clock::time_point m_lastCheckpoint;
+        uint64_t m_compactBytes = 4u << 20; // log size that triggers compaction
+
+        std::atomic<uint64_t> m_logBytes{0};
+        std::atomic<int> m_compactions{0};
+        std::atomic<bool> m_busy{false};
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<std::function<void()>> m_tasks;
+        bool m_running = true;
+    };
+}
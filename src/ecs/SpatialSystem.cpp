@@ -0,0 +1,132 @@
+#include "ecs/SpatialSystem.h"
+#include "ecs/ECS.h"
+#include "ecs/Prefab.h"
+#include "render/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine
+{
+    struct SpatialIndex
+    {
+        DynamicBVH tree{0.25f};
+        std::vector<glm::vec4> spheres; // by proxy id
+    };
+
+    static void onSpatialProxyDestroy(entt::registry& reg, entt::entity e)
+    {
+        int proxy = reg.get<SpatialProxyC>(e).proxy;
+        if (proxy >= 0) reg.ctx().get<SpatialIndex>().tree.destroyProxy(proxy);
+    }
+
+    // Radius inputs changed: refit with the next world matrix update
+    static void onBoundsChanged(entt::registry& reg, entt::entity e)
+    {
+        if (reg.all_of<WorldMatrixC>(e)) reg.emplace_or_replace<TransformDirtyC>(e);
+    }
+
+    void connectSpatialTracking(entt::registry& reg)
+    {
+        reg.ctx().emplace<SpatialIndex>();
+        reg.on_destroy<SpatialProxyC>().connect<&onSpatialProxyDestroy>();
+        reg.on_construct<BoundsC>().connect<&onBoundsChanged>();
+        reg.on_update<BoundsC>().connect<&onBoundsChanged>();
+        reg.on_construct<MeshRendererC>().connect<&onBoundsChanged>();
+        reg.on_update<MeshRendererC>().connect<&onBoundsChanged>();
+        reg.on_construct<PrefabC>().connect<&onBoundsChanged>();
+        reg.on_update<PrefabC>().connect<&onBoundsChanged>();
+    }
+
+    void refitSpatialProxy(entt::registry& reg, entt::entity e, const glm::mat4& world)
+    {
+        float radius = 0.0f;
+        if (const auto* b = reg.try_get<BoundsC>(e)) radius = b->radius;
+        else if (const auto* mr = resolveComponent<MeshRendererC>(reg, e)) radius = mr->mesh ? mr->mesh->boundingRadius() : 0.0f;
+        float scale = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+        glm::vec4 sphere(glm::vec3(world[3]), radius * scale);
+        Aabb box = Aabb::fromSphere(glm::vec3(sphere), sphere.w);
+
+        SpatialIndex& idx = reg.ctx().get<SpatialIndex>();
+        auto& sp = reg.get_or_emplace<SpatialProxyC>(e);
+        if (sp.proxy < 0) sp.proxy = idx.tree.createProxy(box, entt::to_integral(e));
+        else idx.tree.moveProxy(sp.proxy, box);
+        if ((int)idx.spheres.size() <= sp.proxy) idx.spheres.resize(sp.proxy + 1);
+        idx.spheres[sp.proxy] = sphere;
+    }
+
+    const DynamicBVH& spatialTree(const entt::registry& reg)
+    {
+        return reg.ctx().get<SpatialIndex>().tree;
+    }
+
+    glm::vec4 spatialSphere(const entt::registry& reg, int proxy)
+    {
+        return reg.ctx().get<SpatialIndex>().spheres[proxy];
+    }
+
+    static entt::entity proxyEntity(const DynamicBVH& tree, int proxy)
+    {
+        return entt::entity{ (entt::id_type)tree.userData(proxy) };
+    }
+
+    void querySphere(const entt::registry& reg, const glm::vec3& center, float radius, std::vector<entt::entity>& out)
+    {
+        const SpatialIndex& idx = reg.ctx().get<SpatialIndex>();
+        idx.tree.querySphere(center, radius, [&](int proxy) {
+            const glm::vec4& s = idx.spheres[proxy];
+            float reach = radius + s.w;
+            glm::vec3 d = glm::vec3(s) - center;
+            if (glm::dot(d, d) <= reach * reach) out.push_back(proxyEntity(idx.tree, proxy));
+            return true;
+        });
+    }
+
+    void queryAabb(const entt::registry& reg, const Aabb& box, std::vector<entt::entity>& out)
+    {
+        const SpatialIndex& idx = reg.ctx().get<SpatialIndex>();
+        idx.tree.queryAabb(box, [&](int proxy) {
+            const glm::vec4& s = idx.spheres[proxy];
+            glm::vec3 d = glm::vec3(s) - glm::clamp(glm::vec3(s), box.min, box.max);
+            if (glm::dot(d, d) <= s.w * s.w) out.push_back(proxyEntity(idx.tree, proxy));
+            return true;
+        });
+    }
+
+    void queryFrustum(const entt::registry& reg, const float (&planes)[6][4], std::vector<entt::entity>& out)
+    {
+        const SpatialIndex& idx = reg.ctx().get<SpatialIndex>();
+        idx.tree.queryFrustum(planes, [&](int proxy) {
+            const glm::vec4& s = idx.spheres[proxy];
+            for (int i = 0; i < 6; ++i)
+            {
+                const float* p = planes[i];
+                if (p[0] * s.x + p[1] * s.y + p[2] * s.z + p[3] < -s.w) return true;
+            }
+            out.push_back(proxyEntity(idx.tree, proxy));
+            return true;
+        });
+    }
+
+    entt::entity raycastEntities(const entt::registry& reg, const glm::vec3& origin, const glm::vec3& dir, float maxDist, float* outDist)
+    {
+        const SpatialIndex& idx = reg.ctx().get<SpatialIndex>();
+        entt::entity best = entt::null;
+        float bestT = maxDist;
+        idx.tree.raycast(origin, dir, maxDist, [&](int proxy, float) {
+            const glm::vec4& s = idx.spheres[proxy];
+            glm::vec3 oc = origin - glm::vec3(s);
+            float b = glm::dot(oc, dir);
+            float h = b * b - (glm::dot(oc, oc) - s.w * s.w);
+            if (h >= 0.0f)
+            {
+                float t = -b - std::sqrt(h);
+                if (t < 0.0f) t = 0.0f; // origin inside the sphere
+                if (-b + std::sqrt(h) >= 0.0f && t < bestT) { bestT = t; best = proxyEntity(idx.tree, proxy); }
+            }
+            return bestT;
+        });
+        if (outDist && best != entt::null) *outDist = bestT;
+        return best;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <entt/entt.hpp>
+#include "core/DynamicBVH.h"
+
+namespace engine
+{
+    // Spatial index of every entity with a WorldMatrixC, kept in the registry context.
+    // Each proxy holds the world bounding sphere: BoundsC radius (or the mesh radius,
+    // or 0) scaled by the world matrix. Proxies are refit by updateWorldMatrices().
+    void connectSpatialTracking(entt::registry& reg);
+    void refitSpatialProxy(entt::registry& reg, entt::entity e, const glm::mat4& world);
+
+    const DynamicBVH& spatialTree(const entt::registry& reg);
+    // World bounding sphere (center, radius) of a proxy
+    glm::vec4 spatialSphere(const entt::registry& reg, int proxy);
+
+    // Entities whose bounding sphere touches the query volume (appended to out)
+    void querySphere(const entt::registry& reg, const glm::vec3& center, float radius, std::vector<entt::entity>& out);
+    void queryAabb(const entt::registry& reg, const Aabb& box, std::vector<entt::entity>& out);
+    void queryFrustum(const entt::registry& reg, const float (&planes)[6][4], std::vector<entt::entity>& out);
+    // Nearest entity whose bounding sphere the ray enters; entt::null if none. dir must be normalized.
+    entt::entity raycastEntities(const entt::registry& reg, const glm::vec3& origin, const glm::vec3& dir, float maxDist, float* outDist = nullptr);
+}
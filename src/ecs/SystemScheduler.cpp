@@ -0,0 +1,143 @@
+#include "ecs/SystemScheduler.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace engine
+{
+    uint32_t SystemScheduler::resourceId(const char* name)
+    {
+        // FNV-1a, with the top bit set so it can't collide with small type ids in practice
+        uint32_t h = 2166136261u;
+        for (const char* c = name; *c; ++c) { h ^= (uint8_t)*c; h *= 16777619u; }
+        return h | 0x80000000u;
+    }
+
+    SystemScheduler::Builder SystemScheduler::add(const char* name, SystemFn fn)
+    {
+        System sys;
+        sys.name = name;
+        sys.fn = std::move(fn);
+        m_systems.push_back(std::move(sys));
+        return Builder(m_reg, &m_systems.back());
+    }
+
+    void SystemScheduler::setEnabled(const char* name, bool enabled)
+    {
+        for (auto& s : m_systems)
+            if (std::strcmp(s.name, name) == 0) s.enabled = enabled;
+    }
+
+    static bool intersects(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+    {
+        for (uint32_t x : a)
+            if (std::find(b.begin(), b.end(), x) != b.end()) return true;
+        return false;
+    }
+
+    bool SystemScheduler::conflicts(const System& a, const System& b)
+    {
+        if (a.exclusive || b.exclusive) return true;
+        return intersects(a.writes, b.writes) || intersects(a.writes, b.reads) || intersects(a.reads, b.writes);
+    }
+
+    void SystemScheduler::buildGraph()
+    {
+        m_active.clear();
+        for (int i = 0; i < (int)m_systems.size(); ++i)
+            if (m_systems[i].enabled) m_active.push_back(i);
+        const int n = (int)m_active.size();
+        m_dependents.assign(n, {});
+        m_remaining = std::vector<std::atomic<int>>(n);
+        for (int a = 0; a < n; ++a)
+        {
+            System& s = m_systems[m_active[a]];
+            s.deps.clear();
+            s.level = 0;
+            for (int b = 0; b < a; ++b)
+            {
+                const System& p = m_systems[m_active[b]];
+                if (!conflicts(s, p)) continue;
+                s.deps.push_back(m_active[b]);
+                s.level = std::max(s.level, p.level + 1);
+                m_dependents[b].push_back(a);
+            }
+            m_remaining[a].store((int)s.deps.size(), std::memory_order_relaxed);
+        }
+    }
+
+    void SystemScheduler::execute(int index, float dt, JobSystem* jobs, uint64_t runStartNs)
+    {
+        System& s = m_systems[m_active[index]];
+        uint64_t t0 = Profiler::nowNs();
+        {
+            ProfileScope zone(s.name);
+            s.fn(dt);
+        }
+        uint64_t t1 = Profiler::nowNs();
+        s.worker = jobs ? jobs->currentWorker() : -1;
+        s.startMs = (double)(t0 - runStartNs) / 1.0e6;
+        s.ms = (double)(t1 - t0) / 1.0e6;
+    }
+
+    void SystemScheduler::run(float dt, JobSystem* jobs)
+    {
+        PROFILE_SCOPE("systems");
+        const uint64_t runStart = Profiler::nowNs();
+        buildGraph();
+        const int n = (int)m_active.size();
+        if (!jobs || jobs->workerCount() == 0)
+        {
+            for (int i = 0; i < n; ++i) execute(i, dt, nullptr, runStart);
+        }
+        else
+        {
+            JobCounter done;
+            // a finished system releases the dependents whose last dependency it was
+            std::function<void(int)> launch = [&](int i) {
+                jobs->run([&, i]() {
+                    execute(i, dt, jobs, runStart);
+                    for (int d : m_dependents[i])
+                        if (m_remaining[d].fetch_sub(1, std::memory_order_acq_rel) == 1) launch(d);
+                }, &done);
+            };
+            for (int i = 0; i < n; ++i)
+                if (m_remaining[i].load(std::memory_order_relaxed) == 0) launch(i);
+            jobs->wait(done);
+        }
+        m_lastRunMs = (double)(Profiler::nowNs() - runStart) / 1.0e6;
+    }
+
+    std::string SystemScheduler::describe() const
+    {
+        std::ostringstream os;
+        os.setf(std::ios::fixed);
+        os.precision(3);
+        int maxLevel = 0;
+        for (int i : m_active) maxLevel = std::max(maxLevel, m_systems[i].level);
+        for (int level = 0; level <= maxLevel && !m_active.empty(); ++level)
+        {
+            os << "level " << level << ":\n";
+            for (int i : m_active)
+            {
+                const System& s = m_systems[i];
+                if (s.level != level) continue;
+                os << "  " << s.name << "  " << s.ms << " ms @" << s.startMs << " ms";
+                os << (s.worker >= 0 ? "  worker " + std::to_string(s.worker) : std::string("  caller"));
+                if (!s.deps.empty())
+                {
+                    os << "  after";
+                    for (int d : s.deps) os << ' ' << m_systems[d].name;
+                }
+                os << '\n';
+            }
+        }
+        for (const auto& s : m_systems)
+            if (!s.enabled) os << "  (disabled) " << s.name << '\n';
+        os << "total " << m_lastRunMs << " ms\n";
+        return os.str();
+    }
+}
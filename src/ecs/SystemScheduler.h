@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <entt/entt.hpp>
+
+namespace engine
+{
+    class JobSystem;
+
+    // Runs per-frame systems that declare what they read and write: component types of the
+    // registry or named resources (non-ECS state such as "physics" or "lua"). Each run builds
+    // a DAG in which a system waits for every earlier-registered system it conflicts with
+    // (write/write or read/write on the same key); everything else runs concurrently on
+    // the job system.
+    class SystemScheduler
+    {
+    public:
+        using SystemFn = std::function<void(float dt)>;
+
+        struct System
+        {
+            const char* name; // string literal (profiler zone name)
+            SystemFn fn;
+            std::vector<uint32_t> reads;
+            std::vector<uint32_t> writes;
+            bool exclusive = false; // conflicts with every other system
+            bool enabled = true;
+            // last run
+            std::vector<int> deps;
+            int level = 0;  // longest dependency chain before it
+            int worker = -1; // job system worker that ran it (-1: calling thread)
+            double startMs = 0.0; // from the start of run()
+            double ms = 0.0;
+        };
+
+        // Declares the access of one system; component pools are created here so that
+        // concurrent systems never create storage
+        class Builder
+        {
+        public:
+            template<typename... T> Builder& reads() { (add<T>(m_sys->reads), ...); return *this; }
+            template<typename... T> Builder& writes() { (add<T>(m_sys->writes), ...); return *this; }
+            Builder& reads(const char* resource) { m_sys->reads.push_back(resourceId(resource)); return *this; }
+            Builder& writes(const char* resource) { m_sys->writes.push_back(resourceId(resource)); return *this; }
+            Builder& exclusive() { m_sys->exclusive = true; return *this; }
+
+        private:
+            friend class SystemScheduler;
+            Builder(entt::registry& reg, System* sys) : m_reg(reg), m_sys(sys) {}
+            template<typename T> void add(std::vector<uint32_t>& set) { m_reg.storage<T>(); set.push_back((uint32_t)entt::type_hash<T>::value()); }
+
+            entt::registry& m_reg;
+            System* m_sys;
+        };
+
+        explicit SystemScheduler(entt::registry& reg) : m_reg(reg) {}
+
+        // Systems keep registration order wherever they conflict
+        Builder add(const char* name, SystemFn fn);
+        void setEnabled(const char* name, bool enabled);
+
+        // Runs all enabled systems and returns when they are done; the caller helps.
+        // Without a job system (or workers) they run in registration order.
+        void run(float dt, JobSystem* jobs);
+
+        const std::vector<System>& systems() const { return m_systems; }
+        double lastRunMs() const { return m_lastRunMs; }
+        // Schedule of the last run, one system per line grouped by level
+        std::string describe() const;
+
+        static uint32_t resourceId(const char* name);
+
+    private:
+        void buildGraph();
+        void execute(int index, float dt, JobSystem* jobs, uint64_t runStartNs);
+        static bool conflicts(const System& a, const System& b);
+
+    private:
+        entt::registry& m_reg;
+        std::vector<System> m_systems;
+        std::vector<int> m_active; // enabled systems of the current run
+        std::vector<std::vector<int>> m_dependents;
+        std::vector<std::atomic<int>> m_remaining;
+        double m_lastRunMs = 0.0;
+    };
+}
@@ -0,0 +1,256 @@
+#include "ecs/TransformSystem.h"
+#include "ecs/ECS.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <vector>
+#include <glm/gtc/quaternion.hpp>
+
+namespace engine
+{
+    // Propagation order of all HierarchyC entities, kept in the registry context.
+    // Parents always sit at a lower index than their children, so one forward
+    // sweep over the flat arrays resolves every world matrix. Local matrices and
+    // dirty bits live here too: a clean slot costs two byte reads, no registry lookup.
+    struct HierarchyState
+    {
+        std::vector<entt::entity> order;
+        std::vector<int> parentSlot;          // -1 for roots
+        std::vector<glm::mat4> local;         // by slot, TransformC as a matrix
+        std::vector<glm::mat4> world;         // by slot
+        std::vector<unsigned char> dirty;     // by slot, TransformC changed since the last sweep
+        std::vector<unsigned char> changed;   // by slot, this sweep
+        int firstDirty = 0;                   // sweep start; == order.size() when nothing is dirty
+        bool orderDirty = true;
+    };
+
+    static glm::mat4 localMatrix(const TransformC& tr)
+    {
+        // T * R * S without the full matrix products
+        glm::mat4 m = glm::mat4_cast(tr.rotation);
+        m[0] *= tr.scale.x;
+        m[1] *= tr.scale.y;
+        m[2] *= tr.scale.z;
+        m[3] = glm::vec4(tr.position, 1.0f);
+        return m;
+    }
+
+    static void markTransformDirty(entt::registry& reg, entt::entity e)
+    {
+        if (!reg.all_of<WorldMatrixC>(e)) reg.emplace<WorldMatrixC>(e);
+        reg.emplace_or_replace<TransformDirtyC>(e);
+        // hierarchy nodes also flag their slot (a pending re-sort reads TransformDirtyC instead)
+        const auto* h = reg.try_get<HierarchyC>(e);
+        auto* st = reg.ctx().find<HierarchyState>();
+        if (!h || !st || st->orderDirty) return;
+        if (h->slot < 0 || h->slot >= (int)st->order.size() || st->order[h->slot] != e) return;
+        st->dirty[h->slot] = 1;
+        st->firstDirty = std::min(st->firstDirty, h->slot);
+    }
+
+    // Sets depth of e and its descendants (values only, no structural changes)
+    static void setSubtreeDepth(entt::registry& reg, entt::entity root, unsigned int depth)
+    {
+        std::vector<std::pair<entt::entity, unsigned int>> stack{ { root, depth } };
+        while (!stack.empty())
+        {
+            auto [e, d] = stack.back();
+            stack.pop_back();
+            auto* h = reg.try_get<HierarchyC>(e);
+            if (!h) continue;
+            h->depth = d;
+            for (entt::entity c = h->firstChild; c != entt::null; )
+            {
+                stack.push_back({ c, d + 1 });
+                const auto* ch = reg.try_get<HierarchyC>(c);
+                c = ch ? ch->nextSibling : entt::null;
+            }
+        }
+    }
+
+    static void unlink(entt::registry& reg, entt::entity e, HierarchyC& h)
+    {
+        if (h.parent == entt::null) return;
+        if (reg.valid(h.parent) && reg.all_of<HierarchyC>(h.parent))
+        {
+            auto& ph = reg.get<HierarchyC>(h.parent);
+            if (ph.firstChild == e) ph.firstChild = h.nextSibling;
+            else
+            {
+                for (entt::entity c = ph.firstChild; c != entt::null; )
+                {
+                    auto* ch = reg.try_get<HierarchyC>(c);
+                    if (!ch) break;
+                    if (ch->nextSibling == e) { ch->nextSibling = h.nextSibling; break; }
+                    c = ch->nextSibling;
+                }
+            }
+        }
+        h.parent = entt::null;
+        h.nextSibling = entt::null;
+    }
+
+    // Destroyed parent: its children become roots (they keep their local TransformC)
+    static void onHierarchyDestroy(entt::registry& reg, entt::entity e)
+    {
+        auto& h = reg.get<HierarchyC>(e);
+        unlink(reg, e, h);
+        // (during registry.clear() some children may already be gone)
+        for (entt::entity c = h.firstChild; c != entt::null; )
+        {
+            auto* ch = reg.try_get<HierarchyC>(c);
+            if (!ch) break;
+            entt::entity next = ch->nextSibling;
+            ch->parent = entt::null;
+            ch->nextSibling = entt::null;
+            setSubtreeDepth(reg, c, 0);
+            c = next;
+        }
+        h.firstChild = entt::null;
+        reg.ctx().get<HierarchyState>().orderDirty = true;
+    }
+
+    static void onHierarchyConstruct(entt::registry& reg, entt::entity)
+    {
+        reg.ctx().get<HierarchyState>().orderDirty = true;
+    }
+
+    void connectTransformTracking(entt::registry& reg)
+    {
+        reg.ctx().emplace<HierarchyState>();
+        reg.on_construct<TransformC>().connect<&markTransformDirty>();
+        reg.on_update<TransformC>().connect<&markTransformDirty>();
+        reg.on_construct<HierarchyC>().connect<&onHierarchyConstruct>();
+        reg.on_destroy<HierarchyC>().connect<&onHierarchyDestroy>();
+    }
+
+    entt::entity parentOf(const entt::registry& reg, entt::entity e)
+    {
+        const auto* h = reg.try_get<HierarchyC>(e);
+        return h ? h->parent : entt::null;
+    }
+
+    bool setParent(entt::registry& reg, entt::entity child, entt::entity parent)
+    {
+        if (!reg.valid(child) || child == parent) return false;
+        if (parent != entt::null)
+        {
+            if (!reg.valid(parent)) return false;
+            for (entt::entity a = parent; a != entt::null; a = parentOf(reg, a))
+                if (a == child) return false;
+            reg.get_or_emplace<HierarchyC>(parent);
+        }
+        auto& h = reg.get_or_emplace<HierarchyC>(child);
+        if (h.parent == parent) return true;
+        unlink(reg, child, h);
+        unsigned int depth = 0;
+        if (parent != entt::null)
+        {
+            auto& ph = reg.get<HierarchyC>(parent);
+            h.parent = parent;
+            h.nextSibling = ph.firstChild;
+            ph.firstChild = child;
+            depth = ph.depth + 1;
+        }
+        setSubtreeDepth(reg, child, depth);
+        reg.ctx().get<HierarchyState>().orderDirty = true;
+        if (reg.all_of<TransformC>(child)) reg.patch<TransformC>(child);
+        return true;
+    }
+
+    static void rebuildOrder(entt::registry& reg, HierarchyState& st)
+    {
+        PROFILE_SCOPE("hierarchy_sort");
+        // depth order puts every parent ahead of its children
+        reg.sort<HierarchyC>([](const HierarchyC& a, const HierarchyC& b) { return a.depth < b.depth; });
+        auto view = reg.view<HierarchyC>();
+
+        // the previous order's caches stay valid for nodes that kept their parent
+        HierarchyState prev;
+        std::swap(prev.order, st.order);
+        std::swap(prev.parentSlot, st.parentSlot);
+        std::swap(prev.local, st.local);
+        std::swap(prev.world, st.world);
+        std::swap(prev.dirty, st.dirty);
+        const int prevCount = (int)prev.order.size();
+
+        st.order.assign(view.begin(), view.end());
+        const int n = (int)st.order.size();
+        std::vector<int> prevSlot(n);
+        for (int i = 0; i < n; ++i)
+        {
+            auto& h = view.get<HierarchyC>(st.order[i]);
+            prevSlot[i] = h.slot;
+            h.slot = i;
+        }
+        st.parentSlot.resize(n);
+        st.local.resize(n);
+        st.world.resize(n);
+        st.dirty.assign(n, 1);
+        st.changed.assign(n, 0);
+        const auto& flagged = reg.storage<TransformDirtyC>();
+        for (int i = 0; i < n; ++i)
+        {
+            entt::entity e = st.order[i];
+            entt::entity p = view.get<HierarchyC>(e).parent;
+            st.parentSlot[i] = p == entt::null ? -1 : view.get<HierarchyC>(p).slot;
+
+            const int o = prevSlot[i];
+            if (o < 0 || o >= prevCount || prev.order[o] != e) continue;
+            const entt::entity prevParent = prev.parentSlot[o] >= 0 ? prev.order[prev.parentSlot[o]] : entt::null;
+            if (prevParent != p) continue;
+            st.local[i] = prev.local[o];
+            st.world[i] = prev.world[o];
+            st.dirty[i] = prev.dirty[o] || flagged.contains(e);
+        }
+        st.firstDirty = 0;
+    }
+
+    int updateWorldMatrices(entt::registry& reg)
+    {
+        PROFILE_SCOPE("updateWorldMatrices");
+        int count = 0;
+        // Flat entities: rebuild only the flagged ones
+        auto flat = reg.view<TransformDirtyC, TransformC, WorldMatrixC>(entt::exclude<HierarchyC>);
+        for (auto e : flat)
+        {
+            auto& wm = flat.get<WorldMatrixC>(e);
+            wm.model = localMatrix(flat.get<TransformC>(e));
+            wm.normal = glm::mat3(glm::transpose(glm::inverse(wm.model)));
+            refitSpatialProxy(reg, e, wm.model);
+            ++count;
+        }
+
+        // Hierarchy: forward sweep from the first dirty slot; a node is rebuilt if it is
+        // flagged or its parent was. Registry lookups happen only for rebuilt nodes.
+        HierarchyState& st = reg.ctx().get<HierarchyState>();
+        if (st.orderDirty) { rebuildOrder(reg, st); st.orderDirty = false; }
+        const int n = (int)st.order.size();
+        const int start = st.firstDirty;
+        for (int i = start; i < n; ++i)
+        {
+            // slots before start are clean this sweep whatever changed[] still holds
+            const int p = st.parentSlot[i];
+            if (!st.dirty[i] && !(p >= start && st.changed[p])) { st.changed[i] = 0; continue; }
+            entt::entity e = st.order[i];
+            if (st.dirty[i])
+            {
+                const auto* tr = reg.try_get<TransformC>(e);
+                st.local[i] = tr ? localMatrix(*tr) : glm::mat4(1.0f);
+                st.dirty[i] = 0;
+            }
+            st.world[i] = p >= 0 ? st.world[p] * st.local[i] : st.local[i];
+            st.changed[i] = 1;
+            if (auto* wm = reg.try_get<WorldMatrixC>(e))
+            {
+                wm->model = st.world[i];
+                wm->normal = glm::mat3(glm::transpose(glm::inverse(wm->model)));
+                refitSpatialProxy(reg, e, wm->model);
+            }
+            ++count;
+        }
+        st.firstDirty = n;
+        reg.clear<TransformDirtyC>();
+        return count;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <entt/entt.hpp>
+
+namespace engine
+{
+    // Flags entities whose TransformC was emplaced or updated. Writes to an existing
+    // TransformC must go through registry.patch()/replace() to be seen.
+    void connectTransformTracking(entt::registry& reg);
+
+    // Rebuilds WorldMatrixC (and the spatial proxy) for flagged entities only; returns how many were rebuilt.
+    // Entities with a HierarchyC are swept parent-before-child from the first flagged slot and a
+    // changed parent re-propagates its whole subtree. Reparenting re-sorts the order but keeps the
+    // cached matrices of nodes whose parent stayed the same.
+    int updateWorldMatrices(entt::registry& reg);
+
+    // Attaches child under parent (entt::null detaches). TransformC of the child is
+    // then local to the parent. Returns false for invalid entities or cycles.
+    bool setParent(entt::registry& reg, entt::entity child, entt::entity parent);
+    entt::entity parentOf(const entt::registry& reg, entt::entity e);
+}
@@ -1,7 +1,19 @@
 #include "core/Application.h"
 
-int main()
+int main(int argc, char** argv)
 {
+    engine::BenchmarkSettings bench;
+    const auto parsed = engine::BenchmarkSettings::parseArgs(argc, argv, bench);
+    if (parsed != engine::BenchmarkSettings::ParseResult::Run)
+        return parsed == engine::BenchmarkSettings::ParseResult::Exit ? 0 : 1;
+    if (bench.jobs)
+        return engine::runJobSystemBenchmark(bench);
+    if (bench.serialize)
+        return engine::runSerializationBenchmark(bench);
+    if (bench.spawn)
+        return engine::runSpawnBenchmark(bench);
+
     engine::Application app;
+    app.setBenchmark(bench);
     return app.run();
 }
@@ -0,0 +1,24 @@
+#include "physics/PhysXDispatcher.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+#include <task/PxTask.h>
+
+namespace engine
+{
+    void PhysXDispatcher::submitTask(physx::PxBaseTask& task)
+    {
+        physx::PxBaseTask* t = &task;
+        m_jobs.run([t]()
+        {
+            PROFILE_SCOPE("PhysX task");
+            t->run();
+            t->release();
+        });
+    }
+
+    physx::PxU32 PhysXDispatcher::getWorkerCount() const
+    {
+        return (physx::PxU32)m_jobs.workerCount();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <task/PxCpuDispatcher.h>
+
+namespace engine
+{
+    class JobSystem;
+
+    // Runs PhysX tasks on the engine job system so physics and engine jobs share one pool
+    class PhysXDispatcher : public physx::PxCpuDispatcher
+    {
+    public:
+        explicit PhysXDispatcher(JobSystem& jobs) : m_jobs(jobs) {}
+
+        void submitTask(physx::PxBaseTask& task) override;
+        physx::PxU32 getWorkerCount() const override;
+
+    private:
+        JobSystem& m_jobs;
+    };
+}
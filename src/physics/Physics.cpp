@@ -1,6 +1,10 @@
 #include "physics/Physics.h"
+#include "physics/PhysXDispatcher.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
 
 #include <PxPhysicsAPI.h>
+#include <thread>
 
 using namespace physx;
 
@@ -37,6 +41,7 @@ namespace engine
     {
         if (m_scene) { m_scene->release(); m_scene = nullptr; }
         if (m_dispatcher) { m_dispatcher->release(); m_dispatcher = nullptr; }
+        m_jobDispatcher.reset();
         if (m_physics) { PxCloseExtensions(); m_physics->release(); m_physics = nullptr; }
         if (m_pvd) { m_pvd->release(); m_pvd = nullptr; }
         if (m_foundation) { m_foundation->release(); m_foundation = nullptr; }
@@ -47,8 +52,16 @@ namespace engine
     {
         PxSceneDesc sceneDesc(m_physics->getTolerancesScale());
         sceneDesc.gravity = PxVec3(0.0f, gravityY, 0.0f);
-        m_dispatcher = PxDefaultCpuDispatcherCreate(2);
-        sceneDesc.cpuDispatcher = m_dispatcher;
+        if (m_jobs)
+        {
+            m_jobDispatcher = std::make_unique<PhysXDispatcher>(*m_jobs);
+            sceneDesc.cpuDispatcher = m_jobDispatcher.get();
+        }
+        else
+        {
+            m_dispatcher = PxDefaultCpuDispatcherCreate(2);
+            sceneDesc.cpuDispatcher = m_dispatcher;
+        }
         sceneDesc.filterShader = PxDefaultSimulationFilterShader;
         m_scene = m_physics->createScene(sceneDesc);
         if (!m_scene) return false;
@@ -60,8 +73,18 @@ namespace engine
 
     void Physics::simulate(float deltaTimeSeconds)
     {
+        PROFILE_SCOPE("Physics::simulate");
         if (!m_scene) return;
         m_scene->simulate(deltaTimeSeconds);
+        PROFILE_SCOPE("Physics::fetchResults");
+        // Called from a job, a blocking fetch could starve the PhysX tasks queued behind it
+        if (m_jobs)
+        {
+            while (!m_scene->checkResults(false))
+            {
+                if (!m_jobs->runPending()) std::this_thread::yield();
+            }
+        }
         m_scene->fetchResults(true);
     }
 
@@ -16,6 +16,9 @@ namespace physx {
 
 namespace engine
 {
+    class JobSystem;
+    class PhysXDispatcher;
+
     class Physics
     {
     public:
@@ -24,6 +27,8 @@ namespace engine
 
         bool initialize();
         void shutdown();
+        // Run PhysX tasks on the engine job pool (call before createDefaultScene)
+        void setJobSystem(JobSystem* jobs) { m_jobs = jobs; }
 
         void simulate(float deltaTimeSeconds);
 
@@ -44,6 +49,8 @@ namespace engine
         physx::PxFoundation* m_foundation = nullptr;
         physx::PxPhysics* m_physics = nullptr;
         physx::PxDefaultCpuDispatcher* m_dispatcher = nullptr;
+        JobSystem* m_jobs = nullptr;
+        std::unique_ptr<PhysXDispatcher> m_jobDispatcher;
         physx::PxPvd* m_pvd = nullptr;
         physx::PxScene* m_scene = nullptr;
         physx::PxMaterial* m_defaultMaterial = nullptr;
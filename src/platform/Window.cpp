@@ -24,6 +24,7 @@ namespace engine
         m_height = props.height;
         m_vsync = props.vsync;
 
+        glfwWindowHint(GLFW_VISIBLE, props.visible ? GLFW_TRUE : GLFW_FALSE);
         m_window = glfwCreateWindow(props.width, props.height, props.title.c_str(), nullptr, nullptr);
         if (m_window == nullptr)
         {
@@ -11,6 +11,7 @@ namespace engine
         int width = 1280;
         int height = 720;
         bool vsync = true;
+        bool visible = true;
     };
 
     class Window
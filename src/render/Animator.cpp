@@ -1,5 +1,6 @@
 #include "render/Animator.h"
 #include "render/Skeleton.h"
+#include "core/Profiler.h"
 
 #include <glm/glm.hpp>
 
@@ -14,6 +15,7 @@ namespace engine
 
     void Animator::update(Skeleton& skel, float dt)
     {
+        PROFILE_SCOPE("Animator::update");
         if (!m_anim) return;
         float tps = m_anim->ticksPerSecond > 0.0f ? m_anim->ticksPerSecond : 25.0f;
         float duration = m_anim->duration;
@@ -81,7 +81,26 @@ namespace engine
         return nullptr;
     }
 
-    bool AssimpLoader::loadModel(ResourceManager* resources, const std::string& path, std::vector<ImportedMesh>& outMeshes, bool flipUVs)
+    // Pre-order walk, so a node's parent is always already in the list
+    static void collectNodes(const aiNode* n, int parent, std::vector<ImportedNode>& out)
+    {
+        ImportedNode node;
+        node.name = n->mName.C_Str();
+        node.parent = parent;
+        aiVector3D scl, pos;
+        aiQuaternion rot;
+        n->mTransformation.Decompose(scl, rot, pos);
+        node.position = glm::vec3(pos.x, pos.y, pos.z);
+        node.rotation = glm::quat(rot.w, rot.x, rot.y, rot.z);
+        node.scale = glm::vec3(scl.x, scl.y, scl.z);
+        for (unsigned i = 0; i < n->mNumMeshes; ++i) node.meshes.push_back((int)n->mMeshes[i]);
+        const int self = (int)out.size();
+        out.push_back(std::move(node));
+        for (unsigned i = 0; i < n->mNumChildren; ++i) collectNodes(n->mChildren[i], self, out);
+    }
+
+    bool AssimpLoader::loadModel(ResourceManager* resources, const std::string& path, std::vector<ImportedMesh>& outMeshes, bool flipUVs,
+                                 std::vector<ImportedNode>* outNodes)
     {
         Assimp::Importer importer;
         unsigned flags = aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_JoinIdenticalVertices | aiProcess_CalcTangentSpace;
@@ -120,6 +139,15 @@ namespace engine
             ImportedMesh im{ mesh, diff, metal, rough, ao, normal, am->mName.C_Str() };
             outMeshes.push_back(im);
         }
+        if (outNodes)
+        {
+            outNodes->clear();
+            collectNodes(scene->mRootNode, -1, *outNodes);
+            // aiNode mesh indices are per file; outMeshes may already hold earlier ones
+            const int base = (int)outMeshes.size() - (int)scene->mNumMeshes;
+            for (auto& node : *outNodes)
+                for (int& m : node.meshes) m += base;
+        }
         return !outMeshes.empty();
     }
 
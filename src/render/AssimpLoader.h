@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace engine
 {
@@ -23,6 +25,17 @@ namespace engine
         std::string name;
     };
 
+    // Node of the imported scene graph, parents before children
+    struct ImportedNode
+    {
+        std::string name;
+        int parent = -1;            // index into the node list
+        glm::vec3 position{0.0f};   // local to the parent
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale{1.0f};
+        std::vector<int> meshes;    // indices into outMeshes
+    };
+
     struct ImportedSkinned
     {
         SkinnedMesh* mesh = nullptr;
@@ -35,7 +48,9 @@ namespace engine
     class AssimpLoader
     {
     public:
-        static bool loadModel(class ResourceManager* resources, const std::string& path, std::vector<ImportedMesh>& outMeshes, bool flipUVs);
+        // outNodes (optional) receives the node tree that places the meshes
+        static bool loadModel(class ResourceManager* resources, const std::string& path, std::vector<ImportedMesh>& outMeshes, bool flipUVs,
+                              std::vector<ImportedNode>* outNodes = nullptr);
         static bool loadSkinned(class ResourceManager* resources, const std::string& path, ImportedSkinned& outSkinned, bool flipUVs);
     };
 }
@@ -1,9 +1,8 @@
 #pragma once
 
-#include <vector>
-
 namespace engine
 {
+    // Cascades are the layers of one depth 2D array texture
     class CascadedShadowMap
     {
     public:
@@ -13,22 +12,23 @@ namespace engine
         bool create(int size, int cascades);
         void destroy();
 
-        // Begin rendering into a specific cascade (0..cascades-1)
+        // Begin rendering into a specific cascade (0..cascades-1), cleared
         void beginCascade(int index);
+        // Attaches every cascade for one layered pass (gl_Layer selects the cascade); not cleared
+        void beginLayered();
         void end(int screenWidth, int screenHeight);
 
-        // Bind a cascade depth texture to texture unit slot
-        void bindCascade(int index, int slot) const;
+        // Bind the cascade array texture to texture unit slot
+        void bindArray(int slot) const;
 
         int size() const { return m_size; }
-        int cascades() const { return (int)m_depthTextures.size(); }
-        unsigned int textureId(int index) const { return (index>=0 && index<(int)m_depthTextures.size()) ? m_depthTextures[index] : 0; }
+        int cascades() const { return m_cascades; }
+        unsigned int textureId() const { return m_depthArray; }
 
     private:
         unsigned int m_fbo = 0;
-        std::vector<unsigned int> m_depthTextures;
+        unsigned int m_depthArray = 0;
         int m_size = 0;
+        int m_cascades = 0;
     };
 }
-
-
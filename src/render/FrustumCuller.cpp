@@ -0,0 +1,233 @@
+#include "render/FrustumCuller.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ENGINE_CULL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_CULL_SSE 1
+#endif
+
+namespace engine
+{
+    static const int kCullChunk = 1024; // spheres per parallel-for chunk, multiple of 8
+
+    void CullSpheres::pad()
+    {
+        size_t n = (x.size() + 7) & ~size_t(7);
+        // negative infinite radius: d >= -r fails for every plane
+        x.resize(n, 0.0f); y.resize(n, 0.0f); z.resize(n, 0.0f); r.resize(n, -1e30f);
+    }
+
+    FrustumPlanes FrustumPlanes::fromViewProj(const glm::mat4& m)
+    {
+        FrustumPlanes f;
+        // rows of the (column-major) matrix: left/right = w +- x, bottom/top = w +- y, near/far = w +- z
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int s = 0; s < 2; ++s)
+            {
+                float sign = s == 0 ? 1.0f : -1.0f;
+                float* p = f.p[i * 2 + s];
+                for (int c = 0; c < 4; ++c)
+                    p[c] = m[c][3] + sign * m[c][i];
+                float len = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+                if (len > 0.0f) { p[0] /= len; p[1] /= len; p[2] /= len; p[3] /= len; }
+            }
+        }
+        return f;
+    }
+
+    CullView CullView::fromViewProj(const glm::mat4& viewProj, bool extendTowardLight)
+    {
+        CullView v;
+        v.frustum = FrustumPlanes::fromViewProj(viewProj);
+        if (extendTowardLight)
+        {
+            // near plane (w + z) replaced by one every sphere passes
+            float* nearPlane = v.frustum.p[4];
+            nearPlane[0] = nearPlane[1] = nearPlane[2] = 0.0f;
+            nearPlane[3] = 1e30f;
+        }
+        return v;
+    }
+
+    void CullView::setRange(const glm::vec3& center, float radius)
+    {
+        hasRange = true;
+        rangeCenter = center;
+        rangeRadius = radius;
+    }
+
+    void CullView::setCone(const glm::vec3& apex, const glm::vec3& axis, float halfAngleRadians, float length)
+    {
+        hasCone = true;
+        coneApex = apex;
+        coneAxis = glm::normalize(axis);
+        coneCos = std::cos(halfAngleRadians);
+        coneSin = std::sin(halfAngleRadians);
+        coneLength = length;
+    }
+
+    // Range sphere and spot cone of a view, for a sphere that passed the frustum planes
+    static bool passesLightVolume(const CullView& v, float x, float y, float z, float r)
+    {
+        if (v.hasRange)
+        {
+            glm::vec3 d = glm::vec3(x, y, z) - v.rangeCenter;
+            float reach = v.rangeRadius + r;
+            if (glm::dot(d, d) > reach * reach) return false;
+        }
+        if (v.hasCone)
+        {
+            glm::vec3 d = glm::vec3(x, y, z) - v.coneApex;
+            float along = glm::dot(d, v.coneAxis);
+            if (along < -r || along > v.coneLength + r) return false;
+            // signed distance from the cone's side
+            float across = std::sqrt(std::max(glm::dot(d, d) - along * along, 0.0f));
+            if (v.coneCos * across - v.coneSin * along > r) return false;
+        }
+        return true;
+    }
+
+    // Tests spheres [begin, end); a tail shorter than the SIMD width falls back to scalar
+    static void cullRange(const CullSpheres& s, const FrustumPlanes& f, uint8_t* mask, int begin, int end)
+    {
+        const float* xs = s.x.data(); const float* ys = s.y.data();
+        const float* zs = s.z.data(); const float* rs = s.r.data();
+        int i = begin;
+#if defined(ENGINE_CULL_AVX)
+        __m256 pa[6], pb[6], pc[6], pd[6];
+        for (int p = 0; p < 6; ++p)
+        {
+            pa[p] = _mm256_set1_ps(f.p[p][0]); pb[p] = _mm256_set1_ps(f.p[p][1]);
+            pc[p] = _mm256_set1_ps(f.p[p][2]); pd[p] = _mm256_set1_ps(f.p[p][3]);
+        }
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 cx = _mm256_loadu_ps(xs + i), cy = _mm256_loadu_ps(ys + i);
+            __m256 cz = _mm256_loadu_ps(zs + i);
+            __m256 nr = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(rs + i));
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < 6; ++p)
+            {
+                __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(pa[p], cx), _mm256_mul_ps(pb[p], cy)),
+                                         _mm256_add_ps(_mm256_mul_ps(pc[p], cz), pd[p]));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, nr, _CMP_GE_OQ));
+            }
+            int bits = _mm256_movemask_ps(inside);
+            for (int k = 0; k < 8; ++k) mask[i + k] = (uint8_t)((bits >> k) & 1);
+        }
+#elif defined(ENGINE_CULL_SSE)
+        __m128 pa[6], pb[6], pc[6], pd[6];
+        for (int p = 0; p < 6; ++p)
+        {
+            pa[p] = _mm_set1_ps(f.p[p][0]); pb[p] = _mm_set1_ps(f.p[p][1]);
+            pc[p] = _mm_set1_ps(f.p[p][2]); pd[p] = _mm_set1_ps(f.p[p][3]);
+        }
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 cx = _mm_loadu_ps(xs + i), cy = _mm_loadu_ps(ys + i);
+            __m128 cz = _mm_loadu_ps(zs + i);
+            __m128 nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(rs + i));
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < 6; ++p)
+            {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pa[p], cx), _mm_mul_ps(pb[p], cy)),
+                                      _mm_add_ps(_mm_mul_ps(pc[p], cz), pd[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, nr));
+            }
+            int bits = _mm_movemask_ps(inside);
+            for (int k = 0; k < 4; ++k) mask[i + k] = (uint8_t)((bits >> k) & 1);
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            uint8_t in = 1;
+            for (int p = 0; p < 6 && in; ++p)
+            {
+                float d = f.p[p][0]*xs[i] + f.p[p][1]*ys[i] + f.p[p][2]*zs[i] + f.p[p][3];
+                if (d < -rs[i]) in = 0;
+            }
+            mask[i] = in;
+        }
+    }
+
+    void FrustumCuller::cull(const CullSpheres& spheres, const FrustumPlanes& frustum, std::vector<uint32_t>& visible, JobSystem* jobs)
+    {
+        PROFILE_SCOPE("cull");
+        visible.clear();
+        const int padded = (int)spheres.x.size();
+        if (spheres.count == 0) return;
+        m_mask.resize(padded);
+        uint8_t* mask = m_mask.data();
+        if (jobs && padded > kCullChunk)
+        {
+            jobs->parallelFor(padded, kCullChunk, [&](int b, int e) { cullRange(spheres, frustum, mask, b, e); });
+        }
+        else
+        {
+            cullRange(spheres, frustum, mask, 0, padded);
+        }
+        for (int i = 0; i < spheres.count; ++i)
+            if (mask[i]) visible.push_back((uint32_t)i);
+    }
+
+    void FrustumCuller::cullViews(const CullSpheres& spheres, const CullView* views, int viewCount,
+                                  std::vector<uint32_t>* visible, JobSystem* jobs)
+    {
+        PROFILE_SCOPE("cull_views");
+        for (int v = 0; v < viewCount; ++v) visible[v].clear();
+        const int padded = (int)spheres.x.size();
+        if (spheres.count == 0 || viewCount <= 0) return;
+        // mask of view v at [v * padded, (v + 1) * padded)
+        m_mask.resize((size_t)padded * viewCount);
+        auto cullChunk = [&](int begin, int end)
+        {
+            for (int v = 0; v < viewCount; ++v)
+            {
+                uint8_t* mask = m_mask.data() + (size_t)v * padded;
+                cullRange(spheres, views[v].frustum, mask, begin, end);
+                if (!views[v].hasRange && !views[v].hasCone) continue;
+                for (int i = begin; i < end; ++i)
+                    if (mask[i] && !passesLightVolume(views[v], spheres.x[i], spheres.y[i], spheres.z[i], spheres.r[i])) mask[i] = 0;
+            }
+        };
+        if (jobs && padded > kCullChunk) jobs->parallelFor(padded, kCullChunk, cullChunk);
+        else cullChunk(0, padded);
+        for (int v = 0; v < viewCount; ++v)
+        {
+            const uint8_t* mask = m_mask.data() + (size_t)v * padded;
+            for (int i = 0; i < spheres.count; ++i)
+                if (mask[i]) visible[v].push_back((uint32_t)i);
+        }
+    }
+
+    void FrustumCuller::cullSubset(const CullSpheres& spheres, const FrustumPlanes& f, const std::vector<uint32_t>& candidates, std::vector<uint32_t>& visible)
+    {
+        visible.clear();
+        for (uint32_t i : candidates)
+        {
+            bool in = true;
+            for (int p = 0; p < 6 && in; ++p)
+                in = f.p[p][0]*spheres.x[i] + f.p[p][1]*spheres.y[i] + f.p[p][2]*spheres.z[i] + f.p[p][3] >= -spheres.r[i];
+            if (in) visible.push_back(i);
+        }
+    }
+
+    const char* FrustumCuller::simdPath()
+    {
+#if defined(ENGINE_CULL_AVX)
+        return "avx";
+#elif defined(ENGINE_CULL_SSE)
+        return "sse";
+#else
+        return "scalar";
+#endif
+    }
+}
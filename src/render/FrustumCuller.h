@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace engine
+{
+    class JobSystem;
+
+    // World-space bounding spheres, one array per component. Sizes are padded to a
+    // multiple of 8 with spheres that never pass, so the SIMD loops need no tail.
+    struct CullSpheres
+    {
+        std::vector<float> x, y, z, r;
+        int count = 0; // real spheres; arrays may be longer after pad()
+
+        void clear() { x.clear(); y.clear(); z.clear(); r.clear(); count = 0; }
+        void push(const glm::vec3& center, float radius)
+        {
+            x.push_back(center.x); y.push_back(center.y); z.push_back(center.z); r.push_back(radius);
+            ++count;
+        }
+        void pad();
+    };
+
+    // Six inward-facing planes (a, b, c, d) extracted from a view-projection matrix
+    struct FrustumPlanes
+    {
+        float p[6][4];
+        static FrustumPlanes fromViewProj(const glm::mat4& viewProj);
+    };
+
+    // One view of a multi-view cull: a frustum, optionally narrowed by the light's range sphere
+    // and a spot cone. Shadow views drop the near plane so casters between the light and the
+    // view volume are kept (they are pancaked onto the near plane with depth clamp).
+    struct CullView
+    {
+        FrustumPlanes frustum;
+        bool hasRange = false;
+        glm::vec3 rangeCenter{0.0f};
+        float rangeRadius = 0.0f;
+        bool hasCone = false;
+        glm::vec3 coneApex{0.0f};
+        glm::vec3 coneAxis{0.0f, -1.0f, 0.0f}; // unit
+        float coneCos = 1.0f, coneSin = 0.0f;  // of the half angle
+        float coneLength = 0.0f;
+
+        static CullView fromViewProj(const glm::mat4& viewProj, bool extendTowardLight);
+        void setRange(const glm::vec3& center, float radius);
+        void setCone(const glm::vec3& apex, const glm::vec3& axis, float halfAngleRadians, float length);
+    };
+
+    // Sphere/frustum test, 8 spheres per iteration with AVX, 4 with SSE, scalar otherwise.
+    class FrustumCuller
+    {
+    public:
+        // Writes the indices of spheres at least partly inside the frustum, in ascending order.
+        // With jobs, chunks of the array are tested in parallel.
+        void cull(const CullSpheres& spheres, const FrustumPlanes& frustum, std::vector<uint32_t>& visible, JobSystem* jobs = nullptr);
+
+        // Same test restricted to a candidate list (e.g. from a spatial query), scalar
+        static void cullSubset(const CullSpheres& spheres, const FrustumPlanes& frustum, const std::vector<uint32_t>& candidates, std::vector<uint32_t>& visible);
+
+        // Every view in one pass over the spheres (chunks of the array tested against all views
+        // while they are in cache); visible[v] receives the indices inside views[v], ascending.
+        void cullViews(const CullSpheres& spheres, const CullView* views, int viewCount,
+                       std::vector<uint32_t>* visible, JobSystem* jobs = nullptr);
+
+        // "avx", "sse" or "scalar", whichever this build compiled in
+        static const char* simdPath();
+
+    private:
+        std::vector<uint8_t> m_mask;
+    };
+}
@@ -0,0 +1,316 @@
+#include "render/GeometryArena.h"
+#include "render/RenderStats.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace engine
+{
+    static constexpr uint32_t kInitialVertices = 64 * 1024;  // 2 MB
+    static constexpr uint32_t kInitialIndices = 256 * 1024;  // 1 MB
+    static constexpr uint32_t kInitialInstances = 4096;      // 256 KB per frame
+    static constexpr uint32_t kInitialCommands = 1024;       // 20 KB per frame
+
+    GeometryArena& GeometryArena::instance()
+    {
+        static GeometryArena arena;
+        return arena;
+    }
+
+    bool GeometryArena::ensureCreated()
+    {
+        if (m_destroyed) return false;
+        if (m_vao) return true;
+        m_hasBaseInstance = GLAD_GL_VERSION_4_2 != 0;
+        m_hasMDI = GLAD_GL_VERSION_4_3 != 0;
+
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ebo);
+        if (!m_instanceStream.create(kInitialInstances * sizeof(glm::mat4))
+            || !m_indirectStream.create(kInitialCommands * sizeof(DrawIndirectCommand)))
+        {
+            std::cerr << "[GeometryArena] stream buffer create failed" << std::endl;
+        }
+        m_vertexCapacity = kInitialVertices;
+        m_indexCapacity = kInitialIndices;
+        m_freeVertices = { { 0, m_vertexCapacity } };
+        m_freeIndices = { { 0, m_indexCapacity } };
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_vertexCapacity * kVertexSize), nullptr, GL_STATIC_DRAW);
+        // layout: position (0), normal (1), uv (2)
+        GLsizei stride = (GLsizei)kVertexSize;
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(m_indexCapacity * sizeof(uint32_t)), nullptr, GL_STATIC_DRAW);
+
+        // per-instance model matrix, attributes 3-6 (vec4 per column)
+        for (int i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(3 + i);
+            glVertexAttribDivisor(3 + i, 1);
+        }
+        setupInstanceAttributes(0);
+        m_instanceGeneration = m_instanceStream.generation();
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::cout << "[GeometryArena] multi-draw indirect " << (m_hasMDI ? "on" : "off (GL < 4.3)")
+                  << ", instance stream " << (m_instanceStream.persistent() ? "persistent" : "mapped per upload") << std::endl;
+        return true;
+    }
+
+    void GeometryArena::destroy()
+    {
+        m_indirectStream.destroy();
+        m_instanceStream.destroy();
+        if (m_ebo) glDeleteBuffers(1, &m_ebo);
+        if (m_vbo) glDeleteBuffers(1, &m_vbo);
+        if (m_vao) glDeleteVertexArrays(1, &m_vao);
+        m_vao = m_vbo = m_ebo = 0;
+        m_freeVertices.clear();
+        m_freeIndices.clear();
+        m_vertexUsed = m_indexUsed = 0;
+        m_allocations = 0;
+        m_destroyed = true;
+    }
+
+    bool GeometryArena::takeBlock(std::vector<Block>& freeList, uint32_t size, uint32_t& offset)
+    {
+        // first fit
+        for (size_t i = 0; i < freeList.size(); ++i)
+        {
+            Block& b = freeList[i];
+            if (b.size < size) continue;
+            offset = b.offset;
+            b.offset += size;
+            b.size -= size;
+            if (b.size == 0) freeList.erase(freeList.begin() + (long)i);
+            return true;
+        }
+        return false;
+    }
+
+    void GeometryArena::releaseBlock(std::vector<Block>& freeList, uint32_t offset, uint32_t size)
+    {
+        if (size == 0) return;
+        auto it = std::lower_bound(freeList.begin(), freeList.end(), offset,
+                                   [](const Block& b, uint32_t o) { return b.offset < o; });
+        it = freeList.insert(it, Block{ offset, size });
+        // merge with the next block, then with the previous one
+        auto next = it + 1;
+        if (next != freeList.end() && it->offset + it->size == next->offset)
+        {
+            it->size += next->size;
+            freeList.erase(next);
+        }
+        if (it != freeList.begin())
+        {
+            auto prev = it - 1;
+            if (prev->offset + prev->size == it->offset)
+            {
+                prev->size += it->size;
+                freeList.erase(it);
+            }
+        }
+    }
+
+    void GeometryArena::grow(unsigned int& buffer, unsigned int target, uint32_t& capacity, uint32_t minCapacity,
+                             size_t elementSize, std::vector<Block>& freeList)
+    {
+        uint32_t newCapacity = std::max(capacity * 2, minCapacity);
+        unsigned int bigger = 0;
+        glGenBuffers(1, &bigger);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bigger);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(newCapacity * elementSize), nullptr, GL_STATIC_DRAW);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)(capacity * elementSize));
+        glDeleteBuffers(1, &buffer);
+        buffer = bigger;
+        releaseBlock(freeList, capacity, newCapacity - capacity);
+        capacity = newCapacity;
+
+        // point the shared VAO at the new storage
+        glBindVertexArray(m_vao);
+        glBindBuffer(target, buffer);
+        if (target == GL_ARRAY_BUFFER)
+        {
+            GLsizei stride = (GLsizei)kVertexSize;
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GeometryRange GeometryArena::allocate(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+    {
+        GeometryRange range;
+        const uint32_t vertexCount = (uint32_t)(vertices.size() / 8);
+        const uint32_t indexCount = (uint32_t)indices.size();
+        if (vertexCount == 0 || indexCount == 0 || !ensureCreated()) return range;
+
+        uint32_t vertexOffset = 0, indexOffset = 0;
+        if (!takeBlock(m_freeVertices, vertexCount, vertexOffset))
+        {
+            grow(m_vbo, GL_ARRAY_BUFFER, m_vertexCapacity, m_vertexCapacity + vertexCount, kVertexSize, m_freeVertices);
+            takeBlock(m_freeVertices, vertexCount, vertexOffset);
+        }
+        if (!takeBlock(m_freeIndices, indexCount, indexOffset))
+        {
+            grow(m_ebo, GL_ELEMENT_ARRAY_BUFFER, m_indexCapacity, m_indexCapacity + indexCount, sizeof(uint32_t), m_freeIndices);
+            takeBlock(m_freeIndices, indexCount, indexOffset);
+        }
+        // copy-write target: binding GL_ELEMENT_ARRAY_BUFFER here would modify whatever VAO is bound
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(vertexOffset * kVertexSize), (GLsizeiptr)(vertexCount * kVertexSize), vertices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(indexOffset * sizeof(uint32_t)), (GLsizeiptr)(indexCount * sizeof(uint32_t)), indices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        range.baseVertex = (int32_t)vertexOffset;
+        range.vertexCount = vertexCount;
+        range.firstIndex = indexOffset;
+        range.indexCount = indexCount;
+        m_vertexUsed += vertexCount;
+        m_indexUsed += indexCount;
+        ++m_allocations;
+        return range;
+    }
+
+    void GeometryArena::free(const GeometryRange& range)
+    {
+        if (!m_vao || !range.valid()) return;
+        releaseBlock(m_freeVertices, (uint32_t)range.baseVertex, range.vertexCount);
+        releaseBlock(m_freeIndices, range.firstIndex, range.indexCount);
+        m_vertexUsed -= range.vertexCount;
+        m_indexUsed -= range.indexCount;
+        --m_allocations;
+    }
+
+    void GeometryArena::bind() const
+    {
+        glBindVertexArray(m_vao);
+    }
+
+    void GeometryArena::setupInstanceAttributes(uint32_t baseInstance) const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceStream.id());
+        const size_t base = (size_t)baseInstance * sizeof(glm::mat4);
+        for (int i = 0; i < 4; ++i)
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(base + i * 4 * sizeof(float)));
+    }
+
+    void GeometryArena::syncInstanceBuffer()
+    {
+        if (m_instanceGeneration == m_instanceStream.generation()) return;
+        m_instanceGeneration = m_instanceStream.generation();
+        glBindVertexArray(m_vao);
+        setupInstanceAttributes(0);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void GeometryArena::reserveInstances(int count)
+    {
+        if (count <= 0 || !ensureCreated()) return;
+        m_instanceStream.reserve((size_t)count * sizeof(glm::mat4), sizeof(glm::mat4));
+        syncInstanceBuffer();
+    }
+
+    glm::mat4* GeometryArena::mapInstances(int count, uint32_t& baseInstance)
+    {
+        baseInstance = 0;
+        if (count <= 0 || !ensureCreated()) return nullptr;
+        size_t offset = 0;
+        // matrix-aligned, so the byte offset is a whole instance index
+        void* dst = m_instanceStream.allocate((size_t)count * sizeof(glm::mat4), sizeof(glm::mat4), offset);
+        syncInstanceBuffer();
+        baseInstance = (uint32_t)(offset / sizeof(glm::mat4));
+        return static_cast<glm::mat4*>(dst);
+    }
+
+    void GeometryArena::flushInstances()
+    {
+        m_instanceStream.flush();
+    }
+
+    uint32_t GeometryArena::uploadInstances(const glm::mat4* matrices, int count)
+    {
+        uint32_t base = 0;
+        glm::mat4* dst = mapInstances(count, base);
+        if (!dst) return 0;
+        std::memcpy(dst, matrices, (size_t)count * sizeof(glm::mat4));
+        flushInstances();
+        return base;
+    }
+
+    void GeometryArena::draw(const GeometryRange& range) const
+    {
+        if (!m_vao || !range.valid()) return;
+        glBindVertexArray(m_vao);
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT,
+                                 (void*)(range.firstIndex * sizeof(uint32_t)), range.baseVertex);
+        ++renderStats().drawCalls;
+    }
+
+    void GeometryArena::drawInstanced(const GeometryRange& range, int count, uint32_t baseInstance) const
+    {
+        if (!m_vao || !range.valid() || count <= 0) return;
+        glBindVertexArray(m_vao);
+        const void* first = (void*)(range.firstIndex * sizeof(uint32_t));
+        if (m_hasBaseInstance)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT, first,
+                                                          count, range.baseVertex, baseInstance);
+        }
+        else
+        {
+            setupInstanceAttributes(baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT, first,
+                                              count, range.baseVertex);
+        }
+        ++renderStats().drawCalls;
+    }
+
+    void GeometryArena::drawIndirect(const DrawIndirectCommand* commands, int count)
+    {
+        if (!m_vao || count <= 0) return;
+        if (!m_hasMDI)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                const DrawIndirectCommand& c = commands[i];
+                GeometryRange range;
+                range.baseVertex = c.baseVertex;
+                range.firstIndex = c.firstIndex;
+                range.indexCount = c.count;
+                drawInstanced(range, (int)c.instanceCount, c.baseInstance);
+            }
+            glBindVertexArray(0);
+            return;
+        }
+        const size_t bytes = (size_t)count * sizeof(DrawIndirectCommand);
+        size_t offset = 0;
+        void* dst = m_indirectStream.allocate(bytes, sizeof(uint32_t), offset);
+        if (!dst) return;
+        std::memcpy(dst, commands, bytes);
+        m_indirectStream.flush();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectStream.id());
+        glBindVertexArray(m_vao);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, count, 0);
+        ++renderStats().drawCalls;
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
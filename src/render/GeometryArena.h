@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "render/StreamBuffer.h"
+
+namespace engine
+{
+    // Where a mesh lives inside the arena buffers
+    struct GeometryRange
+    {
+        int32_t baseVertex = 0;
+        uint32_t vertexCount = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        bool valid() const { return indexCount > 0; }
+    };
+
+    // Layout of glMultiDrawElementsIndirect commands
+    struct DrawIndirectCommand
+    {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    // Shared vertex/index buffers for every Mesh (position, normal, uv: 8 floats per vertex).
+    // All meshes draw through one VAO; per-instance model matrices (attributes 3-6) are streamed
+    // into a StreamBuffer and addressed through baseInstance, so a whole pass can be one
+    // glMultiDrawElementsIndirect when the context has GL 4.3.
+    class GeometryArena
+    {
+    public:
+        static GeometryArena& instance();
+
+        GeometryArena(const GeometryArena&) = delete;
+        GeometryArena& operator=(const GeometryArena&) = delete;
+
+        // Both return an invalid range / do nothing once destroyed
+        GeometryRange allocate(const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+        void free(const GeometryRange& range);
+        // Releases the GL objects (before the context goes away)
+        void destroy();
+
+        void bind() const;
+        unsigned int vao() const { return m_vao; }
+
+        // Space for count matrices in the instance stream, written in place; baseInstance is the
+        // instance index of the first. Call flushInstances() before drawing.
+        // reserveInstances(n) first guarantees the next n stay valid until they are drawn.
+        void reserveInstances(int count);
+        glm::mat4* mapInstances(int count, uint32_t& baseInstance);
+        void flushInstances();
+        uint32_t uploadInstances(const glm::mat4* matrices, int count);
+
+        void draw(const GeometryRange& range) const;
+        void drawInstanced(const GeometryRange& range, int count, uint32_t baseInstance) const;
+        // One multi-draw with GL 4.3, one draw per command otherwise. Binds the arena VAO.
+        void drawIndirect(const DrawIndirectCommand* commands, int count);
+
+        bool multiDrawIndirect() const { return m_hasMDI; }
+        size_t vertexBytesUsed() const { return (size_t)m_vertexUsed * kVertexSize; }
+        size_t vertexBytesCapacity() const { return (size_t)m_vertexCapacity * kVertexSize; }
+        size_t indexBytesUsed() const { return (size_t)m_indexUsed * sizeof(uint32_t); }
+        int allocationCount() const { return m_allocations; }
+
+    private:
+        GeometryArena() = default;
+
+        struct Block { uint32_t offset; uint32_t size; };
+        static constexpr size_t kVertexSize = 8 * sizeof(float);
+
+        bool ensureCreated();
+        void setupInstanceAttributes(uint32_t baseInstance) const;
+        // re-points attributes 3-6 after the instance stream replaced its buffer
+        void syncInstanceBuffer();
+        static bool takeBlock(std::vector<Block>& freeList, uint32_t size, uint32_t& offset);
+        static void releaseBlock(std::vector<Block>& freeList, uint32_t offset, uint32_t size);
+        // Grows a buffer to at least minCapacity elements, keeping its contents
+        void grow(unsigned int& buffer, unsigned int target, uint32_t& capacity, uint32_t minCapacity,
+                  size_t elementSize, std::vector<Block>& freeList);
+
+    private:
+        unsigned int m_vao = 0;
+        unsigned int m_vbo = 0;
+        unsigned int m_ebo = 0;
+        bool m_destroyed = false;
+        bool m_hasMDI = false;
+        bool m_hasBaseInstance = false;
+
+        uint32_t m_vertexCapacity = 0; // in vertices
+        uint32_t m_indexCapacity = 0;  // in indices
+        uint32_t m_vertexUsed = 0;
+        uint32_t m_indexUsed = 0;
+        int m_allocations = 0;
+        std::vector<Block> m_freeVertices; // sorted by offset, coalesced
+        std::vector<Block> m_freeIndices;
+
+        StreamBuffer m_instanceStream;
+        StreamBuffer m_indirectStream;
+        uint32_t m_instanceGeneration = 0; // stream buffer the VAO points at
+    };
+}
@@ -0,0 +1,112 @@
+#include "render/GpuTimer.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+
+namespace engine
+{
+    GpuTimer* GpuTimer::s_active = nullptr;
+
+    GpuTimer::~GpuTimer()
+    {
+        destroy();
+    }
+
+    unsigned int GpuTimer::acquireQuery(Frame& f)
+    {
+        if (f.used == (int)f.pool.size())
+        {
+            GLuint q = 0;
+            glGenQueries(1, &q);
+            f.pool.push_back(q);
+        }
+        return f.pool[f.used++];
+    }
+
+    void GpuTimer::beginFrame()
+    {
+        m_inFrame = false;
+        m_stack.clear();
+        if (!m_enabled) return;
+        Frame& f = m_frames[m_frameIndex % kFrameLatency];
+        if (f.pending)
+        {
+            // Queries complete in order; the last end stamp is the one to check
+            GLint available = 0;
+            glGetQueryObjectiv(f.pairs.back().q1, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                m_results.clear();
+                GLuint64 first = ~(GLuint64)0, last = 0;
+                for (const Pair& p : f.pairs)
+                {
+                    GLuint64 t0 = 0, t1 = 0;
+                    glGetQueryObjectui64v(p.q0, GL_QUERY_RESULT, &t0);
+                    glGetQueryObjectui64v(p.q1, GL_QUERY_RESULT, &t1);
+                    m_results.push_back({ p.name, p.depth, t1 > t0 ? (double)(t1 - t0) / 1.0e6 : 0.0 });
+                    first = std::min(first, t0);
+                    last = std::max(last, t1);
+                }
+                m_frameMs = last > first ? (double)(last - first) / 1.0e6 : 0.0;
+            }
+            else
+            {
+                ++m_dropped;
+            }
+        }
+        f.pairs.clear();
+        f.used = 0;
+        f.pending = false;
+        m_inFrame = true;
+    }
+
+    void GpuTimer::endFrame()
+    {
+        if (!m_inFrame) return;
+        while (!m_stack.empty()) end();
+        Frame& f = m_frames[m_frameIndex % kFrameLatency];
+        f.pending = !f.pairs.empty();
+        ++m_frameIndex;
+        m_inFrame = false;
+    }
+
+    void GpuTimer::begin(const char* name)
+    {
+        if (!m_inFrame) { m_stack.push_back(-1); return; }
+        Frame& f = m_frames[m_frameIndex % kFrameLatency];
+        Pair p;
+        p.name = name;
+        p.depth = (unsigned int)m_stack.size();
+        p.q0 = acquireQuery(f);
+        p.q1 = acquireQuery(f);
+        glQueryCounter(p.q0, GL_TIMESTAMP);
+        m_stack.push_back((int)f.pairs.size());
+        f.pairs.push_back(p);
+    }
+
+    void GpuTimer::end()
+    {
+        if (m_stack.empty()) return;
+        int idx = m_stack.back();
+        m_stack.pop_back();
+        if (idx < 0 || !m_inFrame) return;
+        Frame& f = m_frames[m_frameIndex % kFrameLatency];
+        glQueryCounter(f.pairs[idx].q1, GL_TIMESTAMP);
+    }
+
+    void GpuTimer::destroy()
+    {
+        for (Frame& f : m_frames)
+        {
+            if (!f.pool.empty()) glDeleteQueries((GLsizei)f.pool.size(), f.pool.data());
+            f.pool.clear();
+            f.pairs.clear();
+            f.used = 0;
+            f.pending = false;
+        }
+        m_results.clear();
+        m_stack.clear();
+        m_inFrame = false;
+        if (s_active == this) s_active = nullptr;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+namespace engine
+{
+    // Measured GPU time of one pass (results are kFrameLatency frames old)
+    struct GpuZone
+    {
+        const char* name;
+        unsigned int depth;
+        double ms;
+    };
+
+    // GPU pass timing with GL_TIMESTAMP query pairs (pairs nest, unlike GL_TIME_ELAPSED).
+    // Each frame's queries are read back kFrameLatency frames later, and only if
+    // already available, so it never stalls the pipeline.
+    class GpuTimer
+    {
+    public:
+        static const int kFrameLatency = 4;
+
+        GpuTimer() = default;
+        ~GpuTimer();
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool enabled() const { return m_enabled; }
+
+        // Frame boundaries; beginFrame collects the oldest frame's results
+        void beginFrame();
+        void endFrame();
+
+        // name must be a string literal (stored by pointer)
+        void begin(const char* name);
+        void end();
+
+        const std::vector<GpuZone>& results() const { return m_results; }
+        double frameMs() const { return m_frameMs; }
+        // frames whose queries were not ready in time (results skipped)
+        int droppedFrames() const { return m_dropped; }
+
+        void destroy();
+
+        // Instance used by GPU_SCOPE (set by the owner, may be null)
+        static GpuTimer* active() { return s_active; }
+        static void setActive(GpuTimer* timer) { s_active = timer; }
+
+    private:
+        struct Pair { const char* name; unsigned int depth; unsigned int q0; unsigned int q1; };
+        struct Frame
+        {
+            std::vector<unsigned int> pool; // query objects, reused
+            std::vector<Pair> pairs;
+            int used = 0;
+            bool pending = false;
+        };
+        unsigned int acquireQuery(Frame& f);
+
+    private:
+        bool m_enabled = true;
+        bool m_inFrame = false;
+        Frame m_frames[kFrameLatency];
+        int m_frameIndex = 0;
+        std::vector<int> m_stack; // open pair indices
+        std::vector<GpuZone> m_results;
+        double m_frameMs = 0.0;
+        int m_dropped = 0;
+        static GpuTimer* s_active;
+    };
+
+    class GpuScope
+    {
+    public:
+        explicit GpuScope(const char* name)
+            : m_timer(GpuTimer::active())
+        {
+            if (m_timer && m_timer->enabled()) m_timer->begin(name); else m_timer = nullptr;
+        }
+        ~GpuScope() { stop(); }
+        void stop() { if (m_timer) { m_timer->end(); m_timer = nullptr; } }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        GpuTimer* m_timer;
+    };
+}
+
+#define GPU_SCOPE_CONCAT_INNER(a, b) a##b
+#define GPU_SCOPE_CONCAT(a, b) GPU_SCOPE_CONCAT_INNER(a, b)
+#define GPU_SCOPE(name) ::engine::GpuScope GPU_SCOPE_CONCAT(gpuScope_, __LINE__)(name)
+// CPU zone + GPU timer with the same name (shown side by side in the profiler panel)
+#define PROFILE_GPU_SCOPE(name) PROFILE_SCOPE(name); GPU_SCOPE(name)
@@ -1,5 +1,6 @@
 #include "render/IBL.h"
 #include "render/Shader.h"
+#include "core/Profiler.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -85,6 +86,7 @@ namespace engine
 
     bool IBL::createFromHDR(const std::string& hdrPath)
     {
+        PROFILE_SCOPE("IBL::createFromHDR");
         destroy();
         createCapture();
 
@@ -0,0 +1,204 @@
+#include "render/LightClusters.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ENGINE_CLUSTER_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_CLUSTER_SSE 1
+#endif
+
+namespace engine
+{
+    static const int kParallelMinLights = 64; // fewer lights are binned on the calling thread
+
+    void LightClusters::setGrid(int x, int y, int z)
+    {
+        x = std::max(x, 1); y = std::max(y, 1); z = std::max(z, 1);
+        if (x == m_gridX && y == m_gridY && z == m_gridZ && !m_slices.empty()) return;
+        m_gridX = x; m_gridY = y; m_gridZ = z;
+        m_boundsProj = glm::mat4(0.0f);
+        m_slices.clear();
+    }
+
+    int LightClusters::sliceOf(float depth) const
+    {
+        if (depth <= 0.0f) return 0;
+        const int s = (int)std::floor(std::log(depth) * m_zScale + m_zBias);
+        return std::min(std::max(s, 0), m_gridZ - 1);
+    }
+
+    // Slice depths and the view-space box of every cluster; they only change with the projection
+    void LightClusters::rebuildBounds(const glm::mat4& proj)
+    {
+        m_boundsProj = proj;
+        // near/far back from glm::perspective: [2][2] = -(f+n)/(f-n), [3][2] = -2fn/(f-n)
+        const float zNear = std::max(proj[3][2] / (proj[2][2] - 1.0f), 1e-4f);
+        const float zFar = std::max(proj[3][2] / (proj[2][2] + 1.0f), zNear * 1.001f);
+        const float logRatio = std::log(zFar / zNear);
+        m_zScale = (float)m_gridZ / logRatio;
+        m_zBias = -(float)m_gridZ * std::log(zNear) / logRatio;
+
+        m_sliceNear.resize(m_gridZ);
+        m_sliceFar.resize(m_gridZ);
+        for (int z = 0; z < m_gridZ; ++z)
+        {
+            m_sliceNear[z] = zNear * std::pow(zFar / zNear, (float)z / (float)m_gridZ);
+            m_sliceFar[z] = zNear * std::pow(zFar / zNear, (float)(z + 1) / (float)m_gridZ);
+        }
+        // exact far plane: lights entirely beyond it touch no cluster
+        m_sliceFar[m_gridZ - 1] = zFar;
+
+        const int n = clusterCount();
+        m_boundsMin.resize(n);
+        m_boundsMax.resize(n);
+        const float invX = 1.0f / proj[0][0], invY = 1.0f / proj[1][1];
+        for (int z = 0; z < m_gridZ; ++z)
+        {
+            const float depths[2] = { m_sliceNear[z], m_sliceFar[z] };
+            for (int y = 0; y < m_gridY; ++y)
+            {
+                for (int x = 0; x < m_gridX; ++x)
+                {
+                    // tile edges in NDC, scaled by depth into view space
+                    const float nx[2] = { -1.0f + 2.0f * x / m_gridX, -1.0f + 2.0f * (x + 1) / m_gridX };
+                    const float ny[2] = { -1.0f + 2.0f * y / m_gridY, -1.0f + 2.0f * (y + 1) / m_gridY };
+                    glm::vec3 mn(1e30f), mx(-1e30f);
+                    for (float d : depths)
+                    {
+                        for (int i = 0; i < 2; ++i)
+                        {
+                            mn.x = std::min(mn.x, nx[i] * d * invX); mx.x = std::max(mx.x, nx[i] * d * invX);
+                            mn.y = std::min(mn.y, ny[i] * d * invY); mx.y = std::max(mx.y, ny[i] * d * invY);
+                        }
+                    }
+                    mn.z = -m_sliceFar[z];
+                    mx.z = -m_sliceNear[z];
+                    m_boundsMin[clusterIndex(x, y, z)] = mn;
+                    m_boundsMax[clusterIndex(x, y, z)] = mx;
+                }
+            }
+        }
+    }
+
+    void LightClusters::build(const glm::mat4& view, const glm::mat4& proj, const glm::vec4* spheres, int count, JobSystem* jobs)
+    {
+        PROFILE_SCOPE("light_clusters");
+        if (m_slices.size() != (size_t)m_gridZ) m_slices.resize(m_gridZ);
+        if (proj != m_boundsProj) rebuildBounds(proj);
+
+        m_count = std::max(count, 0);
+        m_x.resize(m_count); m_y.resize(m_count); m_z.resize(m_count); m_r.resize(m_count);
+        for (int i = 0; i < m_count; ++i)
+        {
+            const glm::vec4 c = view * glm::vec4(spheres[i].x, spheres[i].y, spheres[i].z, 1.0f);
+            m_x[i] = c.x; m_y[i] = c.y; m_z[i] = c.z; m_r[i] = spheres[i].w;
+        }
+
+        if (jobs && m_count >= kParallelMinLights)
+            jobs->parallelFor(m_gridZ, 1, [&](int b, int e) { for (int z = b; z < e; ++z) binSlice(z); });
+        else
+            for (int z = 0; z < m_gridZ; ++z) binSlice(z);
+
+        // slices are contiguous in cluster order: concatenate, rebasing their offsets
+        const int perSlice = m_gridX * m_gridY;
+        m_cells.resize((size_t)clusterCount() * 2);
+        m_indices.clear();
+        for (int z = 0; z < m_gridZ; ++z)
+        {
+            const Slice& s = m_slices[z];
+            const uint32_t base = (uint32_t)m_indices.size();
+            for (int c = 0; c < perSlice; ++c)
+            {
+                m_cells[(size_t)(z * perSlice + c) * 2] = base + s.cells[c * 2];
+                m_cells[(size_t)(z * perSlice + c) * 2 + 1] = s.cells[c * 2 + 1];
+            }
+            m_indices.insert(m_indices.end(), s.indices.begin(), s.indices.end());
+        }
+    }
+
+    // Lights of one slice against each of its clusters, sphere/box distance 8 or 4 at a time
+    void LightClusters::binSlice(int z)
+    {
+        Slice& s = m_slices[z];
+        s.lights.clear();
+        s.x.clear(); s.y.clear(); s.z.clear(); s.r2.clear();
+        s.indices.clear();
+        s.cells.assign((size_t)m_gridX * m_gridY * 2, 0);
+
+        const float sliceNear = m_sliceNear[z], sliceFar = m_sliceFar[z];
+        for (int i = 0; i < m_count; ++i)
+        {
+            const float depth = -m_z[i];
+            if (depth + m_r[i] < sliceNear || depth - m_r[i] > sliceFar) continue;
+            s.lights.push_back(i);
+            s.x.push_back(m_x[i]); s.y.push_back(m_y[i]); s.z.push_back(m_z[i]); s.r2.push_back(m_r[i] * m_r[i]);
+        }
+        if (s.lights.empty()) return;
+        // negative squared radius: never inside, so the SIMD loops need no tail
+        const size_t padded = (s.lights.size() + 7) & ~size_t(7);
+        s.x.resize(padded, 0.0f); s.y.resize(padded, 0.0f); s.z.resize(padded, 0.0f); s.r2.resize(padded, -1.0f);
+        const int n = (int)padded;
+        const float* xs = s.x.data(); const float* ys = s.y.data();
+        const float* zs = s.z.data(); const float* rs = s.r2.data();
+
+        for (int c = 0; c < m_gridX * m_gridY; ++c)
+        {
+            const glm::vec3& mn = m_boundsMin[z * m_gridX * m_gridY + c];
+            const glm::vec3& mx = m_boundsMax[z * m_gridX * m_gridY + c];
+            s.cells[c * 2] = (uint32_t)s.indices.size();
+            int i = 0;
+#if defined(ENGINE_CLUSTER_AVX)
+            if (m_simd)
+            {
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 minX = _mm256_set1_ps(mn.x), minY = _mm256_set1_ps(mn.y), minZ = _mm256_set1_ps(mn.z);
+                const __m256 maxX = _mm256_set1_ps(mx.x), maxY = _mm256_set1_ps(mx.y), maxZ = _mm256_set1_ps(mx.z);
+                for (; i + 8 <= n; i += 8)
+                {
+                    // distance outside the box per axis: one of the two terms is zero
+                    __m256 cx = _mm256_loadu_ps(xs + i), cy = _mm256_loadu_ps(ys + i), cz = _mm256_loadu_ps(zs + i);
+                    __m256 dx = _mm256_add_ps(_mm256_max_ps(_mm256_sub_ps(minX, cx), zero), _mm256_max_ps(_mm256_sub_ps(cx, maxX), zero));
+                    __m256 dy = _mm256_add_ps(_mm256_max_ps(_mm256_sub_ps(minY, cy), zero), _mm256_max_ps(_mm256_sub_ps(cy, maxY), zero));
+                    __m256 dz = _mm256_add_ps(_mm256_max_ps(_mm256_sub_ps(minZ, cz), zero), _mm256_max_ps(_mm256_sub_ps(cz, maxZ), zero));
+                    __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+                    int bits = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_loadu_ps(rs + i), _CMP_LE_OQ));
+                    for (int k = 0; k < 8; ++k)
+                        if ((bits >> k) & 1) s.indices.push_back((uint32_t)s.lights[i + k]);
+                }
+            }
+#elif defined(ENGINE_CLUSTER_SSE)
+            if (m_simd)
+            {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 minX = _mm_set1_ps(mn.x), minY = _mm_set1_ps(mn.y), minZ = _mm_set1_ps(mn.z);
+                const __m128 maxX = _mm_set1_ps(mx.x), maxY = _mm_set1_ps(mx.y), maxZ = _mm_set1_ps(mx.z);
+                for (; i + 4 <= n; i += 4)
+                {
+                    __m128 cx = _mm_loadu_ps(xs + i), cy = _mm_loadu_ps(ys + i), cz = _mm_loadu_ps(zs + i);
+                    __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minX, cx), zero), _mm_max_ps(_mm_sub_ps(cx, maxX), zero));
+                    __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minY, cy), zero), _mm_max_ps(_mm_sub_ps(cy, maxY), zero));
+                    __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(minZ, cz), zero), _mm_max_ps(_mm_sub_ps(cz, maxZ), zero));
+                    __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                    int bits = _mm_movemask_ps(_mm_cmple_ps(d2, _mm_loadu_ps(rs + i)));
+                    for (int k = 0; k < 4; ++k)
+                        if ((bits >> k) & 1) s.indices.push_back((uint32_t)s.lights[i + k]);
+                }
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                const float dx = std::max(mn.x - xs[i], 0.0f) + std::max(xs[i] - mx.x, 0.0f);
+                const float dy = std::max(mn.y - ys[i], 0.0f) + std::max(ys[i] - mx.y, 0.0f);
+                const float dz = std::max(mn.z - zs[i], 0.0f) + std::max(zs[i] - mx.z, 0.0f);
+                if (dx * dx + dy * dy + dz * dz <= rs[i]) s.indices.push_back((uint32_t)s.lights[i]);
+            }
+            s.cells[c * 2 + 1] = (uint32_t)s.indices.size() - s.cells[c * 2];
+        }
+    }
+}
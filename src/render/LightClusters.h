@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace engine
+{
+    class JobSystem;
+
+    // Froxel grid over the camera frustum: x * y screen tiles, z slices spaced exponentially in
+    // view depth. build() bins bounding spheres of lights into the clusters they touch; it uses no
+    // GL, the results are plain arrays for the caller to upload.
+    class LightClusters
+    {
+    public:
+        void setGrid(int x, int y, int z);
+        int gridX() const { return m_gridX; }
+        int gridY() const { return m_gridY; }
+        int gridZ() const { return m_gridZ; }
+        int clusterCount() const { return m_gridX * m_gridY * m_gridZ; }
+        // false: scalar binning even where SSE/AVX is compiled in (same results)
+        void setSimd(bool enabled) { m_simd = enabled; }
+
+        // spheres are world-space (x, y, z, radius); proj is a perspective projection as made by
+        // glm::perspective. With jobs, slices are binned in parallel.
+        void build(const glm::mat4& view, const glm::mat4& proj, const glm::vec4* spheres, int count, JobSystem* jobs = nullptr);
+
+        // Per cluster (x fastest, then y, then z): offset into lightIndices() and light count
+        const std::vector<uint32_t>& cells() const { return m_cells; }
+        const std::vector<uint32_t>& lightIndices() const { return m_indices; }
+
+        int clusterIndex(int x, int y, int z) const { return (z * m_gridY + y) * m_gridX + x; }
+        // slice of a view depth (positive in front of the camera) as the fragment shader finds
+        // it: floor(log(depth) * zScale + zBias), clamped to the grid
+        int sliceOf(float depth) const;
+        float zScale() const { return m_zScale; }
+        float zBias() const { return m_zBias; }
+
+    private:
+        void rebuildBounds(const glm::mat4& proj);
+        void binSlice(int z);
+
+    private:
+        int m_gridX = 16, m_gridY = 9, m_gridZ = 24;
+        bool m_simd = true;
+        glm::mat4 m_boundsProj{0.0f}; // projection the bounds were built for
+        float m_zScale = 0.0f, m_zBias = 0.0f;
+        std::vector<float> m_sliceNear, m_sliceFar;  // view depth of each slice
+        std::vector<glm::vec3> m_boundsMin, m_boundsMax; // view-space AABB per cluster
+
+        // view-space spheres, one array per component, padded for the SIMD loop
+        std::vector<float> m_x, m_y, m_z, m_r;
+        int m_count = 0;
+
+        struct Slice
+        {
+            std::vector<int> lights; // touching the slice's depth range
+            std::vector<float> x, y, z, r2;
+            std::vector<uint32_t> cells;   // offset into indices, count
+            std::vector<uint32_t> indices;
+        };
+        std::vector<Slice> m_slices;
+
+        std::vector<uint32_t> m_cells;
+        std::vector<uint32_t> m_indices;
+    };
+}
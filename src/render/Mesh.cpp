@@ -1,6 +1,8 @@
 #include "render/Mesh.h"
 
 #include <glad/glad.h>
+#include <cmath>
+#include <iostream>
 
 namespace engine
 {
@@ -8,95 +10,70 @@ namespace engine
 
     Mesh::Mesh(Mesh&& other) noexcept
     {
-        m_vao = other.m_vao; other.m_vao = 0;
-        m_vbo = other.m_vbo; other.m_vbo = 0;
-        m_ebo = other.m_ebo; other.m_ebo = 0;
-        m_indexCount = other.m_indexCount; other.m_indexCount = 0;
+        m_range = other.m_range; other.m_range = GeometryRange{};
+        m_instanceBase = other.m_instanceBase;
+        m_boundingRadius = other.m_boundingRadius;
     }
 
     Mesh& Mesh::operator=(Mesh&& other) noexcept
     {
         if (this == &other) return *this;
         destroy();
-        m_vao = other.m_vao; other.m_vao = 0;
-        m_vbo = other.m_vbo; other.m_vbo = 0;
-        m_ebo = other.m_ebo; other.m_ebo = 0;
-        m_indexCount = other.m_indexCount; other.m_indexCount = 0;
+        m_range = other.m_range; other.m_range = GeometryRange{};
+        m_instanceBase = other.m_instanceBase;
+        m_boundingRadius = other.m_boundingRadius;
         return *this;
     }
 
     bool Mesh::create(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
     {
-        m_indexCount = static_cast<unsigned int>(indices.size());
-
-        glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
-        glGenBuffers(1, &m_ebo);
-
-        glBindVertexArray(m_vao);
-
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-        // layout: position (0), normal (1), uv (2)
-        GLsizei stride = 8 * sizeof(float);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        destroy();
+        float maxLen2 = 0.0f;
+        for (size_t i = 0; i + 2 < vertices.size(); i += 8)
+        {
+            float l2 = vertices[i]*vertices[i] + vertices[i+1]*vertices[i+1] + vertices[i+2]*vertices[i+2];
+            if (l2 > maxLen2) maxLen2 = l2;
+        }
+        m_boundingRadius = std::sqrt(maxLen2);
 
-        glBindVertexArray(0);
+        m_range = GeometryArena::instance().allocate(vertices, indices);
+        if (!m_range.valid())
+        {
+            std::cerr << "[Mesh] Failed to allocate " << indices.size() << " indices in the geometry arena" << std::endl;
+            return false;
+        }
         return true;
     }
 
     void Mesh::draw() const
     {
-        glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
+        GeometryArena::instance().draw(m_range);
         glBindVertexArray(0);
     }
 
     void Mesh::drawInstanced(int count) const
     {
-        glBindVertexArray(m_vao);
-        glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0, count);
+        GeometryArena::instance().drawInstanced(m_range, count, m_instanceBase);
         glBindVertexArray(0);
     }
 
     bool Mesh::setInstanceTransforms(const std::vector<glm::mat4>& instanceMatrices)
     {
-        if (m_vao == 0) return false;
-        if (m_instanceVBO == 0)
-            glGenBuffers(1, &m_instanceVBO);
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
-        glBufferData(GL_ARRAY_BUFFER, instanceMatrices.size()*sizeof(glm::mat4), instanceMatrices.data(), GL_DYNAMIC_DRAW);
-        // set attributes 3,4,5,6 as mat4 (vec4 per column)
-        std::size_t vec4Size = sizeof(float)*4;
-        for (int i=0;i<4;++i)
-        {
-            glEnableVertexAttribArray(3+i);
-            glVertexAttribPointer(3+i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i*vec4Size));
-            glVertexAttribDivisor(3+i, 1);
-        }
-        glBindVertexArray(0);
+        return setInstanceTransforms(instanceMatrices.data(), (int)instanceMatrices.size());
+    }
+
+    bool Mesh::setInstanceTransforms(const glm::mat4* matrices, int count)
+    {
+        if (!m_range.valid() || count <= 0) return false;
+        m_instanceBase = GeometryArena::instance().uploadInstances(matrices, count);
         return true;
     }
 
     void Mesh::destroy()
     {
-        if (m_instanceVBO) { glDeleteBuffers(1, &m_instanceVBO); m_instanceVBO = 0; }
-        if (m_ebo) { glDeleteBuffers(1, &m_ebo); m_ebo = 0; }
-        if (m_vbo) { glDeleteBuffers(1, &m_vbo); m_vbo = 0; }
-        if (m_vao) { glDeleteVertexArrays(1, &m_vao); m_vao = 0; }
-        m_indexCount = 0;
+        GeometryArena::instance().free(m_range);
+        m_range = GeometryRange{};
+        m_instanceBase = 0;
     }
 
     Mesh Mesh::createCube()
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include <glm/glm.hpp>
+#include "render/GeometryArena.h"
 
 namespace engine
 {
@@ -20,18 +22,25 @@ namespace engine
         bool create(const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
         void draw() const;
         void drawInstanced(int count) const;
+        // Per-instance model matrices at attributes 3-6, appended to the arena instance stream;
+        // drawInstanced() uses the latest upload
         bool setInstanceTransforms(const std::vector<glm::mat4>& instanceMatrices);
+        bool setInstanceTransforms(const glm::mat4* matrices, int count);
         void destroy();
 
+        // location of the mesh in GeometryArena (for indirect draws)
+        const GeometryRange& range() const { return m_range; }
+
+        // distance of the farthest vertex from the mesh origin (local space)
+        float boundingRadius() const { return m_boundingRadius; }
+
         static Mesh createCube();
         static Mesh createPlane();
 
     private:
-        unsigned int m_vao = 0;
-        unsigned int m_vbo = 0;
-        unsigned int m_ebo = 0;
-        unsigned int m_indexCount = 0;
-        unsigned int m_instanceVBO = 0;
+        GeometryRange m_range;
+        uint32_t m_instanceBase = 0; // first matrix of the last setInstanceTransforms
+        float m_boundingRadius = 0.0f;
     };
 }
 
@@ -1,9 +1,14 @@
 #include "render/ParticleSystem.h"
 #include "render/Shader.h"
+#include "render/UniformBuffer.h"
+#include "render/StreamBuffer.h"
+#include "core/Profiler.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
 
 namespace engine
 {
@@ -21,12 +26,10 @@ namespace engine
             layout (location = 0) in vec3 aPos;
             layout (location = 1) in float aLife;
             layout (location = 2) in float aSize;
-            uniform mat4 u_View;
-            uniform mat4 u_Proj;
             out float vLife;
             void main(){
                 vLife = aLife;
-                gl_Position = u_Proj * u_View * vec4(aPos, 1.0);
+                gl_Position = u_ViewProj * vec4(aPos, 1.0);
                 gl_PointSize = aSize;
             }
         )GLSL";
@@ -44,32 +47,40 @@ namespace engine
             }
         )GLSL";
         m_shader = std::make_unique<Shader>();
-        if (!m_shader->compileFromSource(vs, fs)) return false;
+        if (!m_shader->compileFromSource(withUniformBlocks(vs), withUniformBlocks(fs))) return false;
 
+        m_stream = std::make_unique<StreamBuffer>();
+        if (!m_stream->create(m_gpuBuffer.size() * sizeof(float))) return false;
         glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
         glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER, m_gpuBuffer.size() * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
-        // pos (3), life (1), size (1)
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(4 * sizeof(float)));
+        setupAttributes();
+        m_streamGeneration = m_stream->generation();
         glBindVertexArray(0);
         return true;
     }
 
+    void ParticleSystem::setupAttributes() const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_stream->id());
+        // pos (3), life (1), size (1)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(4 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
     void ParticleSystem::shutdown()
     {
-        if (m_vbo) { glDeleteBuffers(1, &m_vbo); m_vbo = 0; }
+        m_stream.reset();
         if (m_vao) { glDeleteVertexArrays(1, &m_vao); m_vao = 0; }
         m_shader.reset();
         m_particles.clear();
         m_gpuBuffer.clear();
         m_aliveCount = 0;
+        m_drawCount = 0;
         m_spawnAcc = 0.0f;
     }
 
@@ -91,7 +102,15 @@ namespace engine
 
     void ParticleSystem::update(float dt, bool emit, const glm::vec3& emitterPos, float spawnRate, float lifetime, float size, const glm::vec3& color, float gravityY, bool additiveBlend)
     {
-        m_color = color; m_additive = additiveBlend;
+        PROFILE_SCOPE("ParticleSystem::update");
+        setStyle(color, additiveBlend);
+        simulate(dt, emit, emitterPos, spawnRate, lifetime, size, gravityY);
+        upload(m_gpuBuffer.data(), m_aliveCount);
+    }
+
+    void ParticleSystem::simulate(float dt, bool emit, const glm::vec3& emitterPos, float spawnRate, float lifetime, float size, float gravityY)
+    {
+        PROFILE_SCOPE("ParticleSystem::simulate");
         // spawn
         if (emit)
         {
@@ -119,17 +138,33 @@ namespace engine
             m_gpuBuffer[o+4] = p.size;
             m_aliveCount++;
         }
-        // upload
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, m_aliveCount * 5 * sizeof(float), m_gpuBuffer.data());
     }
 
-    void ParticleSystem::draw(const float* proj, const float* view)
+    void ParticleSystem::upload(const float* packed, int count)
+    {
+        m_drawCount = std::min(count, m_maxCount);
+        if (m_drawCount <= 0 || !m_stream) return;
+        // vertex-aligned, so the upload is drawn from m_firstVertex
+        const size_t stride = 5 * sizeof(float);
+        size_t offset = 0;
+        void* dst = m_stream->allocate(m_drawCount * stride, stride, offset);
+        if (!dst) { m_drawCount = 0; return; }
+        std::memcpy(dst, packed, m_drawCount * stride);
+        m_stream->flush();
+        m_firstVertex = (int)(offset / stride);
+        if (m_streamGeneration != m_stream->generation())
+        {
+            m_streamGeneration = m_stream->generation();
+            glBindVertexArray(m_vao);
+            setupAttributes();
+            glBindVertexArray(0);
+        }
+    }
+
+    void ParticleSystem::draw()
     {
-        if (m_aliveCount <= 0) return;
+        if (m_drawCount <= 0) return;
         m_shader->bind();
-        m_shader->setMat4("u_Proj", proj);
-        m_shader->setMat4("u_View", view);
         m_shader->setVec3("u_Color", m_color.x, m_color.y, m_color.z);
         glEnable(GL_PROGRAM_POINT_SIZE);
         glEnable(GL_BLEND);
@@ -137,7 +172,7 @@ namespace engine
         else glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glDepthMask(GL_FALSE);
         glBindVertexArray(m_vao);
-        glDrawArrays(GL_POINTS, 0, m_aliveCount);
+        glDrawArrays(GL_POINTS, m_firstVertex, m_drawCount);
         glBindVertexArray(0);
         glDepthMask(GL_TRUE);
         glDisable(GL_BLEND);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <glm/vec3.hpp>
@@ -7,6 +8,7 @@
 namespace engine
 {
     class Shader;
+    class StreamBuffer;
 
     class ParticleSystem
     {
@@ -27,7 +29,16 @@ namespace engine
                     float gravityY,
                     bool additiveBlend);
 
-        void draw(const float* proj, const float* view);
+        // update() split for off-thread use: simulate() touches CPU state only,
+        // setStyle()/upload()/draw() must run on the GL thread
+        void simulate(float dt, bool emit, const glm::vec3& emitterPos, float spawnRate, float lifetime, float size, float gravityY);
+        const std::vector<float>& packed() const { return m_gpuBuffer; }
+        int packedCount() const { return m_aliveCount; }
+        void setStyle(const glm::vec3& color, bool additiveBlend) { m_color = color; m_additive = additiveBlend; }
+        void upload(const float* packed, int count);
+
+        // camera from the FrameData block
+        void draw();
 
     private:
         struct Particle
@@ -39,16 +50,20 @@ namespace engine
         };
 
         bool ensureGL();
+        void setupAttributes() const;
         void respawn(const glm::vec3& emitterPos, float lifetime, float size);
 
     private:
         std::unique_ptr<Shader> m_shader;
         unsigned int m_vao = 0;
-        unsigned int m_vbo = 0;
+        std::unique_ptr<StreamBuffer> m_stream; // packed particles, rewritten every frame
+        uint32_t m_streamGeneration = 0;
+        int m_firstVertex = 0; // of this frame's upload in the stream
         int m_maxCount = 0;
         std::vector<Particle> m_particles;
         std::vector<float> m_gpuBuffer; // packed: pos(3), life(1), size(1)
         int m_aliveCount = 0;
+        int m_drawCount = 0; // particles in the VBO
         float m_spawnAcc = 0.0f;
         glm::vec3 m_color = {1,1,1};
         bool m_additive = true;
@@ -15,24 +15,22 @@ namespace engine
         glGenFramebuffers(1, &m_fbo);
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
 
-        // Color cubemap to store distance
+        // Depth cubemap storing distance / far
         glGenTextures(1, &m_cubemapTex);
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_cubemapTex);
         for (int i = 0; i < 6; ++i)
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_R32F, size, size, 0, GL_RED, GL_FLOAT, nullptr);
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_NONE);
 
-        // Depth renderbuffer
-        glGenRenderbuffers(1, &m_depthRbo);
-        glBindRenderbuffer(GL_RENDERBUFFER, m_depthRbo);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRbo);
-
-        // attach face later in beginFace
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cubemapTex, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
         bool ok = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         return ok;
@@ -41,12 +39,16 @@ namespace engine
     void PointShadowMap::beginFace(int faceIndex)
     {
         glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceIndex, m_cubemapTex, 0);
-        GLenum drawBuf = GL_COLOR_ATTACHMENT0;
-        glDrawBuffers(1, &drawBuf);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceIndex, m_cubemapTex, 0);
+        glViewport(0, 0, m_size, m_size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    void PointShadowMap::beginLayered()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_cubemapTex, 0);
         glViewport(0, 0, m_size, m_size);
-        glClearColor(1e9f, 0, 0, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     void PointShadowMap::end(int restoreViewportWidth, int restoreViewportHeight)
@@ -63,11 +65,6 @@ namespace engine
 
     void PointShadowMap::destroy()
     {
-        if (m_depthRbo)
-        {
-            glDeleteRenderbuffers(1, &m_depthRbo);
-            m_depthRbo = 0;
-        }
         if (m_cubemapTex)
         {
             glDeleteTextures(1, &m_cubemapTex);
@@ -2,6 +2,8 @@
 
 namespace engine
 {
+    // Depth-only cube map holding linear distance to the light (distance / far, written by the
+    // point depth shaders through gl_FragDepth)
     class PointShadowMap
     {
     public:
@@ -9,8 +11,10 @@ namespace engine
         ~PointShadowMap();
 
         bool create(int size);
-        // Begin rendering into a cube face [0..5]
+        // Begin rendering into a cube face [0..5] (cleared)
         void beginFace(int faceIndex);
+        // Attaches the whole cube for one layered pass (gl_Layer selects the face); not cleared
+        void beginLayered();
         void end(int restoreViewportWidth, int restoreViewportHeight);
         void bindCubemap(int slot) const;
 
@@ -21,10 +25,7 @@ namespace engine
 
     private:
         unsigned int m_fbo = 0;
-        unsigned int m_depthRbo = 0;
-        unsigned int m_cubemapTex = 0; // GL_R32F color texture storing linear distance
+        unsigned int m_cubemapTex = 0; // GL_DEPTH_COMPONENT24 cube map
         int m_size = 0;
     };
 }
-
-
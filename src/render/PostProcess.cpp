@@ -1,5 +1,7 @@
 #include "render/PostProcess.h"
 #include "render/Shader.h"
+#include "core/Profiler.h"
+#include "render/GpuTimer.h"
 
 #include <glad/glad.h>
 
@@ -161,12 +163,14 @@ namespace engine
                           bool ssaoEnabled, float ssaoRadius, float ssaoBias, float ssaoPower,
                           bool taaEnabled, float taaAlpha)
     {
+        PROFILE_SCOPE("PostProcess::drawToScreen");
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glViewport(0, 0, screenWidth, screenHeight);
         glDisable(GL_DEPTH_TEST);
         // Simple bloom pre-pass: threshold into ping, blur ping->pong iterations
         if (bloomEnabled)
         {
+            PROFILE_GPU_SCOPE("bloom");
             // threshold into ping
             glBindFramebuffer(GL_FRAMEBUFFER, m_fbo); // reuse fbo color attachment changes via drawbuffers?
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pingTex, 0);
@@ -177,11 +181,15 @@ namespace engine
                 const char* bfs = "#version 330 core\nin vec2 vUV; out vec4 FragColor; uniform sampler2D u_Src; uniform float u_Threshold; void main(){ vec3 c=texture(u_Src,vUV).rgb; float l=max(max(c.r,c.g),c.b); FragColor=vec4(l>u_Threshold?c:vec3(0),1);}";
                 m_bloomShader = std::make_unique<Shader>(); m_bloomShader->compileFromSource(bvs, bfs);
             }
+            ProfileScope thresholdZone("bloom_threshold");
+            GpuScope thresholdGpu("bloom_threshold");
             m_bloomShader->bind();
             m_bloomShader->setInt("u_Src", 0); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, m_colorTex);
             m_bloomShader->setFloat("u_Threshold", bloomThreshold);
             glBindVertexArray(m_vao); glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); glBindVertexArray(0);
             m_bloomShader->unbind();
+            thresholdGpu.stop();
+            thresholdZone.stop();
             // blur ping->pong iterations
             if (!m_blurShader)
             {
@@ -189,8 +197,11 @@ namespace engine
                 const char* blfs = "#version 330 core\nin vec2 vUV; out vec4 FragColor; uniform sampler2D u_Src; uniform vec3 u_Dir; void main(){ vec2 texel=1.0/vec2(textureSize(u_Src,0)); vec3 s=vec3(0); float w[5]=float[](0.204164,0.304005,0.193783,0.072552,0.016996); for(int i=-4;i<=4;i++){ s+=texture(u_Src, vUV + u_Dir.xy*texel*i).rgb * w[abs(i)]; } FragColor=vec4(s,1);}";
                 m_blurShader = std::make_unique<Shader>(); m_blurShader->compileFromSource(blvs, blfs);
             }
+            static const char* blurNames[] = { "bloom_blur_0", "bloom_blur_1", "bloom_blur_2", "bloom_blur_3", "bloom_blur_4",
+                                               "bloom_blur_5", "bloom_blur_6", "bloom_blur_7", "bloom_blur_8", "bloom_blur_9" };
             for (int i=0;i<bloomIterations;i++)
             {
+                PROFILE_GPU_SCOPE(i < 10 ? blurNames[i] : "bloom_blur_n");
                 // horizontal
                 glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pongTex, 0);
                 m_blurShader->bind(); m_blurShader->setInt("u_Src",0); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, m_pingTex); m_blurShader->setVec3("u_Dir",1,0,0);
@@ -202,6 +213,9 @@ namespace engine
             }
         }
 
+        // tonemap + bloom add + TAA resolve + FXAA all happen in this one draw
+        ProfileScope compositeZone("composite");
+        GpuScope compositeGpu("composite");
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glViewport(0, 0, screenWidth, screenHeight);
         glDisable(GL_DEPTH_TEST);
@@ -227,9 +241,12 @@ namespace engine
         glBindVertexArray(0);
         m_shader->unbind();
         glEnable(GL_DEPTH_TEST);
+        compositeGpu.stop();
+        compositeZone.stop();
         // copy current color into history for next frame TAA
         if (taaEnabled)
         {
+            PROFILE_GPU_SCOPE("taa_history");
             glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexHistory, 0);
             glViewport(0, 0, m_width, m_height);
@@ -0,0 +1,65 @@
+#include "render/RenderQueue.h"
+
+#include <algorithm>
+
+namespace engine
+{
+    uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth01)
+    {
+        const uint32_t depthMax = (1u << kDepthBits) - 1;
+        float d = std::min(1.0f, std::max(0.0f, depth01));
+        uint64_t depth = (uint64_t)(d * (float)depthMax);
+        return ((uint64_t)(pass & 0xFu) << kPassShift)
+             | ((uint64_t)(shader & 0xFFu) << kShaderShift)
+             | ((uint64_t)(material & 0xFFFFu) << kMaterialShift)
+             | ((uint64_t)(mesh & 0xFFFFu) << kMeshShift)
+             | depth;
+    }
+
+    uint32_t RenderQueue::idOf(std::unordered_map<const void*, uint32_t>& ids, const void* p)
+    {
+        if (!p) return 0;
+        auto it = ids.find(p);
+        if (it != ids.end()) return it->second;
+        uint32_t id = (uint32_t)ids.size() + 1; // ids beyond 16 bits only share a key group
+        ids.emplace(p, id);
+        return id;
+    }
+
+    void RenderQueue::clear()
+    {
+        m_packets.clear();
+        m_materialIds.clear();
+        m_meshIds.clear();
+    }
+
+    void RenderQueue::sort()
+    {
+        const size_t n = m_packets.size();
+        if (n < 64)
+        {
+            std::sort(m_packets.begin(), m_packets.end(), [](const DrawPacket& a, const DrawPacket& b) { return a.key < b.key; });
+            return;
+        }
+        // bits that differ somewhere: only those digits need a pass
+        uint64_t all = 0, any = 0;
+        all = ~all;
+        for (const DrawPacket& p : m_packets) { all &= p.key; any |= p.key; }
+        const uint64_t varying = all ^ any;
+
+        m_scratch.resize(n);
+        DrawPacket* src = m_packets.data();
+        DrawPacket* dst = m_scratch.data();
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            if (((varying >> shift) & 0xFFu) == 0) continue;
+            size_t offsets[256] = {};
+            for (size_t i = 0; i < n; ++i) ++offsets[(src[i].key >> shift) & 0xFFu];
+            size_t sum = 0;
+            for (size_t& o : offsets) { size_t c = o; o = sum; sum += c; }
+            for (size_t i = 0; i < n; ++i) dst[offsets[(src[i].key >> shift) & 0xFFu]++] = src[i];
+            std::swap(src, dst);
+        }
+        if (src != m_packets.data()) m_packets.swap(m_scratch);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace engine
+{
+    // One queued draw: sort key + index of the item it draws (e.g. into RenderSnapshot::items)
+    struct DrawPacket
+    {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    // Per-frame draw list sorted by 64-bit keys, most significant field first:
+    //   pass (4) | shader (8) | material (16) | mesh (16) | depth (20)
+    // Submitting in key order lets the caller issue a state change only when the
+    // corresponding field differs from the previous packet.
+    class RenderQueue
+    {
+    public:
+        enum Pass : uint32_t { PassOpaque = 0, PassTransparent = 8 };
+
+        static constexpr int kDepthBits = 20;
+        static constexpr int kMeshShift = kDepthBits;
+        static constexpr int kMaterialShift = kMeshShift + 16;
+        static constexpr int kShaderShift = kMaterialShift + 16;
+        static constexpr int kPassShift = kShaderShift + 8;
+
+        // depth01: view depth / far, front to back (clamped to [0, 1])
+        static uint64_t makeKey(uint32_t pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth01);
+        static uint32_t shaderOf(uint64_t key) { return (uint32_t)(key >> kShaderShift) & 0xFFu; }
+        static uint32_t materialOf(uint64_t key) { return (uint32_t)(key >> kMaterialShift) & 0xFFFFu; }
+        static uint32_t meshOf(uint64_t key) { return (uint32_t)(key >> kMeshShift) & 0xFFFFu; }
+
+        // Drops the packets and the ids handed out by materialId()/meshId()
+        void clear();
+        void push(uint64_t key, uint32_t item) { m_packets.push_back({ key, item }); }
+        // Small per-frame ids for key fields, in first-seen order (0 = null)
+        uint32_t materialId(const void* state) { return idOf(m_materialIds, state); }
+        uint32_t meshId(const void* mesh) { return idOf(m_meshIds, mesh); }
+
+        // LSD radix sort on the key (8-bit digits, digits equal across all packets are skipped)
+        void sort();
+
+        const std::vector<DrawPacket>& packets() const { return m_packets; }
+        size_t size() const { return m_packets.size(); }
+
+    private:
+        static uint32_t idOf(std::unordered_map<const void*, uint32_t>& ids, const void* p);
+
+    private:
+        std::vector<DrawPacket> m_packets;
+        std::vector<DrawPacket> m_scratch;
+        std::unordered_map<const void*, uint32_t> m_materialIds;
+        std::unordered_map<const void*, uint32_t> m_meshIds;
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "render/FrustumCuller.h"
+
+namespace engine
+{
+    class Mesh;
+    class Texture2D;
+    class ParticleSystem;
+    struct MaterialAsset;
+
+    // One mesh draw with its model/normal matrices already resolved
+    struct RenderItem
+    {
+        glm::mat4 model;
+        glm::mat3 normal;
+        Mesh* mesh;
+        MaterialAsset* material;
+        Texture2D* albedoTex;
+        bool isStatic; // static rigid body: its shadow depth can be cached
+    };
+
+    // Packed particles of one system: pos(3), life(1), size(1)
+    struct ParticleBatch
+    {
+        ParticleSystem* system = nullptr;
+        std::vector<float> packed;
+        int count = 0;
+    };
+
+    // First directional/point/spot light of the registry (what the shaders consume)
+    struct LightSnapshot
+    {
+        bool hasDir = false;
+        glm::vec3 dirPos{0.0f};
+        glm::vec3 dirColor{1.0f};
+        bool hasPoint = false;
+        glm::vec3 pointPos{0.0f};
+        glm::vec3 pointColor{1.0f};
+        float pointRange = 25.0f;
+        bool hasSpot = false;
+        glm::vec3 spotPos{0.0f};
+        glm::vec3 spotDir{0.0f, -1.0f, 0.0f};
+        glm::vec3 spotColor{1.0f};
+        float spotInner = 15.0f;
+        float spotOuter = 25.0f;
+        float spotNear = 0.1f;
+        float spotFar = 40.0f;
+    };
+
+    // Any point or spot light of the registry (shadow atlas and PBR local lighting)
+    struct LocalLight
+    {
+        glm::vec3 position{0.0f};
+        glm::vec3 color{1.0f};
+        float range = 25.0f; // point range, spot far plane
+        bool isSpot = false;
+        glm::vec3 direction{0.0f, -1.0f, 0.0f};
+        float innerDegrees = 15.0f;
+        float outerDegrees = 25.0f;
+        float nearPlane = 0.1f;
+    };
+
+    // Render-relevant state of one frame. Render passes read only this, so in
+    // pipelined mode the next frame's simulation can fill the other copy.
+    struct RenderSnapshot
+    {
+        std::vector<RenderItem> items;
+        CullSpheres bounds; // world bounding sphere of items[i]
+        std::vector<glm::mat4> colliders; // debug boxes, unit cube scaled
+        LightSnapshot lights;
+        std::vector<LocalLight> localLights;
+        std::vector<glm::mat4> bonePalette;
+        std::vector<ParticleBatch> particles; // vectors kept for reuse across frames
+        int particleCount = 0;
+        uint64_t staticCasterKey = 0; // hash of the static items; changes when any of them does
+
+        void clear()
+        {
+            items.clear();
+            bounds.clear();
+            colliders.clear();
+            lights = LightSnapshot();
+            localLights.clear();
+            bonePalette.clear();
+            particleCount = 0;
+            staticCasterKey = 0;
+        }
+    };
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+namespace engine
+{
+    // GL state changes issued through Shader/Texture2D/Mesh/UniformBuffer/StreamBuffer (main thread only)
+    struct RenderStats
+    {
+        uint32_t programBinds = 0;
+        uint32_t textureBinds = 0;
+        uint32_t uniformUploads = 0;
+        uint32_t drawCalls = 0;
+        uint32_t bufferUploads = 0; // uniform block updates and stream allocations
+
+        RenderStats operator-(const RenderStats& o) const
+        {
+            return { programBinds - o.programBinds, textureBinds - o.textureBinds,
+                     uniformUploads - o.uniformUploads, drawCalls - o.drawCalls,
+                     bufferUploads - o.bufferUploads };
+        }
+    };
+
+    // Running counters; reset once per frame
+    inline RenderStats& renderStats()
+    {
+        static RenderStats stats;
+        return stats;
+    }
+}
@@ -1,6 +1,10 @@
 #include "render/Shader.h"
+#include "render/RenderStats.h"
+#include "render/UniformBuffer.h"
 
 #include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace engine
@@ -31,18 +35,31 @@ namespace engine
     }
 
     bool Shader::compileFromSource(const std::string& vertexSrc, const std::string& fragmentSrc)
+    {
+        return compileFromSource(vertexSrc, std::string(), fragmentSrc);
+    }
+
+    bool Shader::compileFromSource(const std::string& vertexSrc, const std::string& geometrySrc, const std::string& fragmentSrc)
     {
         unsigned int vs = compileStage(GL_VERTEX_SHADER, vertexSrc);
         if (!vs) return false;
+        unsigned int gs = 0;
+        if (!geometrySrc.empty())
+        {
+            gs = compileStage(GL_GEOMETRY_SHADER, geometrySrc);
+            if (!gs) { glDeleteShader(vs); return false; }
+        }
         unsigned int fs = compileStage(GL_FRAGMENT_SHADER, fragmentSrc);
-        if (!fs) { glDeleteShader(vs); return false; }
+        if (!fs) { glDeleteShader(vs); if (gs) glDeleteShader(gs); return false; }
 
         unsigned int newProgram = glCreateProgram();
         glAttachShader(newProgram, vs);
+        if (gs) glAttachShader(newProgram, gs);
         glAttachShader(newProgram, fs);
         glLinkProgram(newProgram);
 
         glDeleteShader(vs);
+        if (gs) glDeleteShader(gs);
         glDeleteShader(fs);
 
         int success;
@@ -62,10 +79,11 @@ namespace engine
             glDeleteProgram(m_program);
         }
         m_program = newProgram;
+        reflect();
         return true;
     }
 
-    void Shader::bind() const { glUseProgram(m_program); }
+    void Shader::bind() const { glUseProgram(m_program); ++renderStats().programBinds; }
     void Shader::unbind() const { glUseProgram(0); }
 
     void Shader::destroy()
@@ -75,44 +93,181 @@ namespace engine
             glDeleteProgram(m_program);
             m_program = 0;
         }
+        m_uniforms.clear();
+        m_byHash.clear();
     }
 
-    void Shader::setMat4(const char* name, const float* value) const
+    // Float, int and unsigned samplers of every dimensionality, including buffer, rect,
+    // multisample and cube-array ones (the cluster lists are usamplerBuffer)
+    static bool isSamplerType(GLenum type)
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniformMatrix4fv(loc, 1, GL_FALSE, value);
+        switch (type)
+        {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_MAP_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_RECT: case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+            return true;
+        default:
+            return false;
+        }
     }
 
-    void Shader::setVec3(const char* name, float x, float y, float z) const
+    void Shader::reflect()
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniform3f(loc, x, y, z);
+        m_uniforms.clear();
+        m_byHash.clear();
+        int count = 0, maxLen = 0;
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+        std::vector<char> buf((size_t)std::max(maxLen, 1) + 16);
+        // colliding hashes keep both entries; uniform() tells them apart by name
+        auto addName = [this](const std::string& name, int index) {
+            m_byHash.emplace(uniformHash(name.c_str()), index);
+        };
+        for (int i = 0; i < count; ++i)
+        {
+            GLsizei len = 0; GLint size = 0; GLenum type = 0;
+            glGetActiveUniform(m_program, (GLuint)i, (GLsizei)buf.size(), &len, &size, &type, buf.data());
+            std::string name(buf.data(), (size_t)len);
+            if (name.compare(0, 3, "gl_") == 0) continue;
+            // members of uniform blocks live in buffers, not in the program
+            GLuint ui = (GLuint)i; GLint block = -1;
+            glGetActiveUniformsiv(m_program, 1, &ui, GL_UNIFORM_BLOCK_INDEX, &block);
+            if (block != -1) continue;
+            // arrays are reported once as "name[0]"
+            std::string base = name;
+            size_t bracket = name.find('[');
+            if (bracket != std::string::npos) base = name.substr(0, bracket);
+            const bool sampler = isSamplerType(type);
+            for (int e = 0; e < size; ++e)
+            {
+                UniformInfo info;
+                info.name = size > 1 || bracket != std::string::npos ? base + "[" + std::to_string(e) + "]" : name;
+                info.location = glGetUniformLocation(m_program, info.name.c_str());
+                info.type = type;
+                info.arraySize = e == 0 ? size : 1;
+                info.sampler = sampler;
+                int index = (int)m_uniforms.size();
+                m_uniforms.push_back(std::move(info));
+                addName(m_uniforms.back().name, index);
+                if (e == 0 && bracket != std::string::npos) addName(base, index);
+            }
+        }
+
+        // each sampler element needs its own texture unit
+        GLint maxUnits = 0;
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxUnits);
+        if (maxUnits > 0 && samplerCount() > maxUnits)
+            std::cerr << "[Shader] " << samplerCount() << " samplers exceed " << maxUnits << " texture units" << std::endl;
+
+        // engine blocks go to their fixed binding points
+        int blocks = 0;
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCKS, &blocks);
+        for (int b = 0; b < blocks; ++b)
+        {
+            char blockName[64] = {};
+            glGetActiveUniformBlockName(m_program, (GLuint)b, sizeof(blockName), nullptr, blockName);
+            int binding = uniformBlockBinding(blockName);
+            if (binding >= 0) glUniformBlockBinding(m_program, (GLuint)b, (GLuint)binding);
+        }
     }
 
-    void Shader::setMat3(const char* name, const float* value) const
+    // name as registered by reflect(): the uniform's own name, or an array's name without "[0]"
+    static bool uniformNameMatches(const std::string& stored, const char* name)
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniformMatrix3fv(loc, 1, GL_FALSE, value);
+        const size_t n = std::strlen(name);
+        if (stored.compare(0, n, name) != 0) return false;
+        return stored.size() == n || stored.compare(n, std::string::npos, "[0]") == 0;
     }
 
-    void Shader::setFloat(const char* name, float v) const
+    UniformHandle Shader::uniform(UniformName name) const
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniform1f(loc, v);
+        // a hash hit alone is not enough: an undeclared name may share a real uniform's hash
+        auto range = m_byHash.equal_range(name.hash);
+        for (auto it = range.first; it != range.second; ++it)
+            if (uniformNameMatches(m_uniforms[it->second].name, name.str)) return UniformHandle{ it->second };
+        return UniformHandle{};
     }
 
-    void Shader::setInt(const char* name, int v) const
+    UniformHandle Shader::uniform(UniformName arrayName, int element) const
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniform1i(loc, v);
+        UniformHandle h = uniform(arrayName);
+        if (!h.valid() || element < 0 || element >= m_uniforms[h.index].arraySize) return UniformHandle{};
+        return UniformHandle{ h.index + element };
     }
-    // already added setMat4Array earlier
 
-    void Shader::setMat4Array(const char* name, const float* value, int count) const
+    int Shader::samplerCount() const
     {
-        int loc = glGetUniformLocation(m_program, name);
-        if (loc != -1) glUniformMatrix4fv(loc, count, GL_FALSE, value);
+        int n = 0;
+        for (const auto& u : m_uniforms) n += u.sampler ? 1 : 0;
+        return n;
+    }
+
+    // True (and the shadow copy updated) when value differs from the last upload
+    bool Shader::changed(UniformHandle h, const float* value, int floats) const
+    {
+        UniformInfo& u = m_uniforms[h.index];
+        if (u.cached && std::memcmp(u.value, value, sizeof(float) * floats) == 0) return false;
+        std::memcpy(u.value, value, sizeof(float) * floats);
+        u.cached = true;
+        return true;
+    }
+
+    void Shader::setMat4(UniformHandle h, const float* value) const
+    {
+        if (!h.valid() || !changed(h, value, 16)) return;
+        glUniformMatrix4fv(m_uniforms[h.index].location, 1, GL_FALSE, value);
+        ++renderStats().uniformUploads;
+    }
+
+    void Shader::setMat3(UniformHandle h, const float* value) const
+    {
+        if (!h.valid() || !changed(h, value, 9)) return;
+        glUniformMatrix3fv(m_uniforms[h.index].location, 1, GL_FALSE, value);
+        ++renderStats().uniformUploads;
+    }
+
+    void Shader::setVec3(UniformHandle h, float x, float y, float z) const
+    {
+        const float v[3] = { x, y, z };
+        if (!h.valid() || !changed(h, v, 3)) return;
+        glUniform3f(m_uniforms[h.index].location, x, y, z);
+        ++renderStats().uniformUploads;
     }
-}
 
+    void Shader::setFloat(UniformHandle h, float v) const
+    {
+        if (!h.valid() || !changed(h, &v, 1)) return;
+        glUniform1f(m_uniforms[h.index].location, v);
+        ++renderStats().uniformUploads;
+    }
 
+    void Shader::setInt(UniformHandle h, int v) const
+    {
+        float bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        if (!h.valid() || !changed(h, &bits, 1)) return;
+        glUniform1i(m_uniforms[h.index].location, v);
+        ++renderStats().uniformUploads;
+    }
+
+    void Shader::setMat4Array(UniformName name, const float* value, int count) const
+    {
+        UniformHandle h = uniform(name);
+        if (!h.valid()) return;
+        glUniformMatrix4fv(m_uniforms[h.index].location, count, GL_FALSE, value);
+        ++renderStats().uniformUploads;
+        // element caches no longer match
+        for (int i = 0; i < m_uniforms[h.index].arraySize; ++i) m_uniforms[h.index + i].cached = false;
+    }
+}
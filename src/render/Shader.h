@@ -1,33 +1,91 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace engine
 {
+    // FNV-1a of a uniform name; constexpr so literal names hash at compile time
+    constexpr uint32_t uniformHash(const char* s, uint32_t h = 2166136261u)
+    {
+        return *s ? uniformHash(s + 1, (h ^ (uint32_t)(uint8_t)*s) * 16777619u) : h;
+    }
+
+    // Uniform name with its precomputed hash (implicit from a literal)
+    struct UniformName
+    {
+        const char* str;
+        uint32_t hash;
+        constexpr UniformName(const char* s) : str(s), hash(uniformHash(s)) {}
+    };
+
+    // Index into a shader's uniform table, resolved once with Shader::uniform()
+    struct UniformHandle
+    {
+        int index = -1;
+        bool valid() const { return index >= 0; }
+    };
+
     class Shader
     {
     public:
+        // Active uniform found at link time. Array elements follow their [0] entry.
+        struct UniformInfo
+        {
+            std::string name;
+            int location = -1;
+            unsigned int type = 0; // GL type enum
+            int arraySize = 1;     // on the [0] entry
+            bool sampler = false;
+            // last uploaded value (mat4 at most); uploads of an equal value are skipped
+            bool cached = false;
+            float value[16];
+        };
+
         Shader() = default;
         ~Shader();
 
         bool compileFromSource(const std::string& vertexSrc, const std::string& fragmentSrc);
+        // with a geometry stage (skipped when geometrySrc is empty)
+        bool compileFromSource(const std::string& vertexSrc, const std::string& geometrySrc, const std::string& fragmentSrc);
         void bind() const;
         void unbind() const;
         void destroy();
 
         unsigned int id() const { return m_program; }
 
-        // Uniform helpers (minimal set)
-        void setMat4(const char* name, const float* value) const;
-        void setVec3(const char* name, float x, float y, float z) const;
-        void setMat3(const char* name, const float* value) const;
-        void setFloat(const char* name, float v) const;
-        void setInt(const char* name, int v) const;
-        void setMat4Array(const char* name, const float* value, int count) const;
+        // Reflection (rebuilt on every successful link; handles from before are stale)
+        UniformHandle uniform(UniformName name) const;
+        // element of a uniform array, e.g. uniform("u_CascadeVP", 2)
+        UniformHandle uniform(UniformName arrayName, int element) const;
+        const std::vector<UniformInfo>& uniforms() const { return m_uniforms; }
+        // texture units the program needs: every element of a sampler array counts
+        int samplerCount() const;
+
+        void setMat4(UniformHandle h, const float* value) const;
+        void setMat3(UniformHandle h, const float* value) const;
+        void setVec3(UniformHandle h, float x, float y, float z) const;
+        void setFloat(UniformHandle h, float v) const;
+        void setInt(UniformHandle h, int v) const;
+
+        // By name: a hash lookup in the reflected table (name compared on a hit), no driver query
+        void setMat4(UniformName name, const float* value) const { setMat4(uniform(name), value); }
+        void setVec3(UniformName name, float x, float y, float z) const { setVec3(uniform(name), x, y, z); }
+        void setMat3(UniformName name, const float* value) const { setMat3(uniform(name), value); }
+        void setFloat(UniformName name, float v) const { setFloat(uniform(name), v); }
+        void setInt(UniformName name, int v) const { setInt(uniform(name), v); }
+        // not cached
+        void setMat4Array(UniformName name, const float* value, int count) const;
+
+    private:
+        void reflect();
+        bool changed(UniformHandle h, const float* value, int floats) const;
 
     private:
         unsigned int m_program = 0;
+        mutable std::vector<UniformInfo> m_uniforms;
+        std::unordered_multimap<uint32_t, int> m_byHash; // name hash -> index, names checked on lookup
     };
 }
-
-
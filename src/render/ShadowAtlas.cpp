@@ -0,0 +1,128 @@
+#include "render/ShadowAtlas.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+
+namespace engine
+{
+    static int floorPow2(int v)
+    {
+        int p = 1;
+        while (p * 2 <= v) p *= 2;
+        return p;
+    }
+
+    // even bits of a Morton code
+    static uint32_t compactBits(uint32_t v)
+    {
+        v &= 0x55555555u;
+        v = (v | (v >> 1)) & 0x33333333u;
+        v = (v | (v >> 2)) & 0x0f0f0f0fu;
+        v = (v | (v >> 4)) & 0x00ff00ffu;
+        v = (v | (v >> 8)) & 0x0000ffffu;
+        return v;
+    }
+
+    ShadowAtlas::~ShadowAtlas() { destroy(); }
+
+    bool ShadowAtlas::create(int size, int minTile)
+    {
+        destroy();
+        m_size = floorPow2(std::max(size, 1));
+        m_minTile = std::min(floorPow2(std::max(minTile, 1)), m_size);
+        glGenFramebuffers(1, &m_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+
+        glGenTextures(1, &m_depthTex);
+        glBindTexture(GL_TEXTURE_2D, m_depthTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, m_size, m_size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        // nearest: a filtered lookup at a tile edge would blend in the neighbouring tile
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTex, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        bool ok = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!ok) std::cerr << "[ShadowAtlas] framebuffer incomplete (" << m_size << ")" << std::endl;
+        return ok;
+    }
+
+    void ShadowAtlas::destroy()
+    {
+        if (m_depthTex) { glDeleteTextures(1, &m_depthTex); m_depthTex = 0; }
+        if (m_fbo) { glDeleteFramebuffers(1, &m_fbo); m_fbo = 0; }
+        m_size = 0;
+        m_minTile = 0;
+    }
+
+    void ShadowAtlas::pack(const std::vector<int>& requested, std::vector<AtlasTile>& out)
+    {
+        const int n = (int)requested.size();
+        out.assign(n, AtlasTile{});
+        if (m_size == 0 || n == 0) return;
+
+        for (int i = 0; i < n; ++i)
+            out[i].size = std::min(floorPow2(std::max(requested[i], m_minTile)), m_size);
+
+        // work in cells of minTile: a tile of size s covers (s / minTile)^2 of them
+        const int64_t side = m_size / m_minTile;
+        const int64_t capacity = side * side;
+        auto cells = [&](int size) { int64_t k = size / m_minTile; return k * k; };
+        for (;;)
+        {
+            int64_t total = 0;
+            int largest = 0;
+            for (const AtlasTile& t : out) { total += cells(t.size); largest = std::max(largest, t.size); }
+            if (total <= capacity || largest <= m_minTile) break;
+            for (AtlasTile& t : out) if (t.size > m_minTile) t.size /= 2;
+        }
+
+        m_order.resize(n);
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::stable_sort(m_order.begin(), m_order.end(), [&](int a, int b) { return out[a].size > out[b].size; });
+
+        // Morton order over the cell grid: with sizes decreasing, every tile starts at a cell
+        // index that is a multiple of its own cell count, i.e. on its own size-aligned square
+        int64_t cursor = 0;
+        for (int i : m_order)
+        {
+            AtlasTile& t = out[i];
+            const int64_t need = cells(t.size);
+            if (cursor + need > capacity) { t = AtlasTile{}; continue; }
+            t.x = (int)compactBits((uint32_t)cursor) * m_minTile;
+            t.y = (int)compactBits((uint32_t)(cursor >> 1)) * m_minTile;
+            cursor += need;
+        }
+    }
+
+    void ShadowAtlas::beginTile(const AtlasTile& tile)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glViewport(tile.x, tile.y, tile.size, tile.size);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(tile.x, tile.y, tile.size, tile.size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    void ShadowAtlas::end(int screenWidth, int screenHeight)
+    {
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, screenWidth, screenHeight);
+    }
+
+    void ShadowAtlas::bindDepthTexture(int slot) const
+    {
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_2D, m_depthTex);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+namespace engine
+{
+    // Square region of the atlas, in texels
+    struct AtlasTile
+    {
+        int x = 0, y = 0;
+        int size = 0; // 0: not placed
+    };
+
+    // One depth texture shared by the shadow views of many local lights. Tiles are square and
+    // power-of-two sized and are re-packed every frame, so the memory stays fixed whatever the
+    // number of shadowed lights; when they do not fit, every tile is scaled down.
+    class ShadowAtlas
+    {
+    public:
+        ShadowAtlas() = default;
+        ~ShadowAtlas();
+
+        ShadowAtlas(const ShadowAtlas&) = delete;
+        ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+        // size and minTile are powers of two
+        bool create(int size, int minTile);
+        void destroy();
+
+        // Places tiles of the requested sizes (rounded down to powers of two, clamped to
+        // [minTile, size]). Larger tiles go first and equal sizes keep their order, so requests
+        // should come by decreasing importance: those left over at the minimum size get size 0.
+        void pack(const std::vector<int>& requested, std::vector<AtlasTile>& out);
+
+        // Binds the atlas and restricts drawing and the depth clear to the tile
+        void beginTile(const AtlasTile& tile);
+        void end(int screenWidth, int screenHeight);
+
+        void bindDepthTexture(int slot) const;
+
+        int size() const { return m_size; }
+        int minTile() const { return m_minTile; }
+
+    private:
+        unsigned int m_fbo = 0;
+        unsigned int m_depthTex = 0;
+        int m_size = 0;
+        int m_minTile = 0;
+        std::vector<int> m_order; // pack() scratch
+    };
+}
@@ -0,0 +1,69 @@
+#include "render/ShadowCache.h"
+
+#include <glad/glad.h>
+#include <cstring>
+#include <iostream>
+
+namespace engine
+{
+    ShadowCache::~ShadowCache() { destroy(); }
+
+    bool ShadowCache::create(int size)
+    {
+        destroy();
+        m_size = size;
+        glGenFramebuffers(1, &m_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+
+        // same formats as the live maps, so the copy is a plain blit
+        glGenTextures(1, &m_depthTex);
+        glBindTexture(GL_TEXTURE_2D, m_depthTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTex, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        bool ok = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!ok) std::cerr << "[ShadowCache] framebuffer incomplete (" << size << ")" << std::endl;
+        m_valid = false;
+        return ok;
+    }
+
+    void ShadowCache::destroy()
+    {
+        if (m_depthTex) { glDeleteTextures(1, &m_depthTex); m_depthTex = 0; }
+        if (m_fbo) { glDeleteFramebuffers(1, &m_fbo); m_fbo = 0; }
+        m_size = 0;
+        m_valid = false;
+    }
+
+    bool ShadowCache::stale(const glm::mat4& viewProj, uint64_t staticKey) const
+    {
+        return !m_valid || m_staticKey != staticKey || std::memcmp(&m_viewProj, &viewProj, sizeof(glm::mat4)) != 0;
+    }
+
+    void ShadowCache::beginUpdate()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glViewport(0, 0, m_size, m_size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    void ShadowCache::endUpdate(const glm::mat4& viewProj, uint64_t staticKey)
+    {
+        m_viewProj = viewProj;
+        m_staticKey = staticKey;
+        m_valid = true;
+    }
+
+    void ShadowCache::copyToBound() const
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+        glBlitFramebuffer(0, 0, m_size, m_size, 0, 0, m_size, m_size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace engine
+{
+    // Depth of the static casters of one shadow view, rendered once and copied into the live
+    // shadow map each frame before the dynamic casters are drawn on top. Re-rendered only when
+    // the view or the static caster set changes.
+    class ShadowCache
+    {
+    public:
+        ShadowCache() = default;
+        ~ShadowCache();
+
+        ShadowCache(const ShadowCache&) = delete;
+        ShadowCache& operator=(const ShadowCache&) = delete;
+
+        bool create(int size);
+        void destroy();
+        void invalidate() { m_valid = false; }
+
+        // True when the cached depth does not match this view and static caster key
+        bool stale(const glm::mat4& viewProj, uint64_t staticKey) const;
+        // Binds the cache target (cleared) for drawing the static casters
+        void beginUpdate();
+        // Stores the key the cache now matches
+        void endUpdate(const glm::mat4& viewProj, uint64_t staticKey);
+        // Copies the cached depth into the bound draw framebuffer
+        void copyToBound() const;
+
+        int size() const { return m_size; }
+
+    private:
+        unsigned int m_fbo = 0;
+        unsigned int m_depthTex = 0;
+        int m_size = 0;
+        bool m_valid = false;
+        glm::mat4 m_viewProj{1.0f};
+        uint64_t m_staticKey = 0;
+    };
+}
@@ -0,0 +1,176 @@
+#include "render/StreamBuffer.h"
+#include "render/RenderStats.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <iostream>
+
+namespace engine
+{
+    // shared by every stream: region r of all buffers is free once s_fences[r] has signalled
+    static GLsync s_fences[StreamBuffer::kRegions] = {};
+    static uint64_t s_frame = 0;
+
+    static void waitAndDelete(GLsync& fence)
+    {
+        if (!fence) return;
+        GLenum r = glClientWaitSync(fence, 0, 0);
+        while (r == GL_TIMEOUT_EXPIRED)
+            r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        if (r == GL_WAIT_FAILED) std::cerr << "[StreamBuffer] glClientWaitSync failed" << std::endl;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamBuffer::advanceFrame()
+    {
+        const int finished = (int)(s_frame % kRegions);
+        if (s_fences[finished]) glDeleteSync(s_fences[finished]);
+        s_fences[finished] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++s_frame;
+        waitAndDelete(s_fences[s_frame % kRegions]);
+    }
+
+    void StreamBuffer::releaseFences()
+    {
+        for (GLsync& fence : s_fences)
+        {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    size_t StreamBuffer::uniformAlignment()
+    {
+        static GLint alignment = 0;
+        if (alignment <= 0)
+        {
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            if (alignment <= 0) alignment = 256;
+        }
+        return (size_t)alignment;
+    }
+
+    StreamBuffer::~StreamBuffer() { destroy(); }
+
+    bool StreamBuffer::create(size_t regionSize)
+    {
+        destroy();
+        m_frame = s_frame;
+        m_cursor = 0;
+        return allocateStorage(regionSize);
+    }
+
+    bool StreamBuffer::allocateStorage(size_t regionSize)
+    {
+        const size_t total = regionSize * kRegions;
+        unsigned int buffer = 0;
+        glGenBuffers(1, &buffer);
+        if (!buffer) return false;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        unsigned char* mapped = nullptr;
+        if (GLAD_GL_VERSION_4_4)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)total, nullptr, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)total, flags);
+            if (!mapped) std::cerr << "[StreamBuffer] persistent map failed, using per-allocation maps" << std::endl;
+        }
+        if (!mapped && !GLAD_GL_VERSION_4_4)
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)total, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        // the old buffer may still be read by queued draws; GL keeps its storage alive until then
+        if (m_buffer)
+        {
+            if (m_mapped || m_rangeMapped)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &m_buffer);
+        }
+        m_buffer = buffer;
+        m_mapped = mapped;
+        m_rangeMapped = false;
+        m_regionSize = regionSize;
+        ++m_generation;
+        return true;
+    }
+
+    void StreamBuffer::destroy()
+    {
+        if (m_buffer)
+        {
+            if (m_mapped || m_rangeMapped)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &m_buffer);
+            m_buffer = 0;
+        }
+        m_mapped = nullptr;
+        m_rangeMapped = false;
+        m_regionSize = 0;
+        m_cursor = 0;
+    }
+
+    size_t StreamBuffer::alignedCursor(size_t alignment) const
+    {
+        // align the absolute offset: regions need not be multiples of every alignment
+        const size_t regionStart = (size_t)(s_frame % kRegions) * m_regionSize;
+        const size_t absolute = regionStart + m_cursor;
+        const size_t aligned = alignment > 1 ? (absolute + alignment - 1) / alignment * alignment : absolute;
+        return aligned - regionStart;
+    }
+
+    void StreamBuffer::reserve(size_t bytes, size_t alignment)
+    {
+        if (!m_buffer) return;
+        if (m_frame != s_frame)
+        {
+            m_frame = s_frame;
+            m_cursor = 0;
+        }
+        if (alignedCursor(alignment) + bytes <= m_regionSize) return;
+        // fresh storage: the current frame starts over at the beginning of its region
+        if (allocateStorage(std::max(m_regionSize * 2, bytes + alignment))) m_cursor = 0;
+    }
+
+    void* StreamBuffer::allocate(size_t bytes, size_t alignment, size_t& offset)
+    {
+        if (!m_buffer || bytes == 0) return nullptr;
+        flush();
+        reserve(bytes, alignment);
+        const size_t start = alignedCursor(alignment);
+        m_cursor = start + bytes;
+        offset = (size_t)(s_frame % kRegions) * m_regionSize + start;
+        ++renderStats().bufferUploads;
+        if (m_mapped) return m_mapped + offset;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        // unsynchronized is safe: the region's fence was waited on in advanceFrame()
+        void* ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_rangeMapped = ptr != nullptr;
+        return ptr;
+    }
+
+    void StreamBuffer::flush()
+    {
+        if (!m_rangeMapped) return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_rangeMapped = false;
+    }
+
+    void StreamBuffer::bindUniformRange(unsigned int index, size_t offset, size_t bytes) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, m_buffer, (GLintptr)offset, (GLsizeiptr)bytes);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine
+{
+    // Ring of per-frame regions for data rewritten every frame (instance matrices, particles,
+    // per-object uniforms, indirect commands). Frame N writes region N % kRegions; advanceFrame()
+    // fences the finished frame and waits only if the GPU still reads the region being reused.
+    // With GL 4.4 the buffer is persistently mapped and writes go straight to GPU-visible memory;
+    // otherwise each allocation maps its range unsynchronized (the fence keeps that safe).
+    class StreamBuffer
+    {
+    public:
+        static constexpr int kRegions = 3;
+
+        StreamBuffer() = default;
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        bool create(size_t regionSize);
+        void destroy();
+
+        // Write pointer for bytes in this frame's region; offset is from the start of the buffer and
+        // a multiple of alignment. Valid until flush(). Grows the buffer when the region is full,
+        // which invalidates earlier allocations of this frame that were not drawn yet.
+        void* allocate(size_t bytes, size_t alignment, size_t& offset);
+        // Makes the next allocations of up to bytes fit without growing
+        void reserve(size_t bytes, size_t alignment);
+        // Ends the writes of the last allocation (unmaps it without persistent mapping)
+        void flush();
+        // glBindBufferRange on GL_UNIFORM_BUFFER
+        void bindUniformRange(unsigned int index, size_t offset, size_t bytes) const;
+
+        unsigned int id() const { return m_buffer; }
+        // Bumped whenever the GL buffer is replaced; VAOs pointing at it must be re-specified
+        uint32_t generation() const { return m_generation; }
+        bool persistent() const { return m_mapped != nullptr; }
+        size_t regionSize() const { return m_regionSize; }
+
+        // Once per frame after the swap, for every StreamBuffer
+        static void advanceFrame();
+        // Deletes the frame fences (before the context goes away)
+        static void releaseFences();
+        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        static size_t uniformAlignment();
+
+    private:
+        bool allocateStorage(size_t regionSize);
+        size_t alignedCursor(size_t alignment) const;
+
+    private:
+        unsigned int m_buffer = 0;
+        size_t m_regionSize = 0;
+        unsigned char* m_mapped = nullptr; // persistent mapping of the whole buffer
+        bool m_rangeMapped = false;        // fallback: an allocation is mapped until flush()
+        uint64_t m_frame = 0;              // frame the cursor belongs to
+        size_t m_cursor = 0;               // bytes used in the current region
+        uint32_t m_generation = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #include "render/Terrain.h"
 #include "render/Shader.h"
 #include "render/Texture2D.h"
+#include "render/UniformBuffer.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -32,8 +33,6 @@ namespace engine
             #version 330 core
             layout (location = 0) in vec2 aXZ;
             layout (location = 1) in vec2 aUV;
-            uniform mat4 u_Proj;
-            uniform mat4 u_View;
             uniform float u_CellWorld;
             uniform float u_HeightScale;
             uniform sampler2D u_Heightmap;
@@ -54,14 +53,13 @@ namespace engine
                 vec3 wp = vec3(aXZ.x * u_CellWorld, h, aXZ.y * u_CellWorld);
                 vWorldPos = wp;
                 vNormal = calcNormal(aUV);
-                gl_Position = u_Proj * u_View * vec4(wp,1.0);
+                gl_Position = u_ViewProj * vec4(wp,1.0);
             }
         )GLSL";
         const char* fs = R"GLSL(
             #version 330 core
             in vec2 vUV; in vec3 vWorldPos; in vec3 vNormal;
             out vec4 FragColor;
-            uniform vec3 u_CameraPos; uniform vec3 u_LightPos; uniform vec3 u_LightColor;
             uniform sampler2D u_SplatCtrl; // RGBA: layer weights
             uniform sampler2D u_Splat0; uniform sampler2D u_Splat1; uniform sampler2D u_Splat2; uniform sampler2D u_Splat3;
             uniform float u_SplatTiling;
@@ -85,7 +83,7 @@ namespace engine
             }
         )GLSL";
         m_shader = std::make_unique<Shader>();
-        return m_shader->compileFromSource(vs, fs);
+        return m_shader->compileFromSource(withUniformBlocks(vs), withUniformBlocks(fs));
     }
 
     bool Terrain::createMesh(int grid)
@@ -164,20 +162,12 @@ namespace engine
         return true;
     }
 
-    void Terrain::draw(const glm::mat4& proj, const glm::mat4& view,
-                       const glm::vec3& cameraPos,
-                       const glm::vec3& lightPos,
-                       const glm::vec3& lightColor)
+    void Terrain::draw()
     {
         if (!m_heightmap) return;
         m_shader->bind();
-        m_shader->setMat4("u_Proj", &proj[0][0]);
-        m_shader->setMat4("u_View", &view[0][0]);
         m_shader->setFloat("u_CellWorld", m_cellWorld);
         m_shader->setFloat("u_HeightScale", m_heightScale);
-        m_shader->setVec3("u_CameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
-        m_shader->setVec3("u_LightPos", lightPos.x, lightPos.y, lightPos.z);
-        m_shader->setVec3("u_LightColor", lightColor.x, lightColor.y, lightColor.z);
 
         m_shader->setInt("u_Heightmap", 0);
         m_shader->setInt("u_SplatCtrl", 1);
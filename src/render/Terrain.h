@@ -2,8 +2,6 @@
 
 #include <memory>
 #include <vector>
-#include <glm/mat4x4.hpp>
-#include <glm/vec3.hpp>
 
 namespace engine
 {
@@ -27,10 +25,8 @@ namespace engine
         void setParams(float heightScale, float splatTiling, float cellWorldSize);
         void setLOD(int level); // 0=high,1=med,2=low
 
-        void draw(const glm::mat4& proj, const glm::mat4& view,
-                  const glm::vec3& cameraPos,
-                  const glm::vec3& lightPos,
-                  const glm::vec3& lightColor);
+        // camera and light from the FrameData / LightData blocks
+        void draw();
 
     private:
         bool createMesh(int grid);
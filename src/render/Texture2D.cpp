@@ -1,4 +1,5 @@
 #include "render/Texture2D.h"
+#include "render/RenderStats.h"
 
 #include <glad/glad.h>
 #include <cstring>
@@ -49,6 +50,7 @@ namespace engine
     {
         glActiveTexture(GL_TEXTURE0 + slot);
         glBindTexture(GL_TEXTURE_2D, m_tex);
+        ++renderStats().textureBinds;
     }
 
     void Texture2D::destroy()
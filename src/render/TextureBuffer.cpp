@@ -0,0 +1,51 @@
+#include "render/TextureBuffer.h"
+#include "render/RenderStats.h"
+
+#include <glad/glad.h>
+
+namespace engine
+{
+    TextureBuffer::~TextureBuffer() { destroy(); }
+
+    bool TextureBuffer::create(unsigned int internalFormat)
+    {
+        destroy();
+        glGenBuffers(1, &m_buffer);
+        glGenTextures(1, &m_texture);
+        if (!m_buffer || !m_texture) { destroy(); return false; }
+        m_format = internalFormat;
+        // a texture buffer needs storage before it is sampled
+        m_capacity = 256;
+        glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)m_capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, m_format, m_buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        return true;
+    }
+
+    void TextureBuffer::destroy()
+    {
+        if (m_texture) { glDeleteTextures(1, &m_texture); m_texture = 0; }
+        if (m_buffer) { glDeleteBuffers(1, &m_buffer); m_buffer = 0; }
+        m_capacity = 0;
+    }
+
+    void TextureBuffer::update(const void* data, size_t size)
+    {
+        if (!m_buffer || size == 0) return;
+        while (m_capacity < size) m_capacity *= 2;
+        glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)m_capacity, nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)size, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        ++renderStats().bufferUploads;
+    }
+
+    void TextureBuffer::bind(int slot) const
+    {
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+    }
+}
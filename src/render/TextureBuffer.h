@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace engine
+{
+    // Buffer read in shaders through a samplerBuffer / usamplerBuffer (texelFetch), for arrays
+    // larger than a uniform block allows
+    class TextureBuffer
+    {
+    public:
+        TextureBuffer() = default;
+        ~TextureBuffer();
+
+        TextureBuffer(const TextureBuffer&) = delete;
+        TextureBuffer& operator=(const TextureBuffer&) = delete;
+
+        // internalFormat of the texels, e.g. GL_RGBA32F
+        bool create(unsigned int internalFormat);
+        void destroy();
+
+        // Replaces the contents; storage is orphaned (and grown when needed) so in-flight draws keep theirs
+        void update(const void* data, size_t size);
+        void bind(int slot) const;
+
+        size_t capacity() const { return m_capacity; }
+
+    private:
+        unsigned int m_buffer = 0;
+        unsigned int m_texture = 0;
+        unsigned int m_format = 0;
+        size_t m_capacity = 0;
+    };
+}
@@ -0,0 +1,111 @@
+#include "render/UniformBuffer.h"
+#include "render/RenderStats.h"
+
+#include <glad/glad.h>
+#include <cstring>
+
+namespace engine
+{
+    int uniformBlockBinding(const char* blockName)
+    {
+        if (std::strcmp(blockName, "FrameData") == 0) return BlockFrame;
+        if (std::strcmp(blockName, "LightData") == 0) return BlockLights;
+        if (std::strcmp(blockName, "ObjectData") == 0) return BlockObjects;
+        if (std::strcmp(blockName, "LocalLightData") == 0) return BlockLocalLights;
+        return -1;
+    }
+
+    const char* uniformBlocksGLSL()
+    {
+        return R"GLSL(
+            layout(std140) uniform FrameData
+            {
+                mat4 u_View;
+                mat4 u_Proj;
+                mat4 u_ViewProj;
+                vec3 u_CameraPos; float u_Time;
+                float u_DeltaTime;
+            };
+            layout(std140) uniform LightData
+            {
+                vec3 u_LightPos; float u_ShadowBias;
+                vec3 u_LightColor; float u_ShadowMapSize;
+                vec3 u_PointLightPos; float u_PointShadowFar;
+                vec3 u_PointLightColor; float u_PointShadowBias;
+                vec3 u_SpotPos; float u_SpotCosInner;
+                vec3 u_SpotDir; float u_SpotCosOuter;
+                vec3 u_SpotColor; float u_LightRadius;
+                mat4 u_LightVP;
+                mat4 u_SpotVP;
+                mat4 u_CascadeVP[4];
+                int u_ShadowsEnabled; int u_UseCSM; int u_CascadeCount; int u_PCFKernel;
+                int u_UsePCSS; int u_PointShadowsEnabled; int u_SpotEnabled;
+            };
+            struct ObjectEntry { mat4 model; mat4 normalMatrix; };
+            layout(std140) uniform ObjectData
+            {
+                ObjectEntry u_Objects[128];
+            };
+            // the only per-draw uniform: slot of the draw in ObjectData
+            uniform int u_ObjectIndex;
+            struct ShadowTile { mat4 viewProj; vec4 rect; };
+            layout(std140) uniform LocalLightData
+            {
+                int u_LocalLightCount; float u_AtlasTexel; float u_ClusterZScale; float u_ClusterZBias;
+                ivec3 u_ClusterGrid;
+                ShadowTile u_ShadowTiles[128];
+            };
+        )GLSL";
+    }
+
+    std::string withUniformBlocks(const std::string& source)
+    {
+        size_t version = source.find("#version");
+        if (version == std::string::npos) return std::string(uniformBlocksGLSL()) + source;
+        size_t eol = source.find('\n', version);
+        if (eol == std::string::npos) return source + "\n" + uniformBlocksGLSL();
+        std::string out;
+        out.reserve(source.size() + std::strlen(uniformBlocksGLSL()));
+        out.append(source, 0, eol + 1);
+        out.append(uniformBlocksGLSL());
+        out.append(source, eol + 1, std::string::npos);
+        return out;
+    }
+
+    UniformBuffer::~UniformBuffer() { destroy(); }
+
+    bool UniformBuffer::create(size_t size, unsigned int binding)
+    {
+        destroy();
+        glGenBuffers(1, &m_ubo);
+        if (!m_ubo) return false;
+        m_size = size;
+        m_binding = binding;
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)m_size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_ubo);
+        return true;
+    }
+
+    void UniformBuffer::destroy()
+    {
+        if (m_ubo)
+        {
+            glDeleteBuffers(1, &m_ubo);
+            m_ubo = 0;
+        }
+        m_size = 0;
+    }
+
+    void UniformBuffer::update(const void* data, size_t size)
+    {
+        if (!m_ubo || size == 0) return;
+        if (size > m_size) size = m_size;
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)m_size, nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        ++renderStats().bufferUploads;
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace engine
+{
+    // Fixed binding points of the engine uniform blocks; Shader binds blocks by name after link
+    enum UniformBlockBinding : unsigned int
+    {
+        BlockFrame = 0,   // FrameData
+        BlockLights = 1,  // LightData
+        BlockObjects = 2, // ObjectData
+        BlockLocalLights = 3, // LocalLightData
+    };
+
+    // Binding point of a known block name, -1 otherwise
+    int uniformBlockBinding(const char* blockName);
+
+    // std140 mirrors of the GLSL blocks in uniformBlocksGLSL(): every vec3 is paired with a scalar
+    struct FrameBlock
+    {
+        glm::mat4 view{1.0f};
+        glm::mat4 proj{1.0f};
+        glm::mat4 viewProj{1.0f};
+        glm::vec3 cameraPos{0.0f};
+        float time = 0.0f;
+        float deltaTime = 0.0f;
+        float pad[3] = {};
+    };
+
+    struct LightBlock
+    {
+        glm::vec3 dirPos{0.0f};
+        float shadowBias = 0.0f;
+        glm::vec3 dirColor{1.0f};
+        float shadowMapSize = 1.0f;
+        glm::vec3 pointPos{0.0f};
+        float pointShadowFar = 25.0f;
+        glm::vec3 pointColor{1.0f};
+        float pointShadowBias = 0.05f;
+        glm::vec3 spotPos{0.0f};
+        float spotCosInner = 1.0f;
+        glm::vec3 spotDir{0.0f, -1.0f, 0.0f};
+        float spotCosOuter = 1.0f;
+        glm::vec3 spotColor{1.0f};
+        float lightRadius = 0.0f;
+        glm::mat4 lightVP{1.0f};
+        glm::mat4 spotVP{1.0f};
+        glm::mat4 cascadeVP[4] = { glm::mat4(1.0f), glm::mat4(1.0f), glm::mat4(1.0f), glm::mat4(1.0f) };
+        int shadowsEnabled = 0;
+        int useCSM = 0;
+        int cascadeCount = 0;
+        int pcfKernel = 0;
+        int usePCSS = 0;
+        int pointShadowsEnabled = 0;
+        int spotEnabled = 0;
+        int pad = 0;
+    };
+
+    // One element of ObjectData; the normal matrix is a mat3 widened to mat4 columns
+    struct ObjectEntry
+    {
+        glm::mat4 model{1.0f};
+        glm::mat4 normal{1.0f};
+    };
+
+    // 16 KB, the minimum GL_MAX_UNIFORM_BLOCK_SIZE
+    constexpr int kObjectsPerBlock = 128;
+
+    constexpr int kMaxLocalLights = 1024;
+    constexpr int kMaxShadowTiles = 128;
+
+    // Point or spot light, 4 RGBA32F texels of the local light texture buffer (the ints are
+    // stored bit for bit and read back with floatBitsToInt)
+    struct LocalLightEntry
+    {
+        glm::vec3 position{0.0f};
+        float range = 1.0f;
+        glm::vec3 color{0.0f};
+        int isSpot = 0;
+        glm::vec3 direction{0.0f, -1.0f, 0.0f};
+        float cosOuter = 0.0f;
+        int firstTile = -1; // in tiles[], 6 consecutive cube faces for a point light; -1 unshadowed
+        float cosInner = 1.0f;
+        float shadowBias = 0.0f;
+        float pad = 0.0f;
+    };
+
+    // Shadow view of a local light inside the atlas
+    struct ShadowTileEntry
+    {
+        glm::mat4 viewProj{1.0f};
+        glm::vec4 rect{0.0f}; // xy offset, zw scale, in atlas UV
+    };
+
+    // Counts first so an upload can stop after the last used tile
+    struct LocalLightBlock
+    {
+        int lightCount = 0;
+        float atlasTexel = 0.0f;    // 1 / atlas size
+        float clusterZScale = 0.0f; // slice = log(view depth) * scale + bias (see LightClusters.h)
+        float clusterZBias = 0.0f;
+        int clusterX = 0, clusterY = 0, clusterZ = 0; // 0: no clusters, every light is visited
+        int pad = 0;
+        ShadowTileEntry tiles[kMaxShadowTiles];
+    };
+
+    static_assert(sizeof(FrameBlock) == 3 * 64 + 32, "FrameBlock must match std140 FrameData");
+    static_assert(sizeof(LightBlock) == 7 * 16 + 6 * 64 + 32, "LightBlock must match std140 LightData");
+    static_assert(sizeof(ObjectEntry) * kObjectsPerBlock == 16384, "ObjectData must fit 16 KB");
+    static_assert(sizeof(LocalLightEntry) == 64, "LocalLightEntry must be 4 RGBA32F texels");
+    static_assert(sizeof(ShadowTileEntry) == 80 && offsetof(LocalLightBlock, tiles) == 32, "LocalLightData must match std140");
+    static_assert(sizeof(LocalLightBlock) <= 16384, "LocalLightData must fit 16 KB");
+
+    // GLSL declarations of FrameData, LightData, ObjectData and LocalLightData
+    const char* uniformBlocksGLSL();
+    // source with the block declarations inserted after its #version line
+    std::string withUniformBlocks(const std::string& source);
+
+    // Uniform buffer attached to a fixed binding point
+    class UniformBuffer
+    {
+    public:
+        UniformBuffer() = default;
+        ~UniformBuffer();
+
+        UniformBuffer(const UniformBuffer&) = delete;
+        UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+        bool create(size_t size, unsigned int binding);
+        void destroy();
+
+        // Replaces the first size bytes; the old storage is orphaned so in-flight draws keep theirs
+        void update(const void* data, size_t size);
+
+        unsigned int id() const { return m_ubo; }
+        size_t size() const { return m_size; }
+
+    private:
+        unsigned int m_ubo = 0;
+        size_t m_size = 0;
+        unsigned int m_binding = 0;
+    };
+}
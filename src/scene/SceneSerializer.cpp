@@ -15,7 +15,7 @@ namespace engine
         json j;
         j["name"] = e.name;
         j["position"] = { e.transform.position.x, e.transform.position.y, e.transform.position.z };
-        j["rotation"] = { e.transform.rotationEuler.x, e.transform.rotationEuler.y, e.transform.rotationEuler.z };
+        j["rotation"] = { e.transform.rotation.x, e.transform.rotation.y, e.transform.rotation.z, e.transform.rotation.w }; // quaternion xyzw
         j["scale"]    = { e.transform.scale.x,    e.transform.scale.y,    e.transform.scale.z };
         j["albedo"]   = { e.albedo[0], e.albedo[1], e.albedo[2] };
         j["shininess"] = e.shininess;
@@ -45,7 +45,9 @@ namespace engine
         auto s = j.value("scale",    std::vector<float>{1,1,1});
         auto a = j.value("albedo",   std::vector<float>{1,1,1});
         e.transform.position = { p[0], p[1], p[2] };
-        e.transform.rotationEuler = { r[0], r[1], r[2] };
+        // 4 values: quaternion xyzw; 3 values: Euler radians from older files
+        if (r.size() == 4) e.transform.rotation = glm::quat(r[3], r[0], r[1], r[2]);
+        else if (r.size() == 3) e.transform.setEuler({ r[0], r[1], r[2] });
         e.transform.scale = { s[0], s[1], s[2] };
         e.albedo[0] = a[0]; e.albedo[1] = a[1]; e.albedo[2] = a[2];
         e.shininess = j.value("shininess", 64.0f);
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/euler_angles.hpp>
 
 namespace engine
 {
@@ -9,20 +11,31 @@ namespace engine
     {
     public:
         glm::vec3 position{0.0f, 0.0f, 0.0f};
-        glm::vec3 rotationEuler{0.0f, 0.0f, 0.0f}; // radians
+        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
         glm::vec3 scale{1.0f, 1.0f, 1.0f};
 
+        // Editor view: radians, applied X then Y then Z (the old rotationEuler order)
+        glm::vec3 euler() const
+        {
+            glm::vec3 e;
+            glm::extractEulerAngleXYZ(glm::mat4_cast(rotation), e.x, e.y, e.z);
+            return e;
+        }
+        void setEuler(const glm::vec3& e)
+        {
+            rotation = glm::angleAxis(e.x, glm::vec3(1.0f, 0.0f, 0.0f))
+                     * glm::angleAxis(e.y, glm::vec3(0.0f, 1.0f, 0.0f))
+                     * glm::angleAxis(e.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        }
+
         glm::mat4 modelMatrix() const
         {
-            glm::mat4 m(1.0f);
-            m = glm::translate(m, position);
-            m = glm::rotate(m, rotationEuler.x, glm::vec3(1.0f, 0.0f, 0.0f));
-            m = glm::rotate(m, rotationEuler.y, glm::vec3(0.0f, 1.0f, 0.0f));
-            m = glm::rotate(m, rotationEuler.z, glm::vec3(0.0f, 0.0f, 1.0f));
-            m = glm::scale(m, scale);
+            glm::mat4 m = glm::mat4_cast(rotation);
+            m[0] *= scale.x;
+            m[1] *= scale.y;
+            m[2] *= scale.z;
+            m[3] = glm::vec4(position, 1.0f);
             return m;
         }
     };
 }
-
-
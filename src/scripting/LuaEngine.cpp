@@ -1,5 +1,7 @@
 #include "scripting/LuaEngine.h"
 #include "scene/Scene.h"
+#include "ecs/ECS.h"
+#include "core/Profiler.h"
 
 #include <lua.hpp>
 #include <cstdio>
@@ -24,6 +26,9 @@ namespace engine
         // register C API
         lua_register(m_L, "get_entity_pos", l_get_entity_pos);
         lua_register(m_L, "set_entity_pos", l_set_entity_pos);
+        lua_register(m_L, "query_sphere", l_query_sphere);
+        lua_register(m_L, "query_box", l_query_box);
+        lua_register(m_L, "raycast", l_raycast);
         s_instance = this;
         return true;
     }
@@ -68,6 +73,7 @@ namespace engine
 
     void LuaEngine::onUpdate(float dt)
     {
+        PROFILE_SCOPE("LuaEngine::onUpdate");
         if (!m_L) return;
         if (m_hotReload) pollHotReload();
         // call global update(dt) if present
@@ -162,6 +168,53 @@ namespace engine
         }
         return 0;
     }
-}
 
+    // Pushes the entity ids as an array table
+    static void pushEntityList(lua_State* L, const std::vector<entt::entity>& list)
+    {
+        lua_createtable(L, (int)list.size(), 0);
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            lua_pushinteger(L, (lua_Integer)entt::to_integral(list[i]));
+            lua_rawseti(L, -2, (lua_Integer)i + 1);
+        }
+    }
+
+    // query_sphere(x, y, z, r) -> { ids } of ECS entities whose bounds touch the sphere
+    int LuaEngine::l_query_sphere(lua_State* L)
+    {
+        glm::vec3 c((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3));
+        float r = (float)luaL_checknumber(L, 4);
+        std::vector<entt::entity> hits;
+        if (s_instance && s_instance->m_registry) querySphere(*s_instance->m_registry, c, r, hits);
+        pushEntityList(L, hits);
+        return 1;
+    }
+
+    // query_box(minx, miny, minz, maxx, maxy, maxz) -> { ids }
+    int LuaEngine::l_query_box(lua_State* L)
+    {
+        Aabb box;
+        box.min = glm::vec3((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3));
+        box.max = glm::vec3((float)luaL_checknumber(L, 4), (float)luaL_checknumber(L, 5), (float)luaL_checknumber(L, 6));
+        std::vector<entt::entity> hits;
+        if (s_instance && s_instance->m_registry) queryAabb(*s_instance->m_registry, box, hits);
+        pushEntityList(L, hits);
+        return 1;
+    }
 
+    // raycast(ox, oy, oz, dx, dy, dz [, maxDist]) -> id, distance  or nil
+    int LuaEngine::l_raycast(lua_State* L)
+    {
+        glm::vec3 o((float)luaL_checknumber(L, 1), (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3));
+        glm::vec3 d((float)luaL_checknumber(L, 4), (float)luaL_checknumber(L, 5), (float)luaL_checknumber(L, 6));
+        float maxDist = (float)luaL_optnumber(L, 7, 1000.0);
+        if (!s_instance || !s_instance->m_registry || glm::length(d) < 1e-6f) { lua_pushnil(L); return 1; }
+        float dist = 0.0f;
+        entt::entity e = raycastEntities(*s_instance->m_registry, o, glm::normalize(d), maxDist, &dist);
+        if (e == entt::null) { lua_pushnil(L); return 1; }
+        lua_pushinteger(L, (lua_Integer)entt::to_integral(e));
+        lua_pushnumber(L, dist);
+        return 2;
+    }
+}
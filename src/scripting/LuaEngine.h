@@ -3,6 +3,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <entt/entity/fwd.hpp>
 
 struct lua_State;
 
@@ -28,6 +29,8 @@ namespace engine
 
         // Bind entity API
         void bindEntity(int id, Entity* e);
+        // ECS registry for the spatial queries (query_sphere, query_box, raycast)
+        void bindRegistry(entt::registry* reg) { m_registry = reg; }
 
         // Simple hot-reload: checks file timestamps
         void setHotReloadEnabled(bool enabled) { m_hotReload = enabled; }
@@ -37,12 +40,16 @@ namespace engine
         bool pushModule(const std::string& path);
         static int l_get_entity_pos(lua_State* L);
         static int l_set_entity_pos(lua_State* L);
+        static int l_query_sphere(lua_State* L);
+        static int l_query_box(lua_State* L);
+        static int l_raycast(lua_State* L);
 
     private:
         lua_State* m_L = nullptr;
         bool m_hotReload = true;
         std::unordered_map<std::string, long long> m_fileTimes;
         std::vector<std::pair<int, Entity*>> m_entities; // simple registry
+        entt::registry* m_registry = nullptr;
     };
 }
 
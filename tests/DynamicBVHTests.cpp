@@ -0,0 +1,58 @@
+#include "TestRunner.h"
+#include "core/DynamicBVH.h"
+
+#include <vector>
+
+using namespace engine;
+
+TEST_CASE(bvh_axis_parallel_ray_on_box_face)
+{
+    DynamicBVH tree(0.0f);
+    const int proxy = tree.createProxy({ glm::vec3(0.0f), glm::vec3(1.0f) }, 7u);
+
+    // origin on the y = 1 face, travelling along +x: 1/dir.y would make the y slab NaN
+    int hits = 0;
+    tree.raycast(glm::vec3(-2.0f, 1.0f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 10.0f, [&](int p, float t) {
+        CHECK(p == proxy);
+        CHECK(t >= 1.99f && t <= 2.01f);
+        ++hits;
+        return 10.0f;
+    });
+    CHECK(hits == 1);
+
+    // parallel but just outside the slab misses
+    hits = 0;
+    tree.raycast(glm::vec3(-2.0f, 1.01f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 10.0f, [&](int, float) { ++hits; return 10.0f; });
+    CHECK(hits == 0);
+
+    // beyond maxDist misses
+    tree.raycast(glm::vec3(-2.0f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 1.5f, [&](int, float) { ++hits; return 1.5f; });
+    CHECK(hits == 0);
+}
+
+TEST_CASE(bvh_stack_spills_past_fixed_size)
+{
+    BVHStack stack;
+    const int count = kBVHStackSize * 3 + 5;
+    for (int i = 0; i < count; ++i) stack.push(i);
+    bool ordered = true;
+    for (int i = count - 1; i >= 0; --i) ordered = ordered && !stack.empty() && stack.pop() == i;
+    CHECK(ordered);
+    CHECK(stack.empty());
+}
+
+TEST_CASE(bvh_queries_find_every_proxy)
+{
+    DynamicBVH tree;
+    std::vector<int> proxies;
+    for (int i = 0; i < 2000; ++i)
+    {
+        const glm::vec3 c((float)(i % 20), (float)((i / 20) % 10), (float)(i / 200));
+        proxies.push_back(tree.createProxy(Aabb::fromSphere(c, 0.25f), (uint32_t)i));
+    }
+    std::vector<int> seen(proxies.size(), 0);
+    tree.queryAabb({ glm::vec3(-1.0f), glm::vec3(100.0f) }, [&](int p) { ++seen[tree.userData(p)]; return true; });
+    int wrong = 0;
+    for (int s : seen) wrong += s != 1;
+    CHECK(wrong == 0);
+}
@@ -0,0 +1,100 @@
+#include "TestRunner.h"
+#include "core/JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace engine;
+
+TEST_CASE(jobs_run_after_waits_for_dependency)
+{
+    JobSystem jobs(3);
+    JobCounter first, second;
+    std::atomic<int> finished{0};
+    std::atomic<int> seenByContinuation{-1};
+    for (int i = 0; i < 8; ++i)
+    {
+        jobs.run([&finished]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            finished.fetch_add(1);
+        }, &first);
+    }
+    jobs.runAfter(first, [&]() { seenByContinuation.store(finished.load()); }, &second);
+    jobs.wait(second);
+    CHECK(seenByContinuation.load() == 8);
+
+    // a dependency that already reached zero starts the job right away
+    std::atomic<bool> ran{false};
+    JobCounter third;
+    jobs.runAfter(first, [&ran]() { ran.store(true); }, &third);
+    jobs.wait(third);
+    CHECK(ran.load());
+}
+
+TEST_CASE(jobs_parallel_for_covers_range_once)
+{
+    JobSystem jobs(3);
+    for (int count : { 0, 1, 63, 64, 10007 })
+    {
+        std::vector<std::atomic<int>> hits(count);
+        for (auto& h : hits) h.store(0);
+        std::atomic<int> badChunk{0};
+        jobs.parallelFor(count, 64, [&](int begin, int end) {
+            if (begin < 0 || end > count || begin >= end) badChunk.fetch_add(1);
+            for (int i = begin; i < end; ++i) hits[i].fetch_add(1);
+        });
+        CHECK(badChunk.load() == 0);
+        int wrong = 0;
+        for (auto& h : hits) wrong += h.load() != 1;
+        CHECK(wrong == 0);
+    }
+}
+
+TEST_CASE(jobs_counter_completes)
+{
+    JobSystem jobs(2);
+    JobCounter counter;
+    CHECK(counter.done());
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 100; ++i) jobs.run([&ran]() { ran.fetch_add(1); }, &counter);
+    // continuations count toward their own counter only
+    JobCounter after;
+    jobs.runAfter(counter, [&ran]() { ran.fetch_add(1000); }, &after);
+    jobs.wait(counter);
+    CHECK(counter.done());
+    CHECK(ran.load() >= 100);
+    jobs.wait(after);
+    CHECK(after.done());
+    CHECK(ran.load() == 1100);
+}
+
+TEST_CASE(jobs_nested_wait_inside_job)
+{
+    // one worker: a job waiting on its children must run them itself or from the caller
+    JobSystem jobs(1);
+    JobCounter outer;
+    std::atomic<int> leaves{0};
+    for (int o = 0; o < 4; ++o)
+    {
+        jobs.run([&jobs, &leaves]() {
+            JobCounter inner;
+            for (int i = 0; i < 16; ++i) jobs.run([&leaves]() { leaves.fetch_add(1); }, &inner);
+            jobs.wait(inner);
+        }, &outer);
+    }
+    jobs.wait(outer);
+    CHECK(leaves.load() == 64);
+}
+
+TEST_CASE(jobs_shutdown_drains_queued_work)
+{
+    std::atomic<int> ran{0};
+    {
+        JobSystem jobs(2);
+        for (int i = 0; i < 1000; ++i)
+            jobs.run([&ran]() { ran.fetch_add(1); });
+    }
+    CHECK(ran.load() == 1000);
+}
@@ -0,0 +1,173 @@
+#include "TestRunner.h"
+#include "core/JobSystem.h"
+#include "render/LightClusters.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace engine;
+
+namespace
+{
+    const float kNear = 0.1f, kFar = 100.0f;
+
+    glm::mat4 testProjection()
+    {
+        return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, kNear, kFar);
+    }
+
+    bool clusterHasLight(const LightClusters& lc, int cluster, uint32_t light)
+    {
+        const uint32_t offset = lc.cells()[(size_t)cluster * 2], count = lc.cells()[(size_t)cluster * 2 + 1];
+        const auto first = lc.lightIndices().begin() + offset;
+        return std::find(first, first + count, light) != first + count;
+    }
+
+    // deterministic spread of lights through the frustum, some straddling near and far
+    std::vector<glm::vec4> scatterLights(int count)
+    {
+        std::vector<glm::vec4> spheres;
+        uint32_t state = 12345u;
+        auto next = [&state]() { state = state * 1664525u + 1013904223u; return (float)(state >> 8) / 16777216.0f; };
+        for (int i = 0; i < count; ++i)
+        {
+            const float depth = -2.0f + next() * (kFar + 6.0f);
+            const float spread = std::max(depth, 1.0f);
+            spheres.emplace_back((next() * 2.0f - 1.0f) * spread, (next() * 2.0f - 1.0f) * spread * 0.6f, -depth, 0.2f + next() * 4.0f);
+        }
+        return spheres;
+    }
+}
+
+TEST_CASE(clusters_point_light_touches_only_overlapping_froxels)
+{
+    const glm::mat4 proj = testProjection();
+    const glm::vec3 center(1.0f, 0.5f, -10.0f);
+    const float radius = 1.5f;
+    const glm::vec4 sphere(center, radius);
+    LightClusters lc;
+    lc.build(glm::mat4(1.0f), proj, &sphere, 1);
+    CHECK(lc.cells().size() == (size_t)lc.clusterCount() * 2);
+
+    // reference: view-space box of each cluster rebuilt from the published slice mapping, with a
+    // small tolerance either side of the sphere/box distance
+    const int sliceMin = lc.sliceOf(-center.z - radius), sliceMax = lc.sliceOf(-center.z + radius);
+    int listed = 0, wrong = 0;
+    for (int z = 0; z < lc.gridZ(); ++z)
+    {
+        const float d0 = std::exp(((float)z - lc.zBias()) / lc.zScale());
+        const float d1 = std::exp(((float)z + 1.0f - lc.zBias()) / lc.zScale());
+        for (int y = 0; y < lc.gridY(); ++y)
+        {
+            for (int x = 0; x < lc.gridX(); ++x)
+            {
+                const float tx[2] = { -1.0f + 2.0f * x / lc.gridX(), -1.0f + 2.0f * (x + 1) / lc.gridX() };
+                const float ty[2] = { -1.0f + 2.0f * y / lc.gridY(), -1.0f + 2.0f * (y + 1) / lc.gridY() };
+                glm::vec3 mn(1e30f), mx(-1e30f);
+                for (float d : { d0, d1 })
+                {
+                    for (int i = 0; i < 2; ++i)
+                    {
+                        mn.x = std::min(mn.x, tx[i] * d / proj[0][0]); mx.x = std::max(mx.x, tx[i] * d / proj[0][0]);
+                        mn.y = std::min(mn.y, ty[i] * d / proj[1][1]); mx.y = std::max(mx.y, ty[i] * d / proj[1][1]);
+                    }
+                }
+                mn.z = -d1; mx.z = -d0;
+                const float dx = std::max(mn.x - center.x, 0.0f) + std::max(center.x - mx.x, 0.0f);
+                const float dy = std::max(mn.y - center.y, 0.0f) + std::max(center.y - mx.y, 0.0f);
+                const float dz = std::max(mn.z - center.z, 0.0f) + std::max(center.z - mx.z, 0.0f);
+                const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+                const bool has = clusterHasLight(lc, lc.clusterIndex(x, y, z), 0);
+                listed += has;
+                if (has && (dist > radius * 1.001f || z < sliceMin || z > sliceMax)) ++wrong;
+                if (!has && dist < radius * 0.999f) ++wrong;
+            }
+        }
+    }
+    CHECK(wrong == 0);
+    CHECK(listed > 0);
+    CHECK(listed < lc.clusterCount() / 10);
+
+    // every point inside the sphere finds the light in the cluster the shader would pick
+    int missing = 0;
+    const int steps = 8;
+    for (int i = 0; i <= steps; ++i)
+    {
+        for (int j = 0; j <= steps; ++j)
+        {
+            for (int k = 0; k <= steps; ++k)
+            {
+                const glm::vec3 offset(2.0f * i / steps - 1.0f, 2.0f * j / steps - 1.0f, 2.0f * k / steps - 1.0f);
+                if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z > 1.0f) continue;
+                const glm::vec3 p = center + offset * (radius * 0.95f);
+                const float depth = -p.z;
+                const float nx = p.x * proj[0][0] / depth, ny = p.y * proj[1][1] / depth;
+                if (nx <= -1.0f || nx >= 1.0f || ny <= -1.0f || ny >= 1.0f) continue;
+                const int cx = std::min((int)((nx + 1.0f) * 0.5f * lc.gridX()), lc.gridX() - 1);
+                const int cy = std::min((int)((ny + 1.0f) * 0.5f * lc.gridY()), lc.gridY() - 1);
+                if (!clusterHasLight(lc, lc.clusterIndex(cx, cy, lc.sliceOf(depth)), 0)) ++missing;
+            }
+        }
+    }
+    CHECK(missing == 0);
+}
+
+TEST_CASE(clusters_exclude_lights_behind_camera_or_past_far)
+{
+    const glm::vec4 spheres[] = {
+        glm::vec4(0.0f, 0.0f, 5.0f, 1.0f),                // behind the camera
+        glm::vec4(0.0f, 0.0f, -(kFar + 2.0f), 1.0f),      // entirely past the far plane
+        glm::vec4(0.0f, 0.0f, -50.0f, 1.0f),              // inside
+        glm::vec4(0.0f, 0.0f, -(kFar + 0.5f), 1.0f),      // straddling the far plane
+    };
+    LightClusters lc;
+    lc.build(glm::mat4(1.0f), testProjection(), spheres, 4);
+
+    bool seen[4] = {};
+    for (uint32_t index : lc.lightIndices())
+    {
+        CHECK(index < 4);
+        if (index < 4) seen[index] = true;
+    }
+    CHECK(!seen[0]);
+    CHECK(!seen[1]);
+    CHECK(seen[2]);
+    CHECK(seen[3]);
+
+    // the view transform is applied: with the camera moved to z = -20 the light is behind it
+    const glm::vec4 passed(0.0f, 0.0f, -10.0f, 1.0f);
+    lc.build(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 20.0f)), testProjection(), &passed, 1);
+    CHECK(lc.lightIndices().empty());
+}
+
+TEST_CASE(clusters_simd_matches_scalar)
+{
+    const std::vector<glm::vec4> spheres = scatterLights(500);
+    LightClusters simd, scalar;
+    scalar.setSimd(false);
+    simd.build(glm::mat4(1.0f), testProjection(), spheres.data(), (int)spheres.size());
+    scalar.build(glm::mat4(1.0f), testProjection(), spheres.data(), (int)spheres.size());
+    CHECK(!simd.lightIndices().empty());
+    CHECK(simd.cells() == scalar.cells());
+    CHECK(simd.lightIndices() == scalar.lightIndices());
+}
+
+TEST_CASE(clusters_parallel_matches_serial)
+{
+    const std::vector<glm::vec4> spheres = scatterLights(300);
+    JobSystem jobs(3);
+    LightClusters parallel, serial;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        parallel.build(glm::mat4(1.0f), testProjection(), spheres.data(), (int)spheres.size(), &jobs);
+        serial.build(glm::mat4(1.0f), testProjection(), spheres.data(), (int)spheres.size());
+        CHECK(!serial.lightIndices().empty());
+        CHECK(parallel.cells() == serial.cells());
+        CHECK(parallel.lightIndices() == serial.lightIndices());
+    }
+}
@@ -0,0 +1,37 @@
+#include "TestRunner.h"
+
+#include <cstring>
+
+namespace enginetest
+{
+    std::vector<TestCase>& testCases()
+    {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+
+    int& failureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+}
+
+// engine_tests [name...]: runs every test case, or only the named ones
+int main(int argc, char** argv)
+{
+    using namespace enginetest;
+    int run = 0;
+    for (const TestCase& t : testCases())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; ++i) selected = std::strcmp(argv[i], t.name) == 0;
+        if (!selected) continue;
+        const int before = failureCount();
+        t.fn();
+        std::cout << (failureCount() == before ? "[ OK ] " : "[FAIL] ") << t.name << std::endl;
+        ++run;
+    }
+    std::cout << run << " tests, " << failureCount() << " failed checks" << std::endl;
+    return failureCount() == 0 && run > 0 ? 0 : 1;
+}
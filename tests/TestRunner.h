@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+// Minimal self-registering test cases for the CPU-only engine code (no GL, no PhysX)
+namespace enginetest
+{
+    struct TestCase
+    {
+        const char* name;
+        void (*fn)();
+    };
+
+    std::vector<TestCase>& testCases();
+    int& failureCount();
+
+    struct Register
+    {
+        Register(const char* name, void (*fn)()) { testCases().push_back({ name, fn }); }
+    };
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static enginetest::Register name##_register(#name, name); \
+    static void name()
+
+// Records a failure and carries on with the test
+#define CHECK(cond) \
+    do { if (!(cond)) { ++enginetest::failureCount(); \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl; } } while (0)